@@ -0,0 +1,95 @@
+﻿#include "ActionDispatcher.h"
+#include <cassert>
+#include <algorithm>
+
+
+ActionDispatcher::ActionDispatcher()
+	: next_id_(0)
+	, dispatching_(false)
+{
+
+}
+
+// 添加订阅者
+int ActionDispatcher::addListener(FActionMask mask, const FActionHandler &handler)
+{
+	assert(mask != 0 && handler != nullptr);
+	FListener listener = { next_id_++, mask, handler };
+	if (dispatching_)
+	{
+		// 不在分发过程中修改正在遍历的列表
+		pending_listeners_.push_back(listener);
+	}
+	else
+	{
+		listeners_.push_back(listener);
+	}
+	return listener.id;
+}
+
+// 注销订阅者
+void ActionDispatcher::removeListener(int listener)
+{
+	for (auto &item : listeners_)
+	{
+		if (item.id == listener)
+		{
+			item.mask = 0;
+		}
+	}
+	for (auto &item : pending_listeners_)
+	{
+		if (item.id == listener)
+		{
+			item.mask = 0;
+		}
+	}
+
+	if (!dispatching_)
+	{
+		compact();
+	}
+}
+
+// 分发一批动作
+void ActionDispatcher::dispatch(const FActionSpan &batch)
+{
+	assert(!dispatching_);
+	FActionMask batch_mask = 0;
+	for (const FAction &action : batch)
+	{
+		batch_mask |= helper::ActionMask(action.type);
+	}
+
+	dispatching_ = true;
+	for (size_t i = 0; i < listeners_.size(); ++i)
+	{
+		if (listeners_[i].mask & batch_mask)
+		{
+			listeners_[i].handler(batch);
+		}
+	}
+	dispatching_ = false;
+
+	if (!pending_listeners_.empty() || std::any_of(listeners_.begin(), listeners_.end(), [](const FListener &item) { return item.mask == 0; }))
+	{
+		compact();
+	}
+}
+
+// 获取订阅者数量
+size_t ActionDispatcher::getListenerNum() const
+{
+	return listeners_.size() + pending_listeners_.size();
+}
+
+// 整理订阅者列表
+void ActionDispatcher::compact()
+{
+	listeners_.insert(listeners_.end(), pending_listeners_.begin(), pending_listeners_.end());
+	pending_listeners_.clear();
+	listeners_.erase(std::remove_if(listeners_.begin(), listeners_.end(), [](const FListener &item)
+	{
+		return item.mask == 0;
+	}), listeners_.end());
+}
@@ -0,0 +1,69 @@
+﻿#ifndef __ACTIONDISPATCHER_H__
+#define __ACTIONDISPATCHER_H__
+
+#include <vector>
+#include "LogicBase.h"
+
+/**
+ * 动作分发器
+ * 每次分发一批连续的动作，订阅者按动作类型过滤：批次中包含关心的动作类型时回调一次，回调中自行遍历批次。
+ * 分发过程中允许添加、注销订阅者：新订阅者从下一个动作开始接收，注销的订阅者立即停止接收，分发结束后统一整理。
+ */
+class ActionDispatcher
+{
+public:
+	ActionDispatcher();
+
+public:
+	/**
+	 * 添加订阅者
+	 * @param FActionMask 关心的动作类型
+	 * @param FActionHandler 回调
+	 * @return int 订阅者编号
+	 */
+	int addListener(FActionMask mask, const FActionHandler &handler);
+
+	/**
+	 * 注销订阅者
+	 */
+	void removeListener(int listener);
+
+	/**
+	 * 分发一批动作
+	 */
+	void dispatch(const FActionSpan &batch);
+
+	/**
+	 * 获取订阅者数量
+	 */
+	size_t getListenerNum() const;
+
+private:
+	/**
+	 * 订阅者
+	 */
+	struct FListener
+	{
+		int				id;
+		FActionMask		mask;						// 为0表示已注销
+		FActionHandler	handler;
+	};
+
+private:
+	/**
+	 * 合并分发过程中添加的订阅者，移除已注销的订阅者
+	 */
+	void compact();
+
+private:
+	ActionDispatcher(const ActionDispatcher &) = delete;
+	ActionDispatcher& operator= (const ActionDispatcher &) = delete;
+
+private:
+	std::vector<FListener>	listeners_;
+	std::vector<FListener>	pending_listeners_;
+	int						next_id_;
+	bool					dispatching_;
+};
+
+#endif
@@ -0,0 +1,156 @@
+﻿#include "ActionLog.h"
+#include <cassert>
+#include <algorithm>
+
+
+ActionLog::ActionLog()
+	: head_(0)
+	, tail_(0)
+{
+	for (int i = 0; i < kMaxActionConsumers; ++i)
+	{
+		cursors_[i] = 0;
+		active_[i] = false;
+		overflowed_[i] = false;
+	}
+}
+
+// 注册消费者
+int ActionLog::addConsumer()
+{
+	for (int i = 0; i < kMaxActionConsumers; ++i)
+	{
+		if (!active_[i])
+		{
+			active_[i] = true;
+			cursors_[i] = tail_;
+			overflowed_[i] = false;
+			return i;
+		}
+	}
+	assert(false);
+	return -1;
+}
+
+// 注销消费者
+void ActionLog::removeConsumer(int consumer)
+{
+	if (consumer >= 0 && consumer < kMaxActionConsumers)
+	{
+		active_[consumer] = false;
+		release();
+	}
+}
+
+// 添加动作
+void ActionLog::push(const FAction &action)
+{
+	// 写满时覆盖最旧的动作，丢失未读动作的消费者跳到最旧的保留动作并记录溢出
+	if (tail_ - head_ == kActionLogCapacity)
+	{
+		++head_;
+		for (int i = 0; i < kMaxActionConsumers; ++i)
+		{
+			if (active_[i] && cursors_[i] < head_)
+			{
+				cursors_[i] = head_;
+				overflowed_[i] = true;
+			}
+		}
+	}
+
+	entries_[tail_ & (kActionLogCapacity - 1)] = FPackedAction::fromAction(action);
+	++tail_;
+
+	// 没有消费者时不保留
+	release();
+}
+
+// 获取未读动作的连续视图
+FActionSpan ActionLog::peek(int consumer) const
+{
+	FActionSpan span = { entries_, 0 };
+	if (consumer < 0 || consumer >= kMaxActionConsumers || !active_[consumer])
+	{
+		return span;
+	}
+
+	const uint64_t cursor = cursors_[consumer];
+	const size_t offset = static_cast<size_t>(cursor & (kActionLogCapacity - 1));
+	span.data = entries_ + offset;
+	span.count = static_cast<size_t>(std::min<uint64_t>(tail_ - cursor, kActionLogCapacity - offset));
+	return span;
+}
+
+// 标记已读
+void ActionLog::consume(int consumer, size_t count)
+{
+	if (consumer >= 0 && consumer < kMaxActionConsumers && active_[consumer])
+	{
+		assert(count <= tail_ - cursors_[consumer]);
+		cursors_[consumer] = std::min<uint64_t>(cursors_[consumer] + count, tail_);
+		release();
+	}
+}
+
+// 获取读取位置
+uint64_t ActionLog::getCursor(int consumer) const
+{
+	if (consumer < 0 || consumer >= kMaxActionConsumers || !active_[consumer])
+	{
+		return tail_;
+	}
+	return cursors_[consumer];
+}
+
+// 获取未读动作数量
+size_t ActionLog::getPendingNum(int consumer) const
+{
+	if (consumer < 0 || consumer >= kMaxActionConsumers || !active_[consumer])
+	{
+		return 0;
+	}
+	return static_cast<size_t>(tail_ - cursors_[consumer]);
+}
+
+// 获取并清除溢出标记
+bool ActionLog::takeOverflow(int consumer)
+{
+	if (consumer < 0 || consumer >= kMaxActionConsumers || !active_[consumer])
+	{
+		return false;
+	}
+	bool overflowed = overflowed_[consumer];
+	overflowed_[consumer] = false;
+	return overflowed;
+}
+
+// 获取累计添加的动作数量
+uint64_t ActionLog::getTotalNum() const
+{
+	return tail_;
+}
+
+// 丢弃所有未读动作
+void ActionLog::clear()
+{
+	for (int i = 0; i < kMaxActionConsumers; ++i)
+	{
+		cursors_[i] = tail_;
+	}
+	head_ = tail_;
+}
+
+// 释放所有消费者都读过的动作
+void ActionLog::release()
+{
+	uint64_t head = tail_;
+	for (int i = 0; i < kMaxActionConsumers; ++i)
+	{
+		if (active_[i])
+		{
+			head = std::min(head, cursors_[i]);
+		}
+	}
+	head_ = head;
+}
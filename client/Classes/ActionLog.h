@@ -0,0 +1,88 @@
+﻿#ifndef __ACTIONLOG_H__
+#define __ACTIONLOG_H__
+
+#include <cstdint>
+#include "LogicBase.h"
+
+static const size_t kActionLogCapacity = 256;	// 最多保留的未读动作（2的幂）
+static const int kMaxActionConsumers = 8;		// 最多的消费者数量
+
+/**
+ * 动作日志
+ * 固定容量的环形缓冲区，每个消费者有自己的读取位置，所有消费者都读过的动作即被释放。
+ * 内存占用与对局长度无关。消费者的滞后没有上限（界面在动画播放完才标记已读，快速悔棋、跳转可能一次产生很多动作），
+ * 写满时覆盖最旧的动作，丢失了未读动作的消费者跳到最旧的保留动作并记录溢出标记，由消费者按当前局面重新同步。
+ */
+class ActionLog
+{
+public:
+	ActionLog();
+
+public:
+	/**
+	 * 注册消费者，从当前位置开始读取
+	 * @return int 消费者编号，已满时返回-1
+	 */
+	int addConsumer();
+
+	/**
+	 * 注销消费者
+	 */
+	void removeConsumer(int consumer);
+
+	/**
+	 * 添加动作
+	 */
+	void push(const FAction &action);
+
+	/**
+	 * 获取未读动作的连续视图（回绕时只返回到缓冲区末尾，读完后再次获取剩余部分）
+	 */
+	FActionSpan peek(int consumer) const;
+
+	/**
+	 * 标记已读
+	 */
+	void consume(int consumer, size_t count);
+
+	/**
+	 * 获取读取位置（累计读过的动作数量，丢弃未读动作时跳到末尾）
+	 */
+	uint64_t getCursor(int consumer) const;
+
+	/**
+	 * 获取未读动作数量
+	 */
+	size_t getPendingNum(int consumer) const;
+
+	/**
+	 * 获取并清除溢出标记（有未读动作被覆盖）
+	 */
+	bool takeOverflow(int consumer);
+
+	/**
+	 * 获取累计添加的动作数量
+	 */
+	uint64_t getTotalNum() const;
+
+	/**
+	 * 丢弃所有未读动作
+	 */
+	void clear();
+
+private:
+	/**
+	 * 释放所有消费者都读过的动作
+	 */
+	void release();
+
+private:
+	FPackedAction	entries_[kActionLogCapacity];	// 压缩存储，每个动作2字节
+	uint64_t		cursors_[kMaxActionConsumers];
+	bool			active_[kMaxActionConsumers];
+	bool			overflowed_[kMaxActionConsumers];
+	uint64_t		head_;							// 最旧的保留动作
+	uint64_t		tail_;							// 下一个动作
+};
+
+#endif
@@ -0,0 +1,317 @@
+﻿#include "AnalysisService.h"
+#include <cassert>
+#include <algorithm>
+
+
+namespace
+{
+	// 计算延迟分位数使用的最近请求数量
+	const size_t kLatencyWindow = 8192;
+
+	// 搜索提前结束的余量，留给回调和线程调度
+	const int kDeadlineMarginMs = 2;
+
+	inline bool SameLimits(const FSearchLimits &a, const FSearchLimits &b)
+	{
+		return a.max_nodes == b.max_nodes && a.max_time_ms == b.max_time_ms && a.max_depth == b.max_depth;
+	}
+
+	inline double ElapsedMs(std::chrono::steady_clock::time_point from, std::chrono::steady_clock::time_point to)
+	{
+		return std::chrono::duration<double, std::milli>(to - from).count();
+	}
+
+	// 分位数（values 会被重新排列）
+	inline double Percentile(std::vector<double> &values, double ratio)
+	{
+		if (values.empty())
+		{
+			return 0.0;
+		}
+		size_t index = std::min(static_cast<size_t>(values.size() * ratio), values.size() - 1);
+		std::nth_element(values.begin(), values.begin() + index, values.end());
+		return values[index];
+	}
+}
+
+AnalysisService::AnalysisService(size_t tt_size_mb, size_t max_queue_depth)
+	: tt_(tt_size_mb)
+	, book_(nullptr)
+	, network_(nullptr)
+	, has_weights_(false)
+	, max_queue_depth_(max_queue_depth)
+	, running_(false)
+	, stats_()
+	, latency_index_(0)
+	, searched_num_(0)
+{
+	latencies_.reserve(kLatencyWindow);
+}
+
+AnalysisService::~AnalysisService()
+{
+	stop();
+}
+
+// 设置评估权重
+void AnalysisService::setEvalWeights(const FEvalWeights &weights)
+{
+	assert(workers_.empty());
+	weights_ = weights;
+	has_weights_ = true;
+}
+
+// 设置神经网络评估
+void AnalysisService::setNetwork(const NNUENetwork *network)
+{
+	assert(workers_.empty());
+	network_ = network;
+}
+
+// 设置开局库
+void AnalysisService::setOpeningBook(const OpeningBook *book)
+{
+	assert(workers_.empty());
+	book_ = book;
+}
+
+// 启动工作线程
+void AnalysisService::start(int thread_num)
+{
+	assert(workers_.empty());
+	running_ = true;
+	for (int i = 0; i < std::max(thread_num, 1); ++i)
+	{
+		std::unique_ptr<FWorker> worker(new FWorker());
+		worker->random.seed(Random::kDefaultSeed + i);
+		worker->search.setTranspositionTable(&tt_, true);
+		worker->search.setNetwork(network_);
+		if (has_weights_)
+		{
+			worker->search.setEvalWeights(weights_);
+		}
+		workers_.push_back(std::move(worker));
+	}
+	for (auto &worker : workers_)
+	{
+		worker->thread = std::thread(&AnalysisService::run, this, worker.get());
+	}
+}
+
+// 停止工作线程
+void AnalysisService::stop()
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		if (!running_)
+		{
+			return;
+		}
+		running_ = false;
+	}
+	condition_.notify_all();
+	for (auto &worker : workers_)
+	{
+		worker->thread.join();
+	}
+	workers_.clear();
+
+	// 未处理的请求
+	FJobQueue remaining;
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		remaining.swap(queue_);
+		queued_jobs_.clear();
+		stats_.queue_depth = 0;
+	}
+	for (auto &item : remaining)
+	{
+		FJob &job = *item.second;
+		for (auto &waiter : job.waiters)
+		{
+			waiter.callback(FServiceReply());
+		}
+	}
+}
+
+// 提交请求
+bool AnalysisService::submit(const FServiceRequest &request, const FReplyCallback &callback)
+{
+	Position pos = Position::fromCheckerboard(request.checkerboard, request.side);
+	uint64_t key = pos.getHash() ^ (request.limits.max_nodes * 0x9E3779B97F4A7C15ULL)
+		^ (static_cast<uint64_t>(request.limits.max_depth) << 48) ^ (static_cast<uint64_t>(request.limits.max_time_ms) << 24);
+
+	FWaiter waiter;
+	waiter.callback = callback;
+	waiter.submit_time = std::chrono::steady_clock::now();
+	waiter.deadline = waiter.submit_time + std::chrono::milliseconds(request.deadline_ms);
+
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		if (!running_)
+		{
+			return false;
+		}
+		++stats_.submitted;
+
+		// 排队中的相同局面，截止时间不晚于本次请求时合并
+		auto found = queued_jobs_.find(key);
+		if (found != queued_jobs_.end())
+		{
+			FJob &job = *found->second->second;
+			if (job.pos.getHash() == pos.getHash() && SameLimits(job.limits, request.limits) && job.deadline <= waiter.deadline)
+			{
+				job.waiters.push_back(waiter);
+				++stats_.coalesced;
+				return true;
+			}
+		}
+
+		if (stats_.queue_depth >= max_queue_depth_)
+		{
+			++stats_.rejected;
+			return false;
+		}
+
+		std::unique_ptr<FJob> job(new FJob());
+		job->pos = pos;
+		job->limits = request.limits;
+		job->key = key;
+		job->deadline = waiter.deadline;
+		job->waiters.push_back(waiter);
+		FJobQueue::iterator it = queue_.insert(std::make_pair(waiter.deadline, std::move(job)));
+		if (found == queued_jobs_.end())
+		{
+			queued_jobs_.insert(std::make_pair(key, it));
+		}
+		++stats_.queue_depth;
+		stats_.max_queue_depth = std::max(stats_.max_queue_depth, stats_.queue_depth);
+	}
+	condition_.notify_one();
+	return true;
+}
+
+// 获取统计
+FServiceStats AnalysisService::getStats() const
+{
+	std::vector<double> latencies;
+	FServiceStats stats;
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		stats = stats_;
+		latencies = latencies_;
+	}
+	stats.latency_p50_ms = Percentile(latencies, 0.50);
+	stats.latency_p90_ms = Percentile(latencies, 0.90);
+	stats.latency_p99_ms = Percentile(latencies, 0.99);
+	stats.latency_max_ms = latencies.empty() ? 0.0 : *std::max_element(latencies.begin(), latencies.end());
+	return stats;
+}
+
+// 工作线程
+void AnalysisService::run(FWorker *worker)
+{
+	for (;;)
+	{
+		std::unique_ptr<FJob> job;
+		{
+			std::unique_lock<std::mutex> lock(mutex_);
+			condition_.wait(lock, [this]() { return !running_ || !queue_.empty(); });
+			if (!running_)
+			{
+				return;
+			}
+
+			// 截止时间最早的任务
+			FJobQueue::iterator it = queue_.begin();
+			job = std::move(it->second);
+			auto found = queued_jobs_.find(job->key);
+			if (found != queued_jobs_.end() && found->second == it)
+			{
+				queued_jobs_.erase(found);
+			}
+			queue_.erase(it);
+			--stats_.queue_depth;
+		}
+		process(worker, *job);
+	}
+}
+
+// 处理任务
+void AnalysisService::process(FWorker *worker, FJob &job)
+{
+	FTimePoint start_time = std::chrono::steady_clock::now();
+	FServiceReply result;
+
+	FMove book_move = FMove::invalid();
+	int book_score = 0;
+	if (book_ != nullptr && book_->probe(job.pos, book_move, book_score))
+	{
+		result.status = FServiceStatus::BOOK;
+		result.move = book_move;
+		result.score = book_score;
+		reply(job, result, start_time);
+		return;
+	}
+
+	// 搜索时间不超过剩余时间，已经超时的只搜索一层
+	FSearchLimits limits = job.limits;
+	int remaining_ms = static_cast<int>(std::chrono::duration_cast<std::chrono::milliseconds>(job.deadline - start_time).count()) - kDeadlineMarginMs;
+	bool expired = remaining_ms <= 0;
+	if (expired)
+	{
+		limits.max_depth = 1;
+		limits.max_nodes = 0;
+		limits.max_time_ms = 0;
+	}
+	else
+	{
+		limits.max_time_ms = limits.max_time_ms == 0 ? remaining_ms : std::min(limits.max_time_ms, remaining_ms);
+	}
+
+	FSearchResult search_result = worker->search.run(job.pos, limits, worker->random);
+	result.status = !search_result.best_move.isValid() ? FServiceStatus::NO_MOVE
+		: expired ? FServiceStatus::EXPIRED : FServiceStatus::SEARCHED;
+	result.move = search_result.best_move;
+	result.score = search_result.score;
+	result.stats = search_result.stats;
+	reply(job, result, start_time);
+}
+
+// 回调所有等待的请求
+void AnalysisService::reply(FJob &job, FServiceReply result, FTimePoint start_time)
+{
+	FTimePoint finish_time = std::chrono::steady_clock::now();
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		stats_.completed += job.waiters.size();
+		stats_.book_hits += result.status == FServiceStatus::BOOK ? job.waiters.size() : 0;
+		stats_.expired += result.status == FServiceStatus::EXPIRED ? job.waiters.size() : 0;
+		stats_.nodes += result.stats.nodes;
+		if (result.status != FServiceStatus::BOOK && ++searched_num_ % kTTGenerationInterval == 0)
+		{
+			tt_.newSearch();
+		}
+		for (const FWaiter &waiter : job.waiters)
+		{
+			stats_.late += finish_time > waiter.deadline;
+			double latency = ElapsedMs(waiter.submit_time, finish_time);
+			if (latencies_.size() < kLatencyWindow)
+			{
+				latencies_.push_back(latency);
+			}
+			else
+			{
+				latencies_[latency_index_] = latency;
+				latency_index_ = (latency_index_ + 1) % kLatencyWindow;
+			}
+		}
+	}
+
+	for (const FWaiter &waiter : job.waiters)
+	{
+		result.queue_ms = ElapsedMs(waiter.submit_time, start_time);
+		result.latency_ms = ElapsedMs(waiter.submit_time, finish_time);
+		waiter.callback(result);
+	}
+}
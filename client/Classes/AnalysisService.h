@@ -0,0 +1,214 @@
+﻿#ifndef __ANALYSISSERVICE_H__
+#define __ANALYSISSERVICE_H__
+
+#include <map>
+#include <mutex>
+#include <chrono>
+#include <memory>
+#include <thread>
+#include <vector>
+#include <functional>
+#include <unordered_map>
+#include <condition_variable>
+#include "Search.h"
+#include "LogicBase.h"
+#include "OpeningBook.h"
+#include "TranspositionTable.h"
+
+static const int kTTGenerationInterval = 64;	// 共享置换表每完成多少次搜索推进一代
+
+/**
+ * 分析请求的处理结果
+ */
+enum class FServiceStatus
+{
+	SEARCHED,									// 搜索完成
+	BOOK,										// 开局库命中，没有搜索
+	EXPIRED,									// 开始处理时已经超过截止时间，只搜索了一层
+	NO_MOVE,									// 走棋方无棋可走
+	CANCELLED,									// 服务停止，没有处理
+};
+
+/**
+ * 分析请求
+ */
+struct FServiceRequest
+{
+	FChessArray			checkerboard;			// 棋盘
+	FChessPieceType		side;					// 走棋方
+	FSearchLimits		limits;					// 搜索限制
+	int					deadline_ms;			// 截止时间（从提交时开始计算）
+};
+
+/**
+ * 分析结果
+ */
+struct FServiceReply
+{
+	FServiceStatus		status;					// 处理结果
+	FMove				move;					// 最佳走法
+	int					score;					// 分数（走棋方视角）
+	FSearchStats		stats;					// 搜索统计（开局库命中时为空）
+	double				queue_ms;				// 排队时间
+	double				latency_ms;				// 从提交到完成的时间
+
+	FServiceReply() : status(FServiceStatus::CANCELLED), move(FMove::invalid()), score(0), queue_ms(0.0), latency_ms(0.0) {}
+};
+
+/**
+ * 服务统计
+ */
+struct FServiceStats
+{
+	size_t		queue_depth;					// 当前排队的请求
+	size_t		max_queue_depth;				// 排队请求的峰值
+	uint64_t	submitted;						// 提交的请求
+	uint64_t	rejected;						// 队列已满被拒绝的请求
+	uint64_t	coalesced;						// 与排队中的相同局面合并的请求
+	uint64_t	completed;						// 完成的请求
+	uint64_t	book_hits;						// 开局库命中
+	uint64_t	expired;						// 开始处理时已超时
+	uint64_t	late;							// 完成时超过截止时间
+	uint64_t	nodes;							// 搜索的总节点数
+	double		latency_p50_ms;					// 最近请求的延迟分位数
+	double		latency_p90_ms;
+	double		latency_p99_ms;
+	double		latency_max_ms;
+};
+
+/**
+ * 多房间共享的分析服务
+ * 各房间提交局面分析请求，由固定数量的工作线程按截止时间从早到晚处理；
+ * 所有工作线程共享一个置换表和一个开局库，排队中的相同局面（相同的搜索限制）合并为一次搜索。
+ * 置换表的代数由服务统一推进（每完成 kTTGenerationInterval 次搜索），不随每次搜索推进，保证深的条目不会很快被浅的替换。
+ * 搜索时间不超过距离截止时间的剩余时间，开始处理时已经超时的请求只搜索一层，保证尾延迟有界。
+ * 回调在工作线程中调用，可以在回调中提交新的请求。
+ */
+class AnalysisService
+{
+public:
+	typedef std::function<void(const FServiceReply &)> FReplyCallback;
+
+public:
+	/**
+	 * @param size_t 置换表大小（MB）
+	 * @param size_t 最大排队请求数，超过时拒绝新的请求
+	 */
+	explicit AnalysisService(size_t tt_size_mb = 64, size_t max_queue_depth = 65536);
+
+	~AnalysisService();
+
+public:
+	/**
+	 * 设置评估权重（启动前调用）
+	 */
+	void setEvalWeights(const FEvalWeights &weights);
+
+	/**
+	 * 设置神经网络评估（启动前调用，不持有所有权）
+	 */
+	void setNetwork(const NNUENetwork *network);
+
+	/**
+	 * 设置开局库（启动前调用，不持有所有权）
+	 */
+	void setOpeningBook(const OpeningBook *book);
+
+	/**
+	 * 启动工作线程
+	 */
+	void start(int thread_num);
+
+	/**
+	 * 停止工作线程，未处理的请求以 CANCELLED 回调
+	 */
+	void stop();
+
+	/**
+	 * 提交请求
+	 * @return bool 服务未启动或队列已满时返回 false，不会回调
+	 */
+	bool submit(const FServiceRequest &request, const FReplyCallback &callback);
+
+	/**
+	 * 获取统计
+	 */
+	FServiceStats getStats() const;
+
+private:
+	typedef std::chrono::steady_clock::time_point FTimePoint;
+
+	/**
+	 * 等待结果的请求
+	 */
+	struct FWaiter
+	{
+		FReplyCallback	callback;
+		FTimePoint		submit_time;
+		FTimePoint		deadline;
+	};
+
+	/**
+	 * 排队中的任务（合并后的请求）
+	 */
+	struct FJob
+	{
+		Position				pos;
+		FSearchLimits			limits;
+		uint64_t				key;
+		FTimePoint				deadline;
+		std::vector<FWaiter>	waiters;
+	};
+
+	typedef std::multimap<FTimePoint, std::unique_ptr<FJob>> FJobQueue;
+
+	/**
+	 * 工作线程的搜索状态
+	 */
+	struct FWorker
+	{
+		Search			search;
+		Random			random;
+		std::thread		thread;
+	};
+
+private:
+	/**
+	 * 工作线程
+	 */
+	void run(FWorker *worker);
+
+	/**
+	 * 处理任务
+	 */
+	void process(FWorker *worker, FJob &job);
+
+	/**
+	 * 回调所有等待的请求并记录延迟
+	 */
+	void reply(FJob &job, FServiceReply reply, FTimePoint start_time);
+
+private:
+	AnalysisService(const AnalysisService &) = delete;
+	AnalysisService& operator= (const AnalysisService &) = delete;
+
+private:
+	TranspositionTable							tt_;
+	const OpeningBook*							book_;
+	const NNUENetwork*							network_;
+	FEvalWeights								weights_;
+	bool										has_weights_;
+	size_t										max_queue_depth_;
+	std::vector<std::unique_ptr<FWorker>>		workers_;
+	mutable std::mutex							mutex_;
+	std::condition_variable						condition_;
+	FJobQueue									queue_;
+	std::unordered_map<uint64_t, FJobQueue::iterator>	queued_jobs_;
+	bool										running_;
+	FServiceStats								stats_;
+	std::vector<double>							latencies_;
+	size_t										latency_index_;
+	uint64_t									searched_num_;		// 完成的搜索次数，用于推进置换表代数
+};
+
+#endif
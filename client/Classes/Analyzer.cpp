@@ -0,0 +1,85 @@
+﻿#include "Analyzer.h"
+#include <algorithm>
+
+
+Analyzer::Analyzer(size_t tt_size_mb)
+	: tt_(tt_size_mb)
+{
+	search_.setTranspositionTable(&tt_);
+}
+
+// 分析局面
+std::vector<FAnalysisLine> Analyzer::analyze(const FChessArray &checkerboard, FChessPieceType side, int multi_pv, const FSearchLimits &limits)
+{
+	Position pos = Position::fromCheckerboard(checkerboard, side);
+	if (pos.isLost())
+	{
+		return std::vector<FAnalysisLine>();
+	}
+	return search_.analyze(pos, limits, multi_pv);
+}
+
+// 复盘整局棋
+std::vector<FMoveReview> Analyzer::reviewGame(const FChessArray &initial, FChessPieceType first, const std::vector<FMoveTrack> &moves, const FSearchLimits &limits)
+{
+	std::vector<FMoveReview> reviews;
+	Position pos = Position::fromCheckerboard(initial, first);
+	for (auto &track : moves)
+	{
+		FMove move = FMove::fromMoveTrack(track);
+		if (pos.isLost())
+		{
+			break;
+		}
+
+		// 对所有根节点走法计算精确分数，实际走法与最佳走法在同一深度下比较
+		std::vector<FAnalysisLine> lines = search_.analyze(pos, limits, kMaxMoveNum);
+		auto played = std::find_if(lines.begin(), lines.end(), [&](const FAnalysisLine &line)
+		{
+			return line.move == move;
+		});
+		if (played == lines.end())
+		{
+			break;
+		}
+
+		FMoveReview review;
+		review.move = track;
+		review.best_move = lines.front().move.toMoveTrack();
+		review.score = played->score;
+		review.best_score = lines.front().score;
+		review.loss = review.best_score - review.score;
+		reviews.push_back(review);
+
+		pos.makeMove(move);
+	}
+	return reviews;
+}
+
+// 清空置换表
+void Analyzer::clear()
+{
+	tt_.clear();
+}
+
+// 设置评估权重
+void Analyzer::setEvalWeights(const FEvalWeights &weights)
+{
+	search_.setEvalWeights(weights);
+}
+
+// 统计失误次数
+int Analyzer::countBlunders(const std::vector<FMoveReview> &reviews, FChessPieceType type, FChessPieceType first, int threshold)
+{
+	int count = 0;
+	FChessPieceType side = first;
+	for (auto &review : reviews)
+	{
+		if ((type == FChessPieceType::NONE || type == side) && review.loss >= threshold)
+		{
+			++count;
+		}
+		side = helper::OpponentOf(side);
+	}
+	return count;
+}
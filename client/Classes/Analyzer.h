@@ -0,0 +1,79 @@
+﻿#ifndef __ANALYZER_H__
+#define __ANALYZER_H__
+
+#include <vector>
+#include "Search.h"
+#include "LogicBase.h"
+#include "TranspositionTable.h"
+
+/**
+ * 一步棋的复盘结果
+ */
+struct FMoveReview
+{
+	FMoveTrack	move;							// 实际走法
+	FMoveTrack	best_move;						// 最佳走法
+	int			score;							// 实际走法分数（走棋方视角）
+	int			best_score;						// 最佳走法分数（走棋方视角）
+	int			loss;							// 与最佳走法的分差
+};
+
+/**
+ * 局面分析，用于提示和赛后复盘
+ * 内部持有置换表，连续分析同一盘棋时可复用之前的搜索结果
+ * 非线程安全，同一时间只能在一个线程中使用
+ */
+class Analyzer
+{
+public:
+	explicit Analyzer(size_t tt_size_mb = 8);
+
+public:
+	/**
+	 * 分析局面，返回分数最高的前几个走法
+	 * @param FChessArray 棋盘
+	 * @param FChessPieceType 走棋方
+	 * @param int 返回的走法数量
+	 * @param FSearchLimits 搜索限制
+	 */
+	std::vector<FAnalysisLine> analyze(const FChessArray &checkerboard, FChessPieceType side, int multi_pv, const FSearchLimits &limits);
+
+	/**
+	 * 复盘整局棋，逐步给出实际走法与最佳走法的分差
+	 * @param FChessArray 初始棋盘
+	 * @param FChessPieceType 先手方
+	 * @param std::vector<FMoveTrack> 实际走法
+	 * @param FSearchLimits 每一步的搜索限制
+	 */
+	std::vector<FMoveReview> reviewGame(const FChessArray &initial, FChessPieceType first, const std::vector<FMoveTrack> &moves, const FSearchLimits &limits);
+
+	/**
+	 * 清空置换表
+	 */
+	void clear();
+
+	/**
+	 * 设置评估权重
+	 */
+	void setEvalWeights(const FEvalWeights &weights);
+
+public:
+	/**
+	 * 统计失误次数
+	 * @param std::vector<FMoveReview> 复盘结果
+	 * @param FChessPieceType 统计的一方（NONE表示双方）
+	 * @param FChessPieceType 先手方
+	 * @param int 分差阈值
+	 */
+	static int countBlunders(const std::vector<FMoveReview> &reviews, FChessPieceType type, FChessPieceType first, int threshold);
+
+private:
+	Analyzer(const Analyzer &) = delete;
+	Analyzer& operator= (const Analyzer &) = delete;
+
+private:
+	Search				search_;
+	TranspositionTable	tt_;
+};
+
+#endif
@@ -16,6 +16,15 @@ namespace
 	// 棋子选中显示层级
 	const int kSelectedChessPieceZOrder = 2;
 
+	// 提示高亮颜色
+	const Color3B kHintColor(255, 215, 0);
+
+	// 提示高亮渐变时间
+	const float kHintFadeTime = 0.2f;
+
+	// 提示高亮保持时间
+	const float kHintHoldTime = 1.0f;
+
 	Vec2 ToCocos2DVec2(const FVec2 &pos)
 	{
 		return Vec2(pos.x, pos.y);
@@ -27,13 +36,17 @@ namespace
 	}
 }
 
-CheckerboardLayer::CheckerboardLayer(SingleLogic *logic)
+CheckerboardLayer::CheckerboardLayer(LogicBase *logic)
 	: logic_(logic)
 	, action_lock_(false)
-	, action_read_pos_(0)
+	, action_consumer_(-1)
+	, scheduled_cursor_(0)
 	, operation_lock_(true)
+	, spectator_(false)
+	, animation_speed_(1.0f)
 	, selected_chesspiece_(nullptr)
 	, chesspiece_type_(FChessPieceType::NONE)
+	, pending_ticket_(FMoveTicket::invalid())
 {
 	for (size_t i = 0; i < chesspiece_sprite_.size(); ++i)
 	{
@@ -46,7 +59,7 @@ CheckerboardLayer::~CheckerboardLayer()
 
 }
 
-CheckerboardLayer* CheckerboardLayer::create(SingleLogic *logic)
+CheckerboardLayer* CheckerboardLayer::create(LogicBase *logic)
 {
 	assert(logic != nullptr);
 	CheckerboardLayer *ret = new (std::nothrow) CheckerboardLayer(logic);
@@ -80,6 +93,7 @@ bool CheckerboardLayer::init()
 	}
 
 	const Color4B color(ColorGenerator::instance()->rand());
+	floor_color_ = Color3B(color);
 	for (size_t i = 0; i < color_floor_.size(); ++i)
 	{
 		int index = (i % kCheckerboardRowNum) % 2;
@@ -98,21 +112,35 @@ bool CheckerboardLayer::init()
 	listener->onTouchCancelled = CC_CALLBACK_2(CheckerboardLayer::onTouchCancelled, this);
 	getEventDispatcher()->addEventListenerWithSceneGraphPriority(listener, this);
 
-	// 接收逻辑更新通知
-	logic_->addActionUpdateCallback(std::bind(&CheckerboardLayer::updateAction, this));
+	// 接收逻辑更新通知，动画按自己的读取位置逐个播放
+	action_consumer_ = logic_->addActionConsumer();
+	logic_->addActionListener(helper::ActionMask(FActionType::START) | helper::ActionMask(FActionType::MOVED)
+		| helper::ActionMask(FActionType::KILLED) | helper::ActionMask(FActionType::STANDBY)
+		| helper::ActionMask(FActionType::GAMEOVER) | helper::ActionMask(FActionType::DRAW)
+		| helper::ActionMask(FActionType::UNDO) | helper::ActionMask(FActionType::REDO),
+		std::bind(&CheckerboardLayer::updateAction, this));
+
+	// 走棋被拒绝时不会产生动作，需要每帧查询结果
+	scheduleUpdate();
 
 	return true;
 }
 
+void CheckerboardLayer::update(float delta)
+{
+	checkPendingMove();
+}
+
 // 重置
 void CheckerboardLayer::reset(FChessPieceType type)
 {
 	assert(logic_ != nullptr);
 	assert(type != FChessPieceType::NONE);
+	stopAllActions();
 	action_lock_ = false;
-	action_read_pos_ = 0;
 	operation_lock_ = true;
 	chesspiece_type_ = type;
+	pending_ticket_ = FMoveTicket::invalid();
 }
 
 // 获取棋子开始位置
@@ -130,6 +158,29 @@ FChessPieceType CheckerboardLayer::getChesspieceType() const
 	return chesspiece_type_;
 }
 
+// 观战模式
+void CheckerboardLayer::setSpectator(bool spectator)
+{
+	spectator_ = spectator;
+}
+
+// 动画播放速度
+void CheckerboardLayer::setAnimationSpeed(float speed)
+{
+	assert(speed > 0.0f);
+	animation_speed_ = speed;
+}
+
+// 设置游戏提示
+void CheckerboardLayer::setGameTips(const std::string &str)
+{
+	GameScene *parent = dynamic_cast<GameScene *>(getParent());
+	if (parent != nullptr)
+	{
+		parent->setGameTips(str);
+	}
+}
+
 // 棋盘坐标转视图坐标
 Vec2 CheckerboardLayer::convertToViewSpace(const Vec2 &pos) const
 {
@@ -173,9 +224,37 @@ Sprite* CheckerboardLayer::getChesspieceSprite(const Vec2 &pos)
 	return chesspiece_sprite_[index];
 }
 
+// 取出空闲的棋子精灵
+Sprite* CheckerboardLayer::acquireChesspieceSprite(FChessPieceType type)
+{
+	const char *filename = type == FChessPieceType::WHITE ? "whiteplay.png" : "blackplay.png";
+	Sprite *chesspiece = nullptr;
+	if (free_sprite_.empty())
+	{
+		chesspiece = Sprite::create(filename);
+		chesspiece->setScale(Director::getInstance()->getContentScaleFactor());
+		addChild(chesspiece);
+	}
+	else
+	{
+		chesspiece = free_sprite_.back();
+		free_sprite_.pop_back();
+		Texture2D *texture = Director::getInstance()->getTextureCache()->addImage(filename);
+		chesspiece->setTexture(texture);
+		chesspiece->setTextureRect(Rect(0, 0, texture->getContentSize().width, texture->getContentSize().height));
+		chesspiece->setVisible(true);
+		chesspiece->setOpacity(255);
+	}
+	chesspiece->setLocalZOrder(kNormalChessPieceZOrder);
+	return chesspiece;
+}
+
 // 刷新棋盘
 void CheckerboardLayer::refreshCheckerboard()
 {
+	// 棋盘按逻辑重新绘制，之前提交的走棋不再需要退回
+	pending_ticket_ = FMoveTicket::invalid();
+
 	// 清理棋子精灵
 	for (size_t i = 0; i < chesspiece_sprite_.size(); ++i)
 	{
@@ -194,25 +273,8 @@ void CheckerboardLayer::refreshCheckerboard()
 	{
 		if (value != 0)
 		{
-			Sprite *chesspiece = nullptr;
-			if (free_sprite_.empty())
-			{
-				chesspiece = Sprite::create(value == 1 ? "whiteplay.png" : "blackplay.png");
-				chesspiece->setScale(Director::getInstance()->getContentScaleFactor());
-				addChild(chesspiece);
-			}
-			else
-			{
-				chesspiece = free_sprite_.back();
-				free_sprite_.pop_back();
-				Texture2D *texture = Director::getInstance()->getTextureCache()->addImage(value == 1 ? "whiteplay.png" : "blackplay.png");
-				chesspiece->setTexture(texture);
-				chesspiece->setTextureRect(Rect(0, 0, texture->getContentSize().width, texture->getContentSize().height));
-				chesspiece->setVisible(true);
-				chesspiece->setOpacity(255);
-			}
+			Sprite *chesspiece = acquireChesspieceSprite(static_cast<FChessPieceType>(value));
 			chesspiece->setPosition(convertToWorldSpace(ToCocos2DVec2(pos)));
-			chesspiece->setLocalZOrder(kNormalChessPieceZOrder);
 			int index = pos.y * kCheckerboardColNum + pos.x;
 			assert(chesspiece_sprite_[index] == nullptr);
 			chesspiece_sprite_[index] = chesspiece;
@@ -220,43 +282,150 @@ void CheckerboardLayer::refreshCheckerboard()
 	});
 }
 
-// 移动棋子
-void CheckerboardLayer::onMoveChesspiece(const Vec2 &source, const Vec2 &target)
+// 重新同步棋盘
+void CheckerboardLayer::resyncCheckerboard()
+{
+	refreshCheckerboard();
+
+	// 棋盘已是最新局面，剩余的动作不再播放，只取最后的回合状态用于提示
+	FAction status = { FActionType::START, FChessPieceType::NONE, FVec2::invalid(), FVec2::invalid() };
+	for (FActionSpan actions = logic_->peekActions(action_consumer_); !actions.empty(); actions = logic_->peekActions(action_consumer_))
+	{
+		for (const FAction action : actions)
+		{
+			if (action.type == FActionType::STANDBY || action.type == FActionType::GAMEOVER || action.type == FActionType::DRAW)
+			{
+				status = action;
+			}
+		}
+		logic_->consumeActions(action_consumer_, actions.size());
+	}
+
+	operation_lock_ = logic_->isGameOver() || logic_->getStandbyChesspieceType() == getChesspieceType();
+	if (status.type == FActionType::STANDBY)
+	{
+		setGameTips(getChesspieceType() == status.chess_type ? lang("wait") : lang("play_chess"));
+	}
+	else if (status.type == FActionType::GAMEOVER)
+	{
+		setGameTips(getChesspieceType() == status.chess_type ? lang("win") : lang("lost"));
+	}
+	else if (status.type == FActionType::DRAW)
+	{
+		setGameTips(lang(logic_->getDrawReason() == FDrawReason::REPETITION ? "draw_repetition" : "draw_move_limit"));
+	}
+}
+
+// 检查提交的走棋结果
+void CheckerboardLayer::checkPendingMove()
+{
+	if (!pending_ticket_.isValid())
+	{
+		return;
+	}
+
+	FMoveResult result = logic_->getMoveResult(pending_ticket_);
+	if (result == FMoveResult::PENDING)
+	{
+		return;
+	}
+
+	pending_ticket_ = FMoveTicket::invalid();
+	if (result == FMoveResult::ACCEPTED)
+	{
+		return;
+	}
+
+	// 走棋没有被执行，棋子退回原位
+	int s_index = pending_source_.y * kCheckerboardColNum + pending_source_.x;
+	int t_index = pending_target_.y * kCheckerboardColNum + pending_target_.x;
+	std::swap(chesspiece_sprite_[s_index], chesspiece_sprite_[t_index]);
+	if (chesspiece_sprite_[s_index] != nullptr)
+	{
+		chesspiece_sprite_[s_index]->setPosition(convertToWorldSpace(pending_source_));
+	}
+
+	// 对局结束或重新开始时保持锁定，其他情况仍是自己的回合
+	if (result != FMoveResult::GAME_OVER && result != FMoveResult::CANCELLED)
+	{
+		operation_lock_ = false;
+	}
+}
+
+// 移动棋子动画
+FiniteTimeAction* CheckerboardLayer::createMoveAction(const Vec2 &source, const Vec2 &target)
 {
 	Sprite *chesspiece = getChesspieceSprite(source);
 	assert(chesspiece != nullptr);
-	if (chesspiece != nullptr)
+	if (chesspiece == nullptr)
 	{
-		Vec2 world_pos = convertToWorldSpace(target);
-		chesspiece->runAction(Sequence::create(
-			MoveTo::create(0.1f, world_pos),
-			CallFunc::create([=]()
-		{
-			int s_index = source.y * kCheckerboardColNum + source.x;
-			int t_index = target.y * kCheckerboardColNum + target.x;
-			std::swap(chesspiece_sprite_[s_index], chesspiece_sprite_[t_index]);
-		}),
-			CallFunc::create(std::bind(&CheckerboardLayer::actionFinished, this)),
-			nullptr));
+		return nullptr;
 	}
+
+	Vec2 world_pos = convertToWorldSpace(target);
+	return Sequence::create(
+		TargetedAction::create(chesspiece, MoveTo::create(0.1f, world_pos)),
+		CallFunc::create([=]()
+	{
+		int s_index = source.y * kCheckerboardColNum + source.x;
+		int t_index = target.y * kCheckerboardColNum + target.x;
+		std::swap(chesspiece_sprite_[s_index], chesspiece_sprite_[t_index]);
+	}),
+		nullptr);
 }
 
-// 吃掉棋子
-void CheckerboardLayer::onKillChesspiece(const Vec2 &source, const Vec2 &target)
+// 吃掉棋子动画
+FiniteTimeAction* CheckerboardLayer::createKillAction(const Vec2 &target)
 {
 	Sprite *chesspiece = getChesspieceSprite(target);
 	assert(chesspiece != nullptr);
-	if (chesspiece != nullptr)
+	if (chesspiece == nullptr)
 	{
-		chesspiece->runAction(Sequence::create(
-			FadeOut::create(0.5f),
-			CallFunc::create([=]()
-		{
-			int index = target.y * kCheckerboardColNum + target.x;
-			free_sprite_.push_back(chesspiece_sprite_[index]);
-			chesspiece_sprite_[index] = nullptr;
-		}),
-			CallFunc::create(std::bind(&CheckerboardLayer::actionFinished, this)),
+		return nullptr;
+	}
+
+	return Sequence::create(
+		TargetedAction::create(chesspiece, FadeOut::create(0.5f)),
+		CallFunc::create([=]()
+	{
+		int index = target.y * kCheckerboardColNum + target.x;
+		free_sprite_.push_back(chesspiece_sprite_[index]);
+		chesspiece_sprite_[index] = nullptr;
+	}),
+		nullptr);
+}
+
+// 被吃掉的棋子复活动画
+FiniteTimeAction* CheckerboardLayer::createReviveAction(const Vec2 &target, FChessPieceType type)
+{
+	// 吃掉棋子的动画都已播放完，格子是空的；安排时就占住格子，淡入后显示
+	int index = target.y * kCheckerboardColNum + target.x;
+	assert(chesspiece_sprite_[index] == nullptr);
+	if (chesspiece_sprite_[index] != nullptr)
+	{
+		return nullptr;
+	}
+
+	Sprite *chesspiece = acquireChesspieceSprite(type);
+	chesspiece->setPosition(convertToWorldSpace(target));
+	chesspiece->setOpacity(0);
+	chesspiece_sprite_[index] = chesspiece;
+	return TargetedAction::create(chesspiece, FadeIn::create(0.3f));
+}
+
+// 显示提示走法
+void CheckerboardLayer::showHint(const FMoveTrack &track)
+{
+	for (const FVec2 &pos : { track.source, track.target })
+	{
+		Vec2 view_pos = convertToViewSpace(ToCocos2DVec2(pos));
+		LayerColor *floor = color_floor_[view_pos.y * kCheckerboardColNum + view_pos.x];
+		floor->stopAllActions();
+		floor->setColor(floor_color_);
+		floor->runAction(Sequence::create(
+			TintTo::create(kHintFadeTime, kHintColor.r, kHintColor.g, kHintColor.b),
+			DelayTime::create(kHintHoldTime),
+			TintTo::create(kHintFadeTime, floor_color_.r, floor_color_.g, floor_color_.b),
 			nullptr));
 	}
 }
@@ -270,78 +439,145 @@ void CheckerboardLayer::updateAction()
 // 执行动作
 void CheckerboardLayer::runPlayerAction()
 {
-	if (!action_lock_)
+	if (action_lock_)
 	{
-		FAction action = logic_->getActionFromQueue(action_read_pos_);
-		if (action.type != FActionType::NONE)
-		{
-			action_lock_ = true;
+		return;
+	}
 
-			switch (action.type)
+	// 丢失了动作时精灵与棋盘不再对应，不能继续播放
+	if (logic_->takeActionOverflow(action_consumer_))
+	{
+		resyncCheckerboard();
+		return;
+	}
+
+	FActionSpan actions = logic_->peekActions(action_consumer_);
+	if (actions.empty())
+	{
+		return;
+	}
+
+	// 一次安排一个回合（到待机或开始为止）的全部动画，按顺序播放
+	// 同一回合中移动与吃掉的棋子不是同一个，可以在安排时就确定每个动画的棋子精灵
+	Vector<FiniteTimeAction *> steps;
+	size_t count = 0;
+	bool turn_end = false;
+	while (count < actions.size() && !turn_end)
+	{
+		const FAction action = actions[count++];
+		switch (action.type)
+		{
+			// 开始游戏
+			case FActionType::START:
 			{
-				// 开始游戏
-				case FActionType::START:
-				{
-					refreshCheckerboard();
-					runAction(Sequence::create(CallFunc::create(std::bind(&CheckerboardLayer::actionFinished, this)), nullptr));
-					break;
-				}
-				// 移动棋子
-				case FActionType::MOVED:
+				steps.pushBack(CallFunc::create(std::bind(&CheckerboardLayer::refreshCheckerboard, this)));
+				turn_end = true;
+				break;
+			}
+			// 移动棋子
+			case FActionType::MOVED:
+			{
+				// 自己的移动操作实时处理，不通过逻辑处理器进行
+				if (spectator_ || action.chess_type != getChesspieceType())
 				{
-					// 自己的移动操作实时处理，不通过逻辑处理器进行
-					if (action.chess_type != getChesspieceType())
+					FiniteTimeAction *step = createMoveAction(ToCocos2DVec2(action.source), ToCocos2DVec2(action.target));
+					if (step != nullptr)
 					{
-						onMoveChesspiece(ToCocos2DVec2(action.source), ToCocos2DVec2(action.target));
+						steps.pushBack(step);
 					}
-					else
-					{
-						runAction(Sequence::create(CallFunc::create(std::bind(&CheckerboardLayer::actionFinished, this)), nullptr));
-					}
-					break;
 				}
-				// 杀掉棋子
-				case FActionType::KILLED:
+				break;
+			}
+			// 重做（自己的棋子也需要播放）
+			case FActionType::REDO:
+			{
+				FiniteTimeAction *step = createMoveAction(ToCocos2DVec2(action.source), ToCocos2DVec2(action.target));
+				if (step != nullptr)
 				{
-					onKillChesspiece(ToCocos2DVec2(action.source), ToCocos2DVec2(action.target));
-					break;
+					steps.pushBack(step);
 				}
-				// 玩家待机
-				case FActionType::STANDBY:
+				break;
+			}
+			// 悔棋，棋子退回或被吃掉的棋子复活
+			case FActionType::UNDO:
+			{
+				FiniteTimeAction *step = action.source != FVec2::invalid()
+					? createMoveAction(ToCocos2DVec2(action.source), ToCocos2DVec2(action.target))
+					: createReviveAction(ToCocos2DVec2(action.target), action.chess_type);
+				if (step != nullptr)
 				{
-					operation_lock_ = action.chess_type == getChesspieceType();
-					runAction(Sequence::create(CallFunc::create(std::bind(&CheckerboardLayer::actionFinished, this)), nullptr));
-					GameScene *parent = dynamic_cast<GameScene *>(getParent());
-					parent->setGameTips(getChesspieceType() == action.chess_type ? lang("wait") : lang("play_chess"));
-					break;
+					steps.pushBack(step);
 				}
-				// 游戏结束
-				case FActionType::GAMEOVER:
+				break;
+			}
+			// 杀掉棋子
+			case FActionType::KILLED:
+			{
+				FiniteTimeAction *step = createKillAction(ToCocos2DVec2(action.target));
+				if (step != nullptr)
 				{
-					operation_lock_ = true;
-					runAction(Sequence::create(CallFunc::create(std::bind(&CheckerboardLayer::actionFinished, this)), nullptr));
-					GameScene *parent = dynamic_cast<GameScene *>(getParent());
-					parent->setGameTips(getChesspieceType() == action.chess_type ? lang("win") : lang("lost"));
-					break;
+					steps.pushBack(step);
 				}
-				default:
-					actionFinished();
+				break;
+			}
+			// 玩家待机
+			case FActionType::STANDBY:
+			{
+				steps.pushBack(CallFunc::create([=]()
+				{
+					operation_lock_ = action.chess_type == getChesspieceType();
+					setGameTips(getChesspieceType() == action.chess_type ? lang("wait") : lang("play_chess"));
+				}));
+				turn_end = true;
+				break;
 			}
+			// 游戏结束
+			case FActionType::GAMEOVER:
+			{
+				operation_lock_ = true;
+				steps.pushBack(CallFunc::create([=]()
+				{
+					setGameTips(getChesspieceType() == action.chess_type ? lang("win") : lang("lost"));
+				}));
+				break;
+			}
+			// 和棋
+			case FActionType::DRAW:
+			{
+				operation_lock_ = true;
+				steps.pushBack(CallFunc::create([=]()
+				{
+					setGameTips(lang(logic_->getDrawReason() == FDrawReason::REPETITION ? "draw_repetition" : "draw_move_limit"));
+				}));
+				break;
+			}
+			default:
+				break;
 		}
 	}
+
+	action_lock_ = true;
+	scheduled_cursor_ = logic_->getActionCursor(action_consumer_) + count;
+	steps.pushBack(CallFunc::create(std::bind(&CheckerboardLayer::actionFinished, this)));
+	runAction(Speed::create(Sequence::create(steps), animation_speed_));
 }
 
 // 完成动作
 void CheckerboardLayer::actionFinished()
 {
-	++action_read_pos_;
+	// 播放期间重新开始时读取位置已经跳过了这些动作
+	uint64_t cursor = logic_->getActionCursor(action_consumer_);
+	if (cursor < scheduled_cursor_)
+	{
+		logic_->consumeActions(action_consumer_, static_cast<size_t>(scheduled_cursor_ - cursor));
+	}
 	action_lock_ = false;
 	runPlayerAction();
 }
 
 bool CheckerboardLayer::onTouchBegan(Touch *touch, Event *unused_event)
 {
-	if (!action_lock_ && !operation_lock_)
+	if (!action_lock_ && !operation_lock_ && !spectator_)
 	{
 		Vec2 chesspiece_pos = convertToCheckerboardSpace(touch->getLocation());
 		if (logic_->getChesspieceType(ToCheckerboardVec2(chesspiece_pos)) == getChesspieceType())
@@ -380,12 +616,17 @@ void CheckerboardLayer::onTouchEnded(Touch *touch, Event *unused_event)
 			!logic_->isValidChesspiece(ToCheckerboardVec2(target)) &&
 			!operation_lock_)
 		{
+			// 先移动棋子，走棋结果确定前不能再操作，没有被执行时退回原位
 			selected_chesspiece_->setPosition(convertToWorldSpace(target));
-			logic_->moveChesspiece(ToCheckerboardVec2(source), ToCheckerboardVec2(target));
+			pending_ticket_ = logic_->moveChesspiece(ToCheckerboardVec2(source), ToCheckerboardVec2(target));
+			pending_source_ = source;
+			pending_target_ = target;
+			operation_lock_ = true;
 
 			int s_index = source.y * kCheckerboardColNum + source.x;
 			int t_index = target.y * kCheckerboardColNum + target.x;
 			std::swap(chesspiece_sprite_[s_index], chesspiece_sprite_[t_index]);
+			checkPendingMove();
 		}
 		else
 		{
@@ -3,7 +3,7 @@
 
 #include <array>
 #include "cocos2d.h"
-#include "SingleLogic.h"
+#include "LogicBase.h"
 
 class CheckerboardLayer : public cocos2d::Layer
 {
@@ -14,13 +14,15 @@ public:
 	static const int kChessspieceSum = kCheckerboardRowNum * kCheckerboardColNum;
 
 public:
-	CheckerboardLayer(SingleLogic *logic);
+	CheckerboardLayer(LogicBase *logic);
 
 	~CheckerboardLayer();
 
 	virtual bool init() override;
 
-	static CheckerboardLayer* create(SingleLogic *logic);
+	virtual void update(float delta) override;
+
+	static CheckerboardLayer* create(LogicBase *logic);
 
 public:
 	/**
@@ -38,6 +40,16 @@ public:
 	 */
 	FChessPieceType getChesspieceType() const;
 
+	/**
+	 * 观战模式（回放），不能操作棋子，双方的走棋都播放动画
+	 */
+	void setSpectator(bool spectator);
+
+	/**
+	 * 动画播放速度（1为正常速度）
+	 */
+	void setAnimationSpeed(float speed);
+
 	/**
 	 * 棋盘坐标转换到世界坐标
 	 */
@@ -48,13 +60,18 @@ public:
 	 */
 	cocos2d::Vec2 convertToCheckerboardSpace(const cocos2d::Vec2 &pos) const;
 
+	/**
+	 * 显示提示走法（短暂高亮起点和终点）
+	 */
+	void showHint(const FMoveTrack &track);
+
 	/**
 	 * 更新动作
 	 */
 	void updateAction();
 
 	/**
-	 * 执行动作
+	 * 执行动作（一次安排一个回合的全部动画）
 	 */
 	void runPlayerAction();
 
@@ -78,6 +95,16 @@ private:
 	 */
 	void refreshCheckerboard();
 
+	/**
+	 * 未读动作被覆盖时，按当前局面重新绘制并跳过剩余动作
+	 */
+	void resyncCheckerboard();
+
+	/**
+	 * 检查提交的走棋结果，没有被执行时把棋子退回原位
+	 */
+	void checkPendingMove();
+
 	/**
 	 * 棋盘坐标转视图坐标
 	 */
@@ -89,23 +116,45 @@ private:
 	cocos2d::Sprite* getChesspieceSprite(const cocos2d::Vec2 &pos);
 
 	/**
-	 * 移动棋子
+	 * 取出一个空闲的棋子精灵（没有时新建）
+	 */
+	cocos2d::Sprite* acquireChesspieceSprite(FChessPieceType type);
+
+	/**
+	 * 创建移动棋子的动画
+	 */
+	cocos2d::FiniteTimeAction* createMoveAction(const cocos2d::Vec2 &source, const cocos2d::Vec2 &target);
+
+	/**
+	 * 创建吃掉棋子的动画
+	 */
+	cocos2d::FiniteTimeAction* createKillAction(const cocos2d::Vec2 &target);
+
+	/**
+	 * 创建悔棋时被吃掉的棋子复活的动画
 	 */
-	void onMoveChesspiece(const cocos2d::Vec2 &source, const cocos2d::Vec2 &target);
+	cocos2d::FiniteTimeAction* createReviveAction(const cocos2d::Vec2 &target, FChessPieceType type);
 
 	/**
-	 * 吃掉棋子
+	 * 设置游戏提示（父节点为游戏场景时）
 	 */
-	void onKillChesspiece(const cocos2d::Vec2 &source, const cocos2d::Vec2 &target);
+	void setGameTips(const std::string &str);
 
 private:
-	SingleLogic*										logic_;
+	LogicBase*											logic_;
 	bool												action_lock_;
 	bool												operation_lock_;
-	int													action_read_pos_;
+	bool												spectator_;
+	float												animation_speed_;
+	int													action_consumer_;
+	uint64_t											scheduled_cursor_;
 	FChessPieceType										chesspiece_type_;
 	cocos2d::Sprite*									selected_chesspiece_;
 	cocos2d::Vec2										touch_begin_pos_;
+	FMoveTicket											pending_ticket_;
+	cocos2d::Vec2										pending_source_;
+	cocos2d::Vec2										pending_target_;
+	cocos2d::Color3B									floor_color_;
 	std::vector<cocos2d::Sprite *>						free_sprite_;
 	std::array<cocos2d::Sprite *, kChessspieceSum>		chesspiece_sprite_;
 	std::array<cocos2d::LayerColor*, kChessspieceSum>	color_floor_;
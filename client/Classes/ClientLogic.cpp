@@ -55,7 +55,8 @@ FChessPieceType ClientLogic::getBelowplayerChesspieceType() const
 }
 
 // 移动棋子
-void ClientLogic::moveChesspiece(const FVec2 &source, const FVec2 &target)
+FMoveTicket ClientLogic::moveChesspiece(const FVec2 &source, const FVec2 &target)
 {
 	// 移动棋子
+	return FMoveTicket::invalid();
 }
\ No newline at end of file
@@ -33,7 +33,7 @@ public:
 	virtual FChessPieceType getBelowplayerChesspieceType() const override;
 
 	// 移动棋子
-	virtual void moveChesspiece(const FVec2 &source, const FVec2 &target) override;
+	virtual FMoveTicket moveChesspiece(const FVec2 &source, const FVec2 &target) override;
 };
 
 #endif
\ No newline at end of file
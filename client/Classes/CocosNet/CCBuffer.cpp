@@ -92,10 +92,13 @@ Buffer::Buffer()
 , _u_write_pos(0)
 , _u_read_pos(0)
 , _u_content_size(0)
-, _u_buffer_size(CCBUFFER_ORGINAL_SIZE)
+, _u_buffer_size(0)
 , _u_mark_pos(0)
+, _u_head_room(0)
+, _b_view(false)
+, _p_next(NULL)
 {
-	DO_ASSIGN(_p_buffer, (char*) malloc(_u_buffer_size));
+	_allocStorage(CCBUFFER_ORGINAL_SIZE);
 }
 
 Buffer::Buffer(unsigned int n_capacity)
@@ -103,30 +106,36 @@ Buffer::Buffer(unsigned int n_capacity)
 , _u_write_pos(0)
 , _u_read_pos(0)
 , _u_content_size(0)
+, _u_buffer_size(0)
 , _u_mark_pos(0)
+, _u_head_room(0)
+, _b_view(false)
+, _p_next(NULL)
 {
-	DO_ASSIGN(_u_buffer_size, n_capacity);
-	DO_ASSIGN(_p_buffer, (char*) malloc(_u_buffer_size));
+	_allocStorage(n_capacity);
 }
 
 Buffer::Buffer(const char* p_data, unsigned int u_len)
 : _p_buffer(NULL)
 , _u_read_pos(0)
 , _u_mark_pos(0)
+, _u_head_room(0)
+, _b_view(false)
+, _p_next(NULL)
 {
 	DO_ASSERT(p_data && LD(u_len, 0), "p_data && u_len > 0");
 
-	DO_ASSIGN(_u_buffer_size, u_len);
+	_allocStorage(u_len);
 	DO_ASSIGN(_u_write_pos, u_len);
 	DO_ASSIGN(_u_content_size, u_len);
-	DO_ASSIGN(_p_buffer, (char*) malloc(u_len));
 
 	memcpy(_p_buffer, p_data, u_len);
 }
 
 Buffer::~Buffer()
 {
-	CC_SAFE_FREE(_p_buffer);
+	_freeStorage();
+	CC_SAFE_RELEASE(_p_next);
 }
 
 Buffer* Buffer::create()
@@ -150,6 +159,16 @@ Buffer* Buffer::create(const char* p_data, unsigned int u_len)
 	DO_RETURN_R(pRet);
 }
 
+void* Buffer::operator new(size_t u_size)
+{
+	DO_RETURN_R(BufferPool::allocate(TO_UINT(u_size)));
+}
+
+void Buffer::operator delete(void* p, size_t u_size)
+{
+	BufferPool::deallocate(p, TO_UINT(u_size));
+}
+
 Ref* Buffer::copy()
 {
 	BEGIN_IF(LD(_u_content_size, 0))
@@ -256,6 +275,7 @@ void Buffer::moveLeft(unsigned int u_len)
 	BEGIN_IF(LE(_u_content_size, 0))
 	DO_RETURN;
 	END_IF
+	_detachView();
 	DO_ASSERT(LNE(u_len, 0), "LNE(u_len, 0)");
 	BEGIN_IF(LDE(u_len, _u_content_size)) clear();
 	BEGIN_ELSE
@@ -275,6 +295,7 @@ void Buffer::moveRight(unsigned int u_len)
 	BEGIN_IF(LE(_u_content_size, 0))
 	DO_RETURN;
 	END_IF
+	_detachView();
 	_reallocBufferSizeInChanged(u_len);
 	BEGIN_FOR(DO_ASSIGN(int i, CS(_u_content_size, 1)), LDE(i, 0), SSI(i))
 	DO_ASSIGN(QV(CA(CA(_p_buffer, i), TO_INT(u_len))), QV(CA(_p_buffer, i)));
@@ -324,6 +345,11 @@ char* Buffer::data() const
 
 void Buffer::clear()
 {
+	BEGIN_IF(_b_view)
+	DO_ASSIGN(_p_buffer, NULL);
+	DO_ASSIGN(_b_view, R_FALSE);
+	_allocStorage(CCBUFFER_ORGINAL_SIZE);
+	END_IF
 	DO_ASSIGN(_u_content_size, 0);
 	DO_ASSIGN(_u_write_pos, 0);
 	DO_ASSIGN(_u_read_pos, 0);
@@ -331,10 +357,129 @@ void Buffer::clear()
 	memset(_p_buffer, 0, _u_buffer_size);
 }
 
+void Buffer::setView(const char* p_data, unsigned int u_len)
+{
+	_freeStorage();
+	DO_ASSIGN(_p_buffer, (char*) p_data);
+	DO_ASSIGN(_u_head_room, 0);
+	DO_ASSIGN(_u_buffer_size, u_len);
+	DO_ASSIGN(_u_content_size, u_len);
+	DO_ASSIGN(_u_write_pos, u_len);
+	DO_ASSIGN(_u_read_pos, 0);
+	DO_ASSIGN(_u_mark_pos, 0);
+	DO_ASSIGN(_b_view, R_TRUE);
+}
+
+bool Buffer::isView() const
+{
+	DO_RETURN_R(_b_view);
+}
+
+void Buffer::_detachView()
+{
+	BEGIN_IF(_b_view)
+	DO_ASSIGN(char* p_view, _p_buffer);
+	DO_ASSIGN(_p_buffer, NULL);
+	DO_ASSIGN(_b_view, R_FALSE);
+	_allocStorage(MAX(_u_buffer_size, CCBUFFER_ORGINAL_SIZE));
+	memcpy(_p_buffer, p_view, _u_content_size);
+	END_IF
+}
+
+void Buffer::prependData(const char* p_data, unsigned int u_len)
+{
+	DO_ASSERT(LQ(p_data, LD(u_len,0)), "LQ(p_data, LD(u_len,0))");
+	_detachView();
+	BEGIN_IF(LD(u_len, _u_head_room))
+	// not enough room, move the content back once to make it
+	DO_ASSIGN(char* p_old, CS(_p_buffer, _u_head_room));
+	DO_ASSIGN(unsigned int u_old_size, CA(_u_head_room, _u_buffer_size));
+	DO_ASSIGN(char* p_content, _p_buffer);
+	DO_ASSIGN(unsigned int u_size, _u_buffer_size);
+	DO_ASSIGN(_p_buffer, NULL);
+	_allocStorage(u_size, CA(CCBUFFER_HEAD_ROOM, u_len));
+	memcpy(_p_buffer, p_content, _u_content_size);
+	BufferPool::deallocate(p_old, u_old_size);
+	END_IF
+	AS(_p_buffer, u_len);
+	AS(_u_head_room, u_len);
+	AA(_u_buffer_size, u_len);
+	AA(_u_content_size, u_len);
+	AA(_u_write_pos, u_len);
+	AA(_u_read_pos, u_len);
+	AA(_u_mark_pos, u_len);
+	memcpy(_p_buffer, p_data, u_len);
+}
+
+void Buffer::prependUInt(unsigned int data)
+{
+	DO_ASSIGN(char p_data[sizeof(unsigned int)], {0});
+	memcpy(p_data, (char*)(QZ(data)), sizeof(unsigned int));
+#if MEMORYTYPE_REVERSE
+	std::reverse(QZ(p_data[0]), QZ(p_data[sizeof(unsigned int)]));
+#endif
+	prependData(p_data, sizeof(unsigned int));
+}
+
+unsigned int Buffer::getHeadRoom() const
+{
+	DO_RETURN_R(_u_head_room);
+}
+
+void Buffer::appendBuffer(Buffer* p_buffer)
+{
+	DO_ASSERT(LQ(p_buffer, LNE(p_buffer, this)), "LQ(p_buffer, LNE(p_buffer, this))");
+	DO_ASSIGN(Buffer* p_tail, this);
+	BEGIN_WHILE(p_tail->_p_next)
+	DO_ASSIGN(p_tail, p_tail->_p_next);
+	END_WHILE
+	p_buffer->retain();
+	DO_ASSIGN(p_tail->_p_next, p_buffer);
+}
+
+Buffer* Buffer::getNextBuffer() const
+{
+	DO_RETURN_R(_p_next);
+}
+
+unsigned int Buffer::getChainLength() const
+{
+	DO_ASSIGN(unsigned int u_len, 0);
+	BEGIN_FOR(DO_ASSIGN(const Buffer* p_buf, this), p_buf, DO_ASSIGN(p_buf, p_buf->_p_next))
+	AA(u_len, p_buf->_u_content_size);
+	END_FOR
+	DO_RETURN_R(u_len);
+}
+
+void Buffer::_allocStorage(unsigned int u_size, unsigned int u_head_room)
+{
+	_freeStorage();
+	// the block is rounded up to its size class, the rest becomes capacity
+	DO_ASSIGN(unsigned int u_block_size, 0);
+	DO_ASSIGN(char* p_storage, (char*) BufferPool::allocate(CA(u_head_room, u_size), QZ(u_block_size)));
+	DO_ASSIGN(_p_buffer, CA(p_storage, u_head_room));
+	DO_ASSIGN(_u_head_room, u_head_room);
+	DO_ASSIGN(_u_buffer_size, CS(u_block_size, u_head_room));
+}
+
+void Buffer::_freeStorage()
+{
+	BEGIN_IF(LQ(!_b_view, _p_buffer))
+	BufferPool::deallocate(CS(_p_buffer, _u_head_room), CA(_u_head_room, _u_buffer_size));
+	END_IF
+	DO_ASSIGN(_p_buffer, NULL);
+}
+
 void Buffer::_reallocBufferSize()
 {
-	DO_ASSIGN(_u_buffer_size, CM(_u_buffer_size, 2));
-	DO_ASSIGN(_p_buffer, (char*) realloc(_p_buffer, _u_buffer_size));
+	// a bigger block of the pool instead of realloc, the old one goes back to its size class
+	DO_ASSIGN(char* p_old, CS(_p_buffer, _u_head_room));
+	DO_ASSIGN(unsigned int u_old_size, CA(_u_head_room, _u_buffer_size));
+	DO_ASSIGN(char* p_content, _p_buffer);
+	DO_ASSIGN(_p_buffer, NULL);
+	_allocStorage(MAX(CM(_u_buffer_size, 2), 1), _u_head_room);
+	memcpy(_p_buffer, p_content, _u_content_size);
+	BufferPool::deallocate(p_old, u_old_size);
 }
 
 void Buffer::_reallocBufferSizeInChanged(unsigned int u_len)
@@ -351,6 +496,7 @@ void Buffer::_reallocBufferSizeInChanged(unsigned int u_len)
 void Buffer::writeData(const char* p_data, unsigned int u_len)
 {
 	DO_ASSERT(LQ(p_data, LD(u_len,0)), "LQ(p_data, LD(u_len,0))");
+	_detachView();
 	_reallocBufferSizeInChanged(u_len);
 	memcpy(CA(_p_buffer, _u_write_pos), p_data, u_len);
 	AA(_u_write_pos, u_len);
@@ -365,6 +511,7 @@ void Buffer::writeLengthAndData(const char* p_data, unsigned int u_len)
 
 void Buffer::writeChar(char data)
 {
+	_detachView();
 	_reallocBufferSizeInChanged(sizeof(char));
 	DO_ASSIGN(QV(CA(_p_buffer, _u_write_pos)), data);
 	AAI(_u_write_pos);
@@ -484,11 +631,11 @@ char* Buffer::readWholeData()
 Buffer* Buffer::readData(unsigned int u_len)
 {
 	BEGIN_IF(isReadable(u_len))
-	DO_ASSIGN(char* p_data, (char*) malloc(u_len));
-	readData(p_data, u_len);
-	DO_ASSIGN(Buffer* p_ret, new Buffer(p_data, u_len));
+	DO_ASSIGN(Buffer* p_ret, new Buffer(u_len));
+	readData(p_ret->_p_buffer, u_len);
+	DO_ASSIGN(p_ret->_u_write_pos, u_len);
+	DO_ASSIGN(p_ret->_u_content_size, u_len);
 	p_ret->autorelease();
-	CC_SAFE_FREE(p_data);
 	DO_RETURN_R(p_ret);
 	BEGIN_ELSE
 	DO_RETURN_NULL;
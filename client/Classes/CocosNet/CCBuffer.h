@@ -29,6 +29,7 @@ THE SOFTWARE.
 
 #include "cocos2d.h"
 #include "CCNetMacros.h"
+#include "CCBufferPool.h"
 #include <string>
 
 NS_CC_BEGIN
@@ -51,6 +52,11 @@ public:
 	static Buffer* create(const char* p_data, unsigned int u_len);
 	Ref* copy();
 
+public:
+	// the objects and their storage come from the BufferPool
+	static void* operator new(size_t u_size);
+	static void operator delete(void* p, size_t u_size);
+
 public:
 	unsigned int length() const;
 	unsigned int capacity() const;
@@ -58,6 +64,25 @@ public:
 	char* data() const;
 	void clear();
 
+public:
+	// point at bytes owned by someone else without copying, they must outlive the use.
+	// a view is read only, writing into it copies the bytes into own storage first
+	void setView(const char* p_data, unsigned int u_len);
+	bool isView() const;
+
+public:
+	// write in front of the content, O(1) while it fits the head room
+	void prependData(const char* p_data, unsigned int u_len);
+	void prependUInt(unsigned int data);
+	unsigned int getHeadRoom() const;
+
+public:
+	// chain a buffer behind this one without copying, it is retained.
+	// the read/write functions only see this segment, send takes the whole chain
+	void appendBuffer(Buffer* p_buffer);
+	Buffer* getNextBuffer() const;
+	unsigned int getChainLength() const;
+
 public:
 	unsigned int getWriterIndex() const;
 	unsigned int getContentSize() const;
@@ -119,6 +144,9 @@ public:
 protected:
 	inline void _reallocBufferSizeInChanged(unsigned int u_len);
 	inline void _reallocBufferSize();
+	inline void _detachView();
+	inline void _allocStorage(unsigned int u_size, unsigned int u_head_room = CCBUFFER_HEAD_ROOM);
+	inline void _freeStorage();
 
 protected:
 	char* _p_buffer;
@@ -127,6 +155,9 @@ protected:
 	unsigned int _u_mark_pos;
 	unsigned int _u_content_size;
 	unsigned int _u_buffer_size;
+	unsigned int _u_head_room;
+	bool _b_view;
+	Buffer* _p_next;
 	
 };
 
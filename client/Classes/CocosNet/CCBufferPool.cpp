@@ -0,0 +1,357 @@
+﻿/****************************************************************************
+Copyright (c) 2014 Lijunlin - Jason lee
+
+Created by Lijunlin - Jason lee on 2014
+
+jason.lee.c@foxmail.com
+http://www.cocos2d-x.org
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+****************************************************************************/
+#include "CCBufferPool.h"
+#include <stdlib.h>
+#include <string.h>
+#include <atomic>
+#include <mutex>
+#include <vector>
+#include <algorithm>
+
+NS_CC_BEGIN
+
+#define BUFFERPOOL_MIN_SHIFT 5   // the smallest block is 32 bytes
+#define BUFFERPOOL_CLASS_COUNT (32 - BUFFERPOOL_MIN_SHIFT)
+#define BUFFERPOOL_CACHE_MIN_BLOCKS 8
+#define BUFFERPOOL_DEPOT_CACHES 8   // the depot keeps as many blocks as this many full thread caches
+
+struct _FREEBLOCK
+{
+	_FREEBLOCK* pNext;
+};
+
+struct _FREELIST
+{
+	_FREEBLOCK* pHead;
+	unsigned int uCount;
+};
+
+// only the owner thread writes them, getStats reads them from any thread
+struct _POOLCOUNTERS
+{
+	std::atomic<unsigned long long> uHits;
+	std::atomic<unsigned long long> uMisses;
+	std::atomic<unsigned long long> uAllocated;
+	std::atomic<unsigned long long> uReleased;
+};
+
+struct _THREADCACHE
+{
+	_THREADCACHE();
+	~_THREADCACHE();
+
+	_FREELIST aLists[BUFFERPOOL_CLASS_COUNT];
+	_POOLCOUNTERS oCounters;
+};
+
+struct _POOLDEPOT
+{
+	_POOLDEPOT();
+
+	std::mutex oMutex;
+	_FREELIST aLists[BUFFERPOOL_CLASS_COUNT];
+	std::vector<_THREADCACHE*> vCaches;
+	// finished threads and calls made after the thread cache is gone
+	unsigned long long uHits;
+	unsigned long long uMisses;
+	unsigned long long uAllocated;
+	unsigned long long uReleased;
+};
+
+enum _CACHESTATE
+{
+	eCacheNone,
+	eCacheAlive,
+	eCacheGone
+};
+
+static thread_local int t_nCacheState = eCacheNone;
+static thread_local _THREADCACHE t_oCache;
+
+static _POOLDEPOT& sharedDepot()
+{
+	// never destroyed, buffers may still be released by static destructors
+	static _POOLDEPOT* s_pDepot = new _POOLDEPOT();
+	return *s_pDepot;
+}
+
+static int sizeClass(unsigned int uSize)
+{
+	if( CCBUFFER_POOL_MAX_BLOCK == 0 || uSize > CCBUFFER_POOL_MAX_BLOCK )
+		return -1;
+
+	int nClass = 0;
+	while( (1u << (nClass + BUFFERPOOL_MIN_SHIFT)) < uSize )
+	{
+		++nClass;
+	}
+	return nClass;
+}
+
+static unsigned int classSize(int nClass)
+{
+	return 1u << (nClass + BUFFERPOOL_MIN_SHIFT);
+}
+
+static unsigned int cacheLimit(int nClass)
+{
+	return MAX(CCBUFFER_POOL_CACHE_BYTES / classSize(nClass), BUFFERPOOL_CACHE_MIN_BLOCKS);
+}
+
+static void addCounter(std::atomic<unsigned long long>& uCounter, unsigned long long uValue)
+{
+	uCounter.store(uCounter.load(std::memory_order_relaxed) + uValue, std::memory_order_relaxed);
+}
+
+static _FREEBLOCK* popBlock(_FREELIST& tList)
+{
+	_FREEBLOCK* pBlock = tList.pHead;
+	if( pBlock )
+	{
+		tList.pHead = pBlock->pNext;
+		--tList.uCount;
+	}
+	return pBlock;
+}
+
+static void pushBlock(_FREELIST& tList, void* pBlock)
+{
+	_FREEBLOCK* pFree = (_FREEBLOCK*) pBlock;
+	pFree->pNext = tList.pHead;
+	tList.pHead = pFree;
+	++tList.uCount;
+}
+
+// moves up to uCount blocks from the front of tFrom to tTo
+static void moveBlocks(_FREELIST& tFrom, _FREELIST& tTo, unsigned int uCount)
+{
+	while( uCount-- > 0 && tFrom.pHead )
+	{
+		pushBlock(tTo, popBlock(tFrom));
+	}
+}
+
+static void freeBlocks(_FREELIST& tList, unsigned int uKeep)
+{
+	while( tList.uCount > uKeep )
+	{
+		free(popBlock(tList));
+	}
+}
+
+// the depot is locked
+static void capDepotList(_POOLDEPOT& oDepot, int nClass)
+{
+	freeBlocks(oDepot.aLists[nClass], cacheLimit(nClass) * BUFFERPOOL_DEPOT_CACHES);
+}
+
+_POOLDEPOT::_POOLDEPOT()
+: uHits(0)
+, uMisses(0)
+, uAllocated(0)
+, uReleased(0)
+{
+	memset(aLists, 0, sizeof(aLists));
+}
+
+_THREADCACHE::_THREADCACHE()
+{
+	memset(aLists, 0, sizeof(aLists));
+	oCounters.uHits = 0;
+	oCounters.uMisses = 0;
+	oCounters.uAllocated = 0;
+	oCounters.uReleased = 0;
+
+	_POOLDEPOT& oDepot = sharedDepot();
+	std::lock_guard<std::mutex> oLock(oDepot.oMutex);
+	oDepot.vCaches.push_back(this);
+	t_nCacheState = eCacheAlive;
+}
+
+_THREADCACHE::~_THREADCACHE()
+{
+	_POOLDEPOT& oDepot = sharedDepot();
+	std::lock_guard<std::mutex> oLock(oDepot.oMutex);
+	for( int i = 0; i < BUFFERPOOL_CLASS_COUNT; ++i )
+	{
+		moveBlocks(aLists[i], oDepot.aLists[i], aLists[i].uCount);
+		capDepotList(oDepot, i);
+	}
+	oDepot.uHits += oCounters.uHits.load(std::memory_order_relaxed);
+	oDepot.uMisses += oCounters.uMisses.load(std::memory_order_relaxed);
+	oDepot.uAllocated += oCounters.uAllocated.load(std::memory_order_relaxed);
+	oDepot.uReleased += oCounters.uReleased.load(std::memory_order_relaxed);
+	oDepot.vCaches.erase(std::find(oDepot.vCaches.begin(), oDepot.vCaches.end(), this));
+	t_nCacheState = eCacheGone;
+}
+
+static _THREADCACHE* threadCache()
+{
+	if( t_nCacheState == eCacheGone )
+		return NULL;
+
+	// constructed on the first use in each thread
+	return &t_oCache;
+}
+
+void* BufferPool::allocate(unsigned int uSize, unsigned int* pRealSize)
+{
+	const int nClass = sizeClass(uSize);
+	const unsigned int uRealSize = nClass < 0 ? uSize : classSize(nClass);
+	if( pRealSize )
+	{
+		*pRealSize = uRealSize;
+	}
+
+	void* pBlock = NULL;
+	_THREADCACHE* pCache = threadCache();
+	if( pCache )
+	{
+		if( nClass >= 0 )
+		{
+			_FREELIST& tList = pCache->aLists[nClass];
+			if( !tList.pHead )
+			{
+				// refill half of the cache in one lock
+				_POOLDEPOT& oDepot = sharedDepot();
+				std::lock_guard<std::mutex> oLock(oDepot.oMutex);
+				moveBlocks(oDepot.aLists[nClass], tList, cacheLimit(nClass) / 2);
+			}
+			pBlock = popBlock(tList);
+		}
+		addCounter(pBlock ? pCache->oCounters.uHits : pCache->oCounters.uMisses, 1);
+		addCounter(pCache->oCounters.uAllocated, uRealSize);
+	}
+	else
+	{
+		_POOLDEPOT& oDepot = sharedDepot();
+		std::lock_guard<std::mutex> oLock(oDepot.oMutex);
+		if( nClass >= 0 )
+		{
+			pBlock = popBlock(oDepot.aLists[nClass]);
+		}
+		if( pBlock )
+		{
+			++oDepot.uHits;
+		}
+		else
+		{
+			++oDepot.uMisses;
+		}
+		oDepot.uAllocated += uRealSize;
+	}
+
+	if( !pBlock )
+	{
+		pBlock = malloc(MAX(uRealSize, 1u));
+	}
+	return pBlock;
+}
+
+void BufferPool::deallocate(void* pBlock, unsigned int uSize)
+{
+	if( !pBlock )
+		return;
+
+	const int nClass = sizeClass(uSize);
+	const unsigned int uRealSize = nClass < 0 ? uSize : classSize(nClass);
+	_THREADCACHE* pCache = threadCache();
+	if( pCache )
+	{
+		addCounter(pCache->oCounters.uReleased, uRealSize);
+		if( nClass < 0 )
+		{
+			free(pBlock);
+			return;
+		}
+
+		_FREELIST& tList = pCache->aLists[nClass];
+		pushBlock(tList, pBlock);
+		if( tList.uCount > cacheLimit(nClass) )
+		{
+			// a thread that releases more than it allocates, e.g. the receiver of the network thread's packages
+			_POOLDEPOT& oDepot = sharedDepot();
+			std::lock_guard<std::mutex> oLock(oDepot.oMutex);
+			moveBlocks(tList, oDepot.aLists[nClass], tList.uCount / 2);
+			capDepotList(oDepot, nClass);
+		}
+	}
+	else
+	{
+		_POOLDEPOT& oDepot = sharedDepot();
+		std::lock_guard<std::mutex> oLock(oDepot.oMutex);
+		oDepot.uReleased += uRealSize;
+		if( nClass < 0 )
+		{
+			free(pBlock);
+			return;
+		}
+		pushBlock(oDepot.aLists[nClass], pBlock);
+		capDepotList(oDepot, nClass);
+	}
+}
+
+unsigned int BufferPool::roundSize(unsigned int uSize)
+{
+	const int nClass = sizeClass(uSize);
+	return nClass < 0 ? uSize : classSize(nClass);
+}
+
+BufferPoolStats BufferPool::getStats()
+{
+	_POOLDEPOT& oDepot = sharedDepot();
+	std::lock_guard<std::mutex> oLock(oDepot.oMutex);
+	unsigned long long uAllocated = oDepot.uAllocated;
+	unsigned long long uReleased = oDepot.uReleased;
+
+	BufferPoolStats tStats;
+	tStats.uHits = oDepot.uHits;
+	tStats.uMisses = oDepot.uMisses;
+	for( std::vector<_THREADCACHE*>::iterator it = oDepot.vCaches.begin(); it != oDepot.vCaches.end(); ++it )
+	{
+		const _POOLCOUNTERS& oCounters = (*it)->oCounters;
+		tStats.uHits += oCounters.uHits.load(std::memory_order_relaxed);
+		tStats.uMisses += oCounters.uMisses.load(std::memory_order_relaxed);
+		uAllocated += oCounters.uAllocated.load(std::memory_order_relaxed);
+		uReleased += oCounters.uReleased.load(std::memory_order_relaxed);
+	}
+	// the counters of different threads are not read at one instant
+	tStats.uBytesOutstanding = uAllocated > uReleased ? uAllocated - uReleased : 0;
+	return tStats;
+}
+
+void BufferPool::trim()
+{
+	_POOLDEPOT& oDepot = sharedDepot();
+	std::lock_guard<std::mutex> oLock(oDepot.oMutex);
+	for( int i = 0; i < BUFFERPOOL_CLASS_COUNT; ++i )
+	{
+		freeBlocks(oDepot.aLists[i], 0);
+	}
+}
+
+NS_CC_END
\ No newline at end of file
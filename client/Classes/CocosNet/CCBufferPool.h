@@ -0,0 +1,119 @@
+﻿/****************************************************************************
+Copyright (c) 2014 Lijunlin - Jason lee
+
+Created by Lijunlin - Jason lee on 2014
+
+jason.lee.c@foxmail.com
+http://www.cocos2d-x.org
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+****************************************************************************/
+#ifndef __CCNET_BUFFERPOOL_H__
+#define __CCNET_BUFFERPOOL_H__
+
+#include "cocos2d.h"
+#include "CCNetMacros.h"
+#include <stddef.h>
+
+NS_CC_BEGIN
+
+/**
+ * struct : BufferPoolStats
+ * descpt : counters of the buffer pool, summed over all threads
+ */
+struct BufferPoolStats
+{
+	unsigned long long uHits;               // blocks served from a cache
+	unsigned long long uMisses;             // blocks taken from the heap
+	unsigned long long uBytesOutstanding;   // bytes handed out and not given back yet
+};
+
+/**
+ * class  : BufferPool
+ * descpt : size class allocator for the buffer storage and the buffer objects.
+ *          blocks are powers of 2 up to CCBUFFER_POOL_MAX_BLOCK, bigger ones go to the heap.
+ *          every thread keeps its own free lists, so the network thread and the cocos thread
+ *          do not lock each other, a full list gives half of its blocks to a shared depot,
+ *          an empty one takes them back from there before it touches the heap.
+ */
+class BufferPool
+{
+public:
+	// the block holds at least uSize bytes, its real size is stored in pRealSize
+	static void* allocate(unsigned int uSize, unsigned int* pRealSize = NULL);
+
+	// uSize is the requested or the real size of the block
+	static void deallocate(void* pBlock, unsigned int uSize);
+
+	// the real size of a block that holds uSize bytes
+	static unsigned int roundSize(unsigned int uSize);
+
+	static BufferPoolStats getStats();
+
+	// give the blocks kept by the depot back to the heap
+	static void trim();
+};
+
+/**
+ * class  : PoolAllocator
+ * descpt : lets the standard containers of the network layer allocate from the buffer pool
+ */
+template<typename T>
+class PoolAllocator
+{
+public:
+	typedef T value_type;
+
+	PoolAllocator() {}
+
+	template<typename U>
+	PoolAllocator(const PoolAllocator<U>&) {}
+
+	T* allocate(size_t uCount)
+	{
+		return (T*) BufferPool::allocate((unsigned int)(uCount * sizeof(T)));
+	}
+
+	void deallocate(T* pBlock, size_t uCount)
+	{
+		BufferPool::deallocate(pBlock, (unsigned int)(uCount * sizeof(T)));
+	}
+
+	template<typename U>
+	struct rebind
+	{
+		typedef PoolAllocator<U> other;
+	};
+};
+
+template<typename T, typename U>
+inline bool operator==(const PoolAllocator<T>&, const PoolAllocator<U>&)
+{
+	return true;
+}
+
+template<typename T, typename U>
+inline bool operator!=(const PoolAllocator<T>&, const PoolAllocator<U>&)
+{
+	return false;
+}
+
+NS_CC_END
+
+#endif //__CCNET_BUFFERPOOL_H__
\ No newline at end of file
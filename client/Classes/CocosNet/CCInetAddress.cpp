@@ -34,7 +34,7 @@ NS_CC_BEGIN
 
 InetAddress::InetAddress()
 {
-#if( CC_TARGET_PLATFORM == CC_PLATFORM_IOS )
+#if( CC_TARGET_PLATFORM == CC_PLATFORM_IOS || CC_TARGET_PLATFORM == CC_PLATFORM_MAC )
 	sin_len = sizeof(struct sockaddr_in);
 	sin_family = AF_INET;
 	sin_addr.s_addr = INADDR_ANY;
@@ -49,7 +49,7 @@ InetAddress::InetAddress()
 	memset(sin_zero, 0, 8);
 #endif
 
-#if( CC_TARGET_PLATFORM == CC_PLATFORM_ANDROID )
+#if( CC_TARGET_PLATFORM == CC_PLATFORM_ANDROID || CC_TARGET_PLATFORM == CC_PLATFORM_LINUX )
 	sin_family = AF_INET;
 	sin_addr.s_addr = INADDR_ANY;
 	sin_port = 0;
@@ -81,11 +81,11 @@ InetAddress::operator struct sockaddr*()
 	return (struct sockaddr *)(&this->sin_family);
 #endif
 
-#if( CC_TARGET_PLATFORM == CC_PLATFORM_ANDROID )
+#if( CC_TARGET_PLATFORM == CC_PLATFORM_ANDROID || CC_TARGET_PLATFORM == CC_PLATFORM_LINUX )
 	return (struct sockaddr *)(&this->sin_family);
 #endif
 
-#if( CC_TARGET_PLATFORM == CC_PLATFORM_IOS )
+#if( CC_TARGET_PLATFORM == CC_PLATFORM_IOS || CC_TARGET_PLATFORM == CC_PLATFORM_MAC )
 	return (struct sockaddr *)(&this->sin_len);
 #endif
 }
@@ -96,11 +96,11 @@ InetAddress::operator const struct sockaddr*() const
 	return (const struct sockaddr *)(&this->sin_family);
 #endif
 
-#if( CC_TARGET_PLATFORM == CC_PLATFORM_ANDROID )
+#if( CC_TARGET_PLATFORM == CC_PLATFORM_ANDROID || CC_TARGET_PLATFORM == CC_PLATFORM_LINUX )
 	return (const struct sockaddr *)(&this->sin_family);
 #endif
 
-#if( CC_TARGET_PLATFORM == CC_PLATFORM_IOS )
+#if( CC_TARGET_PLATFORM == CC_PLATFORM_IOS || CC_TARGET_PLATFORM == CC_PLATFORM_MAC )
 	return (const struct sockaddr *)(&this->sin_len);
 #endif
 }
@@ -112,11 +112,11 @@ const char* InetAddress::getHostAddress() const
 	sprintf_s(addr, 64, "%s:%u", inet_ntoa(sin_addr), getPort());
 #endif
 
-#if( CC_TARGET_PLATFORM == CC_PLATFORM_ANDROID )
+#if( CC_TARGET_PLATFORM == CC_PLATFORM_ANDROID || CC_TARGET_PLATFORM == CC_PLATFORM_LINUX )
 	snprintf(addr, 64, "%s:%u", inet_ntoa(sin_addr), getPort());
 #endif
 
-#if( CC_TARGET_PLATFORM == CC_PLATFORM_IOS )
+#if( CC_TARGET_PLATFORM == CC_PLATFORM_IOS || CC_TARGET_PLATFORM == CC_PLATFORM_MAC )
 	snprintf(addr, 64, "%s:%u", inet_ntoa(sin_addr), getPort());
 #endif
 	return addr;
@@ -25,27 +25,45 @@ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
 THE SOFTWARE.
 ****************************************************************************/
 #include "CCNetDelegate.h"
+#include <algorithm>
 
 NS_CC_BEGIN
 
+#define NETDELEGATE_SCHEDULE_KEY "NetDelegate"
+
 NetDelegate::NetDelegate()
 : m_fSoTimeout(SOCKET_SOTIMEOUT)
 , m_eStatus(eSocketIoClosed)
-, m_fConnectingDuration(0.0f)
-, m_bRunSchedule(false)
+, m_eIoStatus(eSocketIoClosed)
+, m_bRunReactor(false)
+, m_bThreaded(false)
+, m_bRunDispatch(false)
+, m_pReactor(NULL)
+, m_bStopThread(false)
+, m_qEvents(SOCKET_QUEUE_SIZE)
+, m_qSendBuffers(SOCKET_QUEUE_SIZE)
+, m_qSentBuffers(SOCKET_QUEUE_SIZE)
+, m_pReadRing(NULL)
+, m_uReadRingSize(0)
+, m_uReadHead(0)
+, m_uReadTail(0)
 {
-	
+	growReadRing(SOCKET_READ_BUFFER_SIZE);
 }
 
 NetDelegate::~NetDelegate()
 {
+	stopThread();
+	unregisterReactor();
 	m_oSocket.ccClose();
 
-	while(!m_lSendBuffers.empty())
+	while(!m_dSendBuffers.empty())
 	{
-		CC_SAFE_DELETE_ARRAY(m_lSendBuffers.front().pBuffer);
-		m_lSendBuffers.pop_front();
+		CC_SAFE_RELEASE(m_dSendBuffers.front().pBuffer);
+		m_dSendBuffers.pop_front();
 	}
+
+	CC_SAFE_FREE(m_pReadRing);
 }
 
 void NetDelegate::setInetAddress(const InetAddress& oInetAddress)
@@ -68,51 +86,49 @@ float NetDelegate::getSoTimeout() const
 	return m_fSoTimeout;
 }
 
+void NetDelegate::setThreaded(bool bThreaded)
+{
+	if( m_eStatus == eSocketConnected || m_eStatus == eSocketConnecting )
+	{
+		CCLOGERROR("set threaded before connect");
+		return;
+	}
+	m_bThreaded = bThreaded;
+}
+
+bool NetDelegate::isThreaded() const
+{
+	return m_bThreaded;
+}
+
 void NetDelegate::send(char* pBuffer, unsigned int uLen)
 {
 	if( !pBuffer || uLen == 0 || !isConnected() )
 		return;
 	
-#if USING_PACKAGE_HEAD_LENGTH
+	// the copy gets head room, so the head is not a second copy
 	Buffer* pBuf = new Buffer(pBuffer, uLen);
 	pBuf->autorelease();
 	send(pBuf);
-#else
-	char* pTemp = new char[uLen];
-	memcpy(pTemp, pBuffer, uLen);
-
-	_SENDBUFFER tBuf;
-	tBuf.pBuffer = pTemp;
-	tBuf.nLength = (int)uLen;
-	tBuf.nOffset = 0;
-
-	m_lSendBuffers.push_back(tBuf);
-#endif
 }
 
 void NetDelegate::send(Buffer* pBuffer)
 {
-	if( pBuffer->empty() || !isConnected() )
+	if( pBuffer->getChainLength() == 0 || !isConnected() )
 		return;
 
 #if USING_PACKAGE_HEAD_LENGTH
-	unsigned int u_len = pBuffer->length();
-	pBuffer->moveRight(sizeof(unsigned int));
-	pBuffer->moveWriterIndexToFront();
-	pBuffer->writeUInt(u_len);
+	pBuffer->prependUInt(pBuffer->getChainLength());
 #endif
-
-	pBuffer->moveReaderIndexToFront();
-	char* pData = pBuffer->readWholeData();
-	int nLength = (int)pBuffer->length();
 	pBuffer->moveReaderIndexToFront();
 
+	pBuffer->retain();
 	_SENDBUFFER tBuf;
-	tBuf.pBuffer = pData;
-	tBuf.nLength = nLength;
+	tBuf.pBuffer = pBuffer;
+	tBuf.pSegment = pBuffer;
 	tBuf.nOffset = 0;
 
-	m_lSendBuffers.push_back(tBuf);
+	postSendBuffer(tBuf);
 }
 
 bool NetDelegate::isConnected()
@@ -124,17 +140,34 @@ bool NetDelegate::connect()
 {
 	if( m_eStatus != eSocketConnected && m_eStatus != eSocketConnecting )
 	{
+		// a thread that ended by itself is still joinable
+		stopThread();
+
 		m_oSocket.setInetAddress(m_oInetAddress);
+		m_uReadHead = 0;
+		m_uReadTail = 0;
 		if( m_oSocket.ccConnect() )
 		{
-			registerScheduler();
+			// the connect completes, or fails, when the socket turns writable
 			m_eStatus = eSocketConnecting;
+			m_eIoStatus = eSocketConnecting;
+			if( m_bThreaded )
+			{
+				startThread();
+			}
+			else
+			{
+				m_pReactor = NetReactor::sharedReactor();
+				registerReactor(eReactorWrite);
+				m_pReactor->setDeadline(m_oSocket.getSocket(), m_fSoTimeout);
+			}
 			return true;
 		}
 		else
 		{
 			m_oSocket.ccClose();
 			m_eStatus = eSocketConnectFailed;
+			m_eIoStatus = eSocketConnectFailed;
 			onExceptionCaught(eSocketConnectFailed);
 		}
 	}
@@ -145,9 +178,11 @@ void NetDelegate::disconnect()
 {
 	if( m_eStatus == eSocketConnected )
 	{
-		unregisterScheduler();
+		stopThread();
+		unregisterReactor();
 		m_oSocket.ccDisconnect();
 		m_eStatus = eSocketDisconnected;
+		m_eIoStatus = eSocketDisconnected;
 		onDisconnected();
 	}
 }
@@ -156,189 +191,629 @@ void NetDelegate::close()
 {
 	if( m_eStatus == eSocketConnected )
 	{
-		unregisterScheduler();
+		stopThread();
+		unregisterReactor();
 		m_oSocket.ccClose();
 		m_eStatus = eSocketIoClosed;
+		m_eIoStatus = eSocketIoClosed;
 		onDisconnected();
 	}
 }
 
-void NetDelegate::runSchedule(float dt)
+void NetDelegate::onReadable()
+{
+#if HANDLE_ON_SINGLE_FRAME
+	while( m_eIoStatus == eSocketConnected && runRead() == eSocketReceive );
+#else
+	if( m_eIoStatus == eSocketConnected )
+	{
+		runRead();
+	}
+#endif
+}
+
+void NetDelegate::onWritable()
 {
-	switch( m_eStatus )
+	if( m_eIoStatus == eSocketConnecting )
 	{
-	case eSocketConnecting:
+		if( m_oSocket.ccCheckConnect() == eSocketConnected )
 		{
-			switch( m_oSocket.ccIsConnected() )
-			{
-			case eSocketConnected:
-				{
-					m_eStatus = eSocketConnected;
-					onConnected();
-				}
-				break;
-			case eSocketConnectFailed:
-				{
-					unregisterScheduler();
-                    m_oSocket.ccClose();
-					m_eStatus = eSocketConnectFailed;
-					onExceptionCaught(eSocketConnectFailed);
-				}
-				break;
-			case eSocketConnecting:
-				{
-					if( m_fConnectingDuration > m_fSoTimeout )
-					{
-						unregisterScheduler();
-						m_oSocket.ccDisconnect();
-						m_eStatus = eSocketDisconnected;
-						onConnectTimeout();
-						m_fConnectingDuration = 0.0f;
-					}
-					else
-					{
-						m_fConnectingDuration += dt;
-					}
-				}
-				break;
-			default:
-				break;
-			}
+			m_eIoStatus = eSocketConnected;
+			m_pReactor->setDeadline(m_oSocket.getSocket(), 0.0f);
+			updateReactorEvents();
+			postStatus(eSocketConnected);
 		}
-		break;
-	case eSocketConnected:
+		else
 		{
-#if HANDLE_ON_SINGLE_FRAME
-			while( m_oSocket.ccIsReadable() )
-#else
-			if( m_oSocket.ccIsReadable() )
-#endif
-			{
-				if( this->runRead() ) return;
-			}
+			unregisterReactor();
+			m_oSocket.ccClose();
+			m_eIoStatus = eSocketConnectFailed;
+			postStatus(eSocketConnectFailed);
+		}
+		return;
+	}
 
 #if HANDLE_ON_SINGLE_FRAME
-			while( m_oSocket.ccIsWritable() && !m_lSendBuffers.empty() )
+	while( m_eIoStatus == eSocketConnected && !m_dSendBuffers.empty() && runWrite() == eSocketReceive );
 #else
-			if( m_oSocket.ccIsWritable() && !m_lSendBuffers.empty() )
+	if( m_eIoStatus == eSocketConnected && !m_dSendBuffers.empty() )
+	{
+		runWrite();
+	}
 #endif
-			{
-				if( this->runWrite() ) return;
-			}
-		}
-		break;
-	default:
-		break;
-	}	
+	updateReactorEvents();
 }
 
-bool NetDelegate::runRead()
+void NetDelegate::onError()
 {
-	int nRet = m_oSocket.ccRead(m_pReadBuffer, SOCKET_READ_BUFFER_SIZE);
-	if( nRet == eSocketIoError || nRet == eSocketIoClosed )
+	if( m_eIoStatus == eSocketConnecting )
 	{
-		unregisterScheduler();
-		m_oSocket.ccClose();
-		m_eStatus = eSocketIoClosed;
-		onDisconnected();
-		return true;
+		onWritable();
+	}
+	else if( m_eIoStatus == eSocketConnected )
+	{
+		onSocketClosed();
+	}
+}
+
+void NetDelegate::onTimeout()
+{
+	if( m_eIoStatus == eSocketConnecting )
+	{
+		unregisterReactor();
+		m_oSocket.ccDisconnect();
+		m_eIoStatus = eSocketDisconnected;
+		postStatus(eSocketConnectTimeout);
+	}
+}
+
+void NetDelegate::onSocketClosed()
+{
+	unregisterReactor();
+	m_oSocket.ccClose();
+	m_eIoStatus = eSocketIoClosed;
+	postStatus(eSocketIoClosed);
+}
+
+int NetDelegate::runRead()
+{
+	// receive straight into the free space after the tail, up to the end of the ring
+	unsigned int uUsed = m_uReadTail - m_uReadHead;
+	if( uUsed == 0 )
+	{
+		m_uReadHead = 0;
+		m_uReadTail = 0;
+	}
+	else if( uUsed == m_uReadRingSize && !growReadRing(m_uReadRingSize * 2) )
+	{
+		CCLOGERROR("grow the receive ring failed");
+		onSocketClosed();
+		return eSocketIoClosed;
+	}
+	const unsigned int uTail = m_uReadTail & (m_uReadRingSize - 1);
+	const unsigned int uFree = MIN(m_uReadRingSize - uUsed, m_uReadRingSize - uTail);
+
+	int nRet = m_oSocket.ccRead(m_pReadRing + uTail, (int)uFree);
+	if( nRet == eSocketWouldBlock )
+	{
+		return eSocketWouldBlock;
+	}
+	else if( nRet == eSocketIoError || nRet == eSocketIoClosed )
+	{
+		onSocketClosed();
+		return eSocketIoClosed;
 	}
 	else
 	{
 #if 1
 		CCLOG("CCSOCKET READ %d", nRet);
 #endif
-		m_oReadBuffer.writeData(m_pReadBuffer, (unsigned int)nRet);
-#if USING_PACKAGE_HEAD_LENGTH
-		while( m_oReadBuffer.isReadable(sizeof(int)) )
+		m_uReadTail += (unsigned int)nRet;
+		runFraming();
+		if( m_eIoStatus != eSocketConnected )
 		{
-			m_oReadBuffer.moveReaderIndexToFront();
-			int n_head_len = m_oReadBuffer.readInt();
-			if( n_head_len <= 0 )
-			{
-				CCLOGERROR("invalidate head length");
-				m_oReadBuffer.moveLeft(sizeof(int));
-			}
+			return eSocketIoClosed;
+		}
+	}
 
-			int n_content_len = (int)m_oReadBuffer.length();
-			if( n_content_len - (int)(sizeof(int)) >= n_head_len )
-			{
-				m_oReadBuffer.moveLeft(sizeof(unsigned int));
-				Buffer* pData = m_oReadBuffer.readData(n_head_len);
-				m_oReadBuffer.moveLeft(n_head_len);
-				m_oReadBuffer.moveReaderIndexToFront();
-				m_oReadBuffer.moveWriterIndexToBack();
+	// a short read drained the socket, save the call that would only block
+	return (unsigned int)nRet < uFree ? eSocketWouldBlock : eSocketReceive;
+}
 
-				onMessageReceived(*pData);
-			}
-			else
+void NetDelegate::runFraming()
+{
+#if USING_PACKAGE_HEAD_LENGTH
+	while( m_eIoStatus == eSocketConnected && m_uReadTail - m_uReadHead >= sizeof(int) )
+	{
+		// the head is written by Buffer::writeUInt, decode it the same way
+		char p_head[sizeof(int)];
+		peekReadRing(m_uReadHead, p_head, sizeof(int));
+#if MEMORYTYPE_REVERSE
+		std::reverse(p_head, p_head + sizeof(int));
+#endif
+		int n_head_len = 0;
+		memcpy(&n_head_len, p_head, sizeof(int));
+		if( n_head_len <= 0 || n_head_len > SOCKET_MAX_PACKAGE_SIZE )
+		{
+			// the stream cannot be framed any more
+			CCLOGERROR("invalidate head length %d", n_head_len);
+			onSocketClosed();
+			return;
+		}
+
+		const unsigned int u_frame_len = sizeof(int) + (unsigned int)n_head_len;
+		if( m_uReadTail - m_uReadHead < u_frame_len )
+		{
+			if( u_frame_len > m_uReadRingSize && !growReadRing(u_frame_len) )
 			{
-				break;
+				CCLOGERROR("grow the receive ring failed");
+				onSocketClosed();
 			}
+			break;
+		}
+
+		// consume first, the callback may close or reconnect
+		const unsigned int u_offset = (m_uReadHead + sizeof(int)) & (m_uReadRingSize - 1);
+		m_uReadHead += u_frame_len;
+		bool bPosted = false;
+		if( u_offset + (unsigned int)n_head_len <= m_uReadRingSize )
+		{
+			bPosted = postMessage(m_pReadRing + u_offset, (unsigned int)n_head_len);
+		}
+		else
+		{
+			// only a package crossing the end of the ring is joined
+			const unsigned int u_first = m_uReadRingSize - u_offset;
+			m_oWrapBuffer.reset();
+			m_oWrapBuffer.writeData(m_pReadRing + u_offset, u_first);
+			m_oWrapBuffer.writeData(m_pReadRing, (unsigned int)n_head_len - u_first);
+			bPosted = postMessage(m_oWrapBuffer.data(), (unsigned int)n_head_len);
+		}
+		if( !bPosted )
+		{
+			// a lost package breaks the protocol as well
+			CCLOGERROR("copy the received package failed");
+			onSocketClosed();
 		}
+	}
 #else
-		Buffer* pData = (Buffer*) m_oReadBuffer.copy();
-		pData->autorelease();
-		m_oReadBuffer.clear();
-		
-		onMessageReceived(*pData);
+	// without heads every chunk is a package, the chunk never crosses the ring end
+	const unsigned int u_offset = m_uReadHead & (m_uReadRingSize - 1);
+	const unsigned int u_len = m_uReadTail - m_uReadHead;
+	m_uReadHead = m_uReadTail;
+	if( !postMessage(m_pReadRing + u_offset, u_len) )
+	{
+		CCLOGERROR("copy the received package failed");
+		onSocketClosed();
+	}
 #endif
+}
+
+bool NetDelegate::growReadRing(unsigned int uSize)
+{
+	// the doubling below must not wrap
+	if( uSize > 0x80000000u )
+		return false;
+
+	unsigned int uRingSize = m_uReadRingSize > 0 ? m_uReadRingSize : 1;
+	while( uRingSize < uSize )
+	{
+		uRingSize <<= 1;
 	}
-	return false;
+	if( uRingSize == m_uReadRingSize )
+		return true;
+
+	// unwrap the content to the front of the new ring
+	const unsigned int uUsed = m_uReadTail - m_uReadHead;
+	char* pRing = (char*) malloc(uRingSize);
+	if( !pRing )
+		return false;
+
+	if( m_pReadRing )
+	{
+		peekReadRing(m_uReadHead, pRing, uUsed);
+		free(m_pReadRing);
+	}
+	m_pReadRing = pRing;
+	m_uReadRingSize = uRingSize;
+	m_uReadHead = 0;
+	m_uReadTail = uUsed;
+	return true;
+}
+
+void NetDelegate::peekReadRing(unsigned int uOffset, char* pOut, unsigned int uLen) const
+{
+	const unsigned int uStart = uOffset & (m_uReadRingSize - 1);
+	const unsigned int uFirst = MIN(uLen, m_uReadRingSize - uStart);
+	memcpy(pOut, m_pReadRing + uStart, uFirst);
+	memcpy(pOut + uFirst, m_pReadRing, uLen - uFirst);
 }
 
-bool NetDelegate::runWrite()
+int NetDelegate::runWrite()
 {
-	_SENDBUFFER& tBuffer = m_lSendBuffers.front();
+	// gather the segments of every pending package, a turn of several packages is one call
+	SocketIoVec pVecs[SOCKET_WRITE_IOV_MAX];
+	int nCount = 0;
+	unsigned int uTotal = 0;
+	for( _SENDQUEUE::iterator it = m_dSendBuffers.begin(); it != m_dSendBuffers.end() && nCount < SOCKET_WRITE_IOV_MAX; ++it )
+	{
+		unsigned int uOffset = (unsigned int)it->nOffset;
+		for( Buffer* pSegment = it->pSegment; pSegment && nCount < SOCKET_WRITE_IOV_MAX; pSegment = pSegment->getNextBuffer() )
+		{
+			if( pSegment->length() > uOffset )
+			{
+				pVecs[nCount].pData = pSegment->data() + uOffset;
+				pVecs[nCount].uLength = pSegment->length() - uOffset;
+				uTotal += pVecs[nCount].uLength;
+				++nCount;
+			}
+			uOffset = 0;
+		}
+	}
+	if( nCount == 0 )
+	{
+		// only empty packages are left
+		consumeSendBuffers(0);
+		return eSocketReceive;
+	}
 
-	int nRet = m_oSocket.ccWrite(tBuffer.pBuffer + tBuffer.nOffset, tBuffer.nLength - tBuffer.nOffset);
+	int nRet = nCount == 1 
+		? m_oSocket.ccWrite((char*)pVecs[0].pData, (int)pVecs[0].uLength)
+		: m_oSocket.ccWritev(pVecs, nCount);
 #if 1
 	CCLOG("CCSOCKET WRITE %d", nRet);
 #endif
-	if( nRet == eSocketIoError )
+	if( nRet == eSocketWouldBlock )
 	{
-		unregisterScheduler();
-		m_oSocket.ccClose();
-		m_eStatus = eSocketIoClosed;
-		onDisconnected();
-		return true;
+		return eSocketWouldBlock;
 	}
-	else if( nRet == tBuffer.nLength - tBuffer.nOffset )
+	else if( nRet == eSocketIoError )
 	{
-		CC_SAFE_DELETE_ARRAY(tBuffer.pBuffer);
-		m_lSendBuffers.pop_front();
+		onSocketClosed();
+		return eSocketIoClosed;
 	}
-	else
+
+	consumeSendBuffers((unsigned int)nRet);
+
+	// a short write means the send buffer of the socket is full
+	return (unsigned int)nRet < uTotal ? eSocketWouldBlock : eSocketReceive;
+}
+
+void NetDelegate::consumeSendBuffers(unsigned int uSent)
+{
+	while( !m_dSendBuffers.empty() )
 	{
-		tBuffer.nOffset += nRet;
+		_SENDBUFFER& tBuffer = m_dSendBuffers.front();
+		while( tBuffer.pSegment )
+		{
+			const unsigned int uLeft = tBuffer.pSegment->length() - (unsigned int)tBuffer.nOffset;
+			if( uSent < uLeft )
+			{
+				tBuffer.nOffset += (int)uSent;
+				return;
+			}
+			uSent -= uLeft;
+			tBuffer.pSegment = tBuffer.pSegment->getNextBuffer();
+			tBuffer.nOffset = 0;
+		}
+		postSentBuffer(tBuffer.pBuffer);
+		m_dSendBuffers.pop_front();
 	}
-	return false;
 }
 
-void NetDelegate::registerScheduler()
+void NetDelegate::registerReactor(int nEvents)
+{
+	if( m_bRunReactor )
+		return;
+
+	m_bRunReactor = m_pReactor->addSocket(m_oSocket.getSocket(), this, nEvents);
+}
+
+void NetDelegate::unregisterReactor()
 {
-	if( m_bRunSchedule )
+	if( !m_bRunReactor )
 		return;
 
-	Director::getInstance()->getScheduler()->schedule(
-		schedule_selector(NetDelegate::runSchedule), 
-		this, 
-		0.0f, 
-		false
-	);
-	m_bRunSchedule = true;
+	m_pReactor->removeSocket(m_oSocket.getSocket());
+	m_bRunReactor = false;
 }
 
-void NetDelegate::unregisterScheduler()
+void NetDelegate::updateReactorEvents()
 {
-	if( !m_bRunSchedule )
+	if( !m_bRunReactor )
 		return;
 
-	Director::getInstance()->getScheduler()->unschedule(
-		schedule_selector(NetDelegate::runSchedule),
-		this
-	);
-	m_bRunSchedule = false;
+	int nEvents = eReactorNone;
+	if( m_eIoStatus == eSocketConnected )
+	{
+		nEvents |= eReactorRead;
+	}
+	if( m_eIoStatus == eSocketConnecting || !m_dSendBuffers.empty() )
+	{
+		nEvents |= eReactorWrite;
+	}
+	m_pReactor->modifySocket(m_oSocket.getSocket(), nEvents);
+}
+
+void NetDelegate::postSendBuffer(const _SENDBUFFER& tBuffer)
+{
+	if( !m_bThreaded )
+	{
+		m_dSendBuffers.push_back(tBuffer);
+		updateReactorEvents();
+		return;
+	}
+
+	// keep the order behind the packages still waiting for room
+	if( !m_dSendBacklog.empty() || !m_qSendBuffers.push(tBuffer) )
+	{
+		m_dSendBacklog.push_back(tBuffer);
+		flushSendBacklog();
+	}
+	m_pReactor->wakeup();
+}
+
+void NetDelegate::postSentBuffer(Buffer* pBuffer)
+{
+	// the reference count is not atomic, only the cocos thread may release
+	if( !m_bThreaded )
+	{
+		pBuffer->release();
+		return;
+	}
+
+	if( !flushEventBacklog() || !m_qSentBuffers.push(pBuffer) )
+	{
+		m_lSentBacklog.push_back(pBuffer);
+	}
+}
+
+bool NetDelegate::postMessage(const char* pData, unsigned int uLen)
+{
+	if( !m_bThreaded )
+	{
+		m_oMessageView.setView(pData, uLen);
+		onMessageReceived(m_oMessageView);
+		return true;
+	}
+
+	// the ring is reused at once, so the package is copied into a raw pooled block.
+	// no Buffer is made here: constructing a Ref is not thread safe (the object
+	// counter of script binding), the cocos thread shows the block through a view
+	_NETEVENT tEvent;
+	tEvent.eStatus = eSocketReceive;
+	tEvent.pData = (char*) BufferPool::allocate(uLen);
+	tEvent.uLength = uLen;
+	if( !tEvent.pData )
+		return false;
+
+	memcpy(tEvent.pData, pData, uLen);
+	if( !flushEventBacklog() || !m_qEvents.push(tEvent) )
+	{
+		m_lEventBacklog.push_back(tEvent);
+	}
+	return true;
+}
+
+void NetDelegate::postStatus(SocketStatus eStatus)
+{
+	if( !m_bThreaded )
+	{
+		applyStatus(eStatus);
+		return;
+	}
+
+	_NETEVENT tEvent;
+	tEvent.eStatus = eStatus;
+	tEvent.pData = NULL;
+	tEvent.uLength = 0;
+	if( !flushEventBacklog() || !m_qEvents.push(tEvent) )
+	{
+		m_lEventBacklog.push_back(tEvent);
+	}
+}
+
+void NetDelegate::applyStatus(SocketStatus eStatus)
+{
+	if( eStatus != eSocketConnected )
+	{
+		// the network thread has ended, this was its last event
+		stopThread();
+	}
+
+	switch( eStatus )
+	{
+	case eSocketConnected:
+		{
+			m_eStatus = eSocketConnected;
+			onConnected();
+		}
+		break;
+	case eSocketConnectFailed:
+		{
+			m_eStatus = eSocketConnectFailed;
+			onExceptionCaught(eSocketConnectFailed);
+		}
+		break;
+	case eSocketConnectTimeout:
+		{
+			m_eStatus = eSocketDisconnected;
+			onConnectTimeout();
+		}
+		break;
+	case eSocketIoClosed:
+		{
+			m_eStatus = eSocketIoClosed;
+			onDisconnected();
+		}
+		break;
+	default:
+		break;
+	}
+}
+
+void NetDelegate::startThread()
+{
+	m_pReactor = new NetReactor();
+	m_pReactor->enableWakeup();
+	m_bStopThread = false;
+	m_oThread = std::thread(&NetDelegate::runThread, this);
+
+	if( !m_bRunDispatch )
+	{
+		Director::getInstance()->getScheduler()->schedule(
+			CC_CALLBACK_1(NetDelegate::runDispatch, this), 
+			this, 
+			0.0f, 
+			false, 
+			NETDELEGATE_SCHEDULE_KEY
+		);
+		m_bRunDispatch = true;
+	}
+}
+
+void NetDelegate::stopThread()
+{
+	if( m_bRunDispatch )
+	{
+		Director::getInstance()->getScheduler()->unschedule(NETDELEGATE_SCHEDULE_KEY, this);
+		m_bRunDispatch = false;
+	}
+
+	if( !m_oThread.joinable() )
+		return;
+
+	m_bStopThread = true;
+	m_pReactor->wakeup();
+	m_oThread.join();
+	m_bStopThread = false;
+
+	CC_SAFE_DELETE(m_pReactor);
+
+	// nobody will deliver these any more
+	_NETEVENT tEvent;
+	while( m_qEvents.pop(tEvent) )
+	{
+		BufferPool::deallocate(tEvent.pData, tEvent.uLength);
+	}
+	while( !m_lEventBacklog.empty() )
+	{
+		BufferPool::deallocate(m_lEventBacklog.front().pData, m_lEventBacklog.front().uLength);
+		m_lEventBacklog.pop_front();
+	}
+	Buffer* pSent = NULL;
+	while( m_qSentBuffers.pop(pSent) )
+	{
+		pSent->release();
+	}
+	while( !m_lSentBacklog.empty() )
+	{
+		m_lSentBacklog.front()->release();
+		m_lSentBacklog.pop_front();
+	}
+
+	// unsent packages stay queued for the next connection, as without the thread
+	_SENDBUFFER tBuffer;
+	while( m_qSendBuffers.pop(tBuffer) )
+	{
+		m_dSendBuffers.push_back(tBuffer);
+	}
+	m_dSendBuffers.insert(m_dSendBuffers.end(), m_dSendBacklog.begin(), m_dSendBacklog.end());
+	m_dSendBacklog.clear();
+}
+
+void NetDelegate::runThread()
+{
+	const bool bWakeup = m_pReactor->enableWakeup();
+	registerReactor(eReactorWrite);
+	m_pReactor->setDeadline(m_oSocket.getSocket(), m_fSoTimeout);
+
+	while( !m_bStopThread && (m_eIoStatus == eSocketConnecting || m_eIoStatus == eSocketConnected) )
+	{
+		_SENDBUFFER tBuffer;
+		bool bSend = false;
+		while( m_qSendBuffers.pop(tBuffer) )
+		{
+			m_dSendBuffers.push_back(tBuffer);
+			bSend = true;
+		}
+		if( bSend )
+		{
+			updateReactorEvents();
+		}
+
+		// without a wakeup, or while the cocos thread lags behind, look again soon
+		const bool bBlock = bWakeup && flushEventBacklog();
+		m_pReactor->poll(bBlock ? -1 : SOCKET_THREAD_POLL_INTERVAL);
+	}
+
+	// the cocos thread closes the socket after join when it asked to stop
+	unregisterReactor();
+
+	// the final status must reach the cocos thread
+	while( !m_bStopThread && !flushEventBacklog() )
+	{
+		std::this_thread::yield();
+	}
+}
+
+bool NetDelegate::flushEventBacklog()
+{
+	while( !m_lEventBacklog.empty() )
+	{
+		if( !m_qEvents.push(m_lEventBacklog.front()) )
+			return false;
+		m_lEventBacklog.pop_front();
+	}
+	while( !m_lSentBacklog.empty() )
+	{
+		if( !m_qSentBuffers.push(m_lSentBacklog.front()) )
+			return false;
+		m_lSentBacklog.pop_front();
+	}
+	return true;
+}
+
+void NetDelegate::flushSendBacklog()
+{
+	while( !m_dSendBacklog.empty() )
+	{
+		if( !m_qSendBuffers.push(m_dSendBacklog.front()) )
+			return;
+		m_dSendBacklog.pop_front();
+	}
+}
+
+void NetDelegate::runDispatch(float dt)
+{
+	if( !m_dSendBacklog.empty() )
+	{
+		flushSendBacklog();
+		m_pReactor->wakeup();
+	}
+
+	Buffer* pSent = NULL;
+	while( m_qSentBuffers.pop(pSent) )
+	{
+		pSent->release();
+	}
+
+	_NETEVENT tEvent;
+	while( m_bRunDispatch && m_qEvents.pop(tEvent) )
+	{
+		if( tEvent.eStatus == eSocketReceive )
+		{
+			// same contract as without the thread, a view valid until returning
+			m_oMessageView.setView(tEvent.pData, tEvent.uLength);
+			onMessageReceived(m_oMessageView);
+			m_oMessageView.setView(NULL, 0);
+			BufferPool::deallocate(tEvent.pData, tEvent.uLength);
+		}
+		else
+		{
+			applyStatus(tEvent.eStatus);
+		}
+	}
 }
 
 
@@ -30,6 +30,12 @@ THE SOFTWARE.
 #include "cocos2d.h"
 #include "CCNetMacros.h"
 #include "CCSocket.h"
+#include "CCNetReactor.h"
+#include "CCNetQueue.h"
+#include "CCBufferPool.h"
+#include <thread>
+#include <atomic>
+#include <deque>
 
 NS_CC_BEGIN
 
@@ -39,14 +45,15 @@ NS_CC_BEGIN
  * email  : jason.lee.c@foxmail.com
  * descpt : the net delegate, use it as connector
  */
-class NetDelegate : public Ref
+class NetDelegate : public Ref, public ReactorHandler
 {
 public:
 	NetDelegate();
 	virtual ~NetDelegate();
 
 public:
-	// will calling when a package is coming
+	// will calling when a package is coming. the buffer is a read only view of the
+	// receive ring, valid until returning, copy() it to keep the data
 	virtual void onMessageReceived(Buffer& oBuffer) = 0;
 
 	// when connected will calling
@@ -74,10 +81,18 @@ public:
 	// get the time out value
 	float getSoTimeout() const;
 
+	// read, write and frame on a network thread, set it before connect.
+	// the callbacks still come on the cocos thread, once per frame
+	void setThreaded(bool bThreaded);
+
+	// is using a network thread
+	bool isThreaded() const;
+
 	// send package to target address
 	void send(char* pBuffer, unsigned int uLen);
 
-	// send package to target address
+	// send package to target address, the buffer and its chain are retained until sent
+	// without copying, so leave them unchanged after this call
 	void send(Buffer* pBuffer);
 
 	// check the net status
@@ -92,22 +107,6 @@ public:
 	// disconnect as close for now
 	void disconnect();
 
-private:
-	// read data on every frame, if needed
-	bool runRead();
-
-	// send data on every frame, if needed
-	bool runWrite();
-
-	// frame call
-	void runSchedule(float dt);
-	
-	// registe the function of frame called
-	void registerScheduler();
-
-	// unregiste the function of frame called
-	void unregisterScheduler();
-
 private:
 
 	/**
@@ -118,23 +117,130 @@ private:
 	 */
 	struct _SENDBUFFER
 	{
-		char* pBuffer;       // the data
-		int nOffset;         // the send data offset
-		int nLength;         // data's length
+		Buffer* pBuffer;     // the package, retained until sent
+		Buffer* pSegment;    // the segment of the chain being sent
+		int nOffset;         // the send data offset in the segment
 	};
+
+	/**
+	 * struct : _NETEVENT
+	 * descpt : what the network thread tells the cocos thread
+	 */
+	struct _NETEVENT
+	{
+		SocketStatus eStatus;  // eSocketReceive with a package, or the new status
+		char* pData;           // pooled copy of the package, returned to the pool by the receiver
+		unsigned int uLength;  // the package length
+	};
+
+	// the queues take their nodes from the buffer pool too
+	typedef std::deque<_SENDBUFFER, PoolAllocator<_SENDBUFFER> > _SENDQUEUE;
+	typedef std::list<_NETEVENT, PoolAllocator<_NETEVENT> > _EVENTLIST;
+	typedef std::list<Buffer*, PoolAllocator<Buffer*> > _BUFFERLIST;
 	
 private:
-	bool                   m_bRunSchedule;
-	float                  m_fConnectingDuration;
-	float                  m_fSoTimeout;
-	std::list<_SENDBUFFER> m_lSendBuffers;
-	Buffer                 m_oReadBuffer;
-	InetAddress            m_oInetAddress;
-	Socket                 m_oSocket;
-	char                   m_pReadBuffer[SOCKET_READ_BUFFER_SIZE];
+	// read one chunk, return eSocketReceive, eSocketWouldBlock or eSocketIoClosed
+	int runRead();
+
+	// hand every complete package in the receive ring over, in place
+	void runFraming();
+
+	// make the receive ring hold at least uSize bytes, keeping its content, false when out of memory
+	bool growReadRing(unsigned int uSize);
+
+	// copy bytes out of the receive ring, across its end if needed
+	void peekReadRing(unsigned int uOffset, char* pOut, unsigned int uLen) const;
+
+	// send all pending packages with one gathered write, return eSocketReceive, eSocketWouldBlock or eSocketIoClosed
+	int runWrite();
+
+	// retire the written bytes from the pending packages, a write may end inside any segment
+	void consumeSendBuffers(unsigned int uSent);
+
+	// the socket has data
+	virtual void onReadable();
+
+	// the socket can send, or the connect finished
+	virtual void onWritable();
+
+	// the socket failed
+	virtual void onError();
+
+	// the connect timed out
+	virtual void onTimeout();
+
+	// watch the socket
+	void registerReactor(int nEvents);
+
+	// stop watching the socket
+	void unregisterReactor();
+
+	// watch for writable only while connecting or sending
+	void updateReactorEvents();
+
+	// the connection is lost, close and notify
+	void onSocketClosed();
+
+	// hand a package to the io side
+	void postSendBuffer(const _SENDBUFFER& tBuffer);
+
+	// release a sent package, on the cocos thread
+	void postSentBuffer(Buffer* pBuffer);
+
+	// hand a received package to the cocos thread, false when out of memory
+	bool postMessage(const char* pData, unsigned int uLen);
+
+	// hand a status change to the cocos thread
+	void postStatus(SocketStatus eStatus);
+
+	// apply a status change on the cocos thread and call back
+	void applyStatus(SocketStatus eStatus);
+
+	// the network thread body
+	void runThread();
+
+	// start the network thread and the frame call delivering its events
+	void startThread();
+
+	// stop and join the network thread, drop the undelivered events
+	void stopThread();
+
+	// move the events that did not fit into the queue, network thread
+	bool flushEventBacklog();
+
+	// move the packages that did not fit into the queue, cocos thread
+	void flushSendBacklog();
+
+	// frame call delivering the events of the network thread
+	void runDispatch(float dt);
+
+private:
+	bool                    m_bRunReactor;
+	bool                    m_bThreaded;
+	bool                    m_bRunDispatch;
+	float                   m_fSoTimeout;
+	SocketStatus            m_eIoStatus;
+	NetReactor*             m_pReactor;
+	std::thread             m_oThread;
+	std::atomic<bool>       m_bStopThread;
+	NetQueue<_NETEVENT>     m_qEvents;
+	NetQueue<_SENDBUFFER>   m_qSendBuffers;
+	_EVENTLIST              m_lEventBacklog;
+	NetQueue<Buffer*>       m_qSentBuffers;
+	_SENDQUEUE              m_dSendBacklog;
+	_BUFFERLIST             m_lSentBacklog;
+	_SENDQUEUE              m_dSendBuffers;
+	char*                   m_pReadRing;
+	unsigned int            m_uReadRingSize;
+	unsigned int            m_uReadHead;
+	unsigned int            m_uReadTail;
+	Buffer                  m_oMessageView;
+	Buffer                  m_oWrapBuffer;
+	InetAddress             m_oInetAddress;
+	Socket                  m_oSocket;
 
 protected:
-	SocketStatus           m_eStatus;
+	SocketStatus            m_eStatus;
 };
 
 NS_CC_END
@@ -29,7 +29,24 @@ THE SOFTWARE.
 
 #include "cocos2d.h"
 
-#if (CC_TARGET_PLATFORM == CC_PLATFORM_IOS || CC_TARGET_PLATFORM == CC_PLATFORM_ANDROID)
+// every platform with bsd sockets, the ios/android code paths are used for them
+#if (CC_TARGET_PLATFORM == CC_PLATFORM_IOS || CC_TARGET_PLATFORM == CC_PLATFORM_ANDROID || \
+	CC_TARGET_PLATFORM == CC_PLATFORM_LINUX || CC_TARGET_PLATFORM == CC_PLATFORM_MAC)
+#define CCNET_PLATFORM_POSIX 1
+#else
+#define CCNET_PLATFORM_POSIX 0
+#endif
+
+// the reactor uses epoll where the kernel has it, poll() on the other posix platforms
+#ifndef CCNET_USE_EPOLL
+#if (CC_TARGET_PLATFORM == CC_PLATFORM_ANDROID || CC_TARGET_PLATFORM == CC_PLATFORM_LINUX)
+#define CCNET_USE_EPOLL 1
+#else
+#define CCNET_USE_EPOLL 0
+#endif
+#endif
+
+#if CCNET_PLATFORM_POSIX
 typedef unsigned int          SOCKET;
 #ifndef INVALID_SOCKET
 #define INVALID_SOCKET  (SOCKET)(~0)
@@ -41,7 +58,7 @@ typedef unsigned int          SOCKET;
 
 #if (CC_TARGET_PLATFORM == CC_PLATFORM_WIN32)
 #include <windows.h>
-#elif (CC_TARGET_PLATFORM == CC_PLATFORM_IOS || CC_TARGET_PLATFORM == CC_PLATFORM_ANDROID)
+#elif CCNET_PLATFORM_POSIX
 #include <unistd.h>
 #include <sys/types.h>
 #include <sys/socket.h>
@@ -52,6 +69,12 @@ typedef unsigned int          SOCKET;
 #include <sys/syscall.h>
 #include <fcntl.h>
 #include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/uio.h>
+#if CCNET_USE_EPOLL
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#endif
 #endif
 
 #ifndef USING_PACKAGE_HEAD_LENGTH
@@ -61,17 +84,38 @@ typedef unsigned int          SOCKET;
 #define SOCKET_SOTIMEOUT 30.0f
 #endif
 #ifndef SOCKET_READ_BUFFER_SIZE
-#define SOCKET_READ_BUFFER_SIZE 8192
+#define SOCKET_READ_BUFFER_SIZE 8192   // the initial receive ring, a power of 2, grows for bigger packages
+#endif
+#ifndef SOCKET_MAX_PACKAGE_SIZE
+#define SOCKET_MAX_PACKAGE_SIZE (16 * 1024 * 1024)   // a bigger package head is a protocol error
 #endif
 #ifndef MEMORYTYPE_REVERSE
 #define MEMORYTYPE_REVERSE 1
 #endif
+#ifndef SOCKET_WRITE_IOV_MAX
+#define SOCKET_WRITE_IOV_MAX 64   // pieces gathered into one write call
+#endif
+#ifndef SOCKET_QUEUE_SIZE
+#define SOCKET_QUEUE_SIZE 256
+#endif
+#ifndef SOCKET_THREAD_POLL_INTERVAL
+#define SOCKET_THREAD_POLL_INTERVAL 10
+#endif
 #ifndef HANDLE_ON_SINGLE_FRAME
 #define HANDLE_ON_SINGLE_FRAME 1
 #endif
 #ifndef CCBUFFER_ORGINAL_SIZE
 #define CCBUFFER_ORGINAL_SIZE 512
 #endif
+#ifndef CCBUFFER_HEAD_ROOM
+#define CCBUFFER_HEAD_ROOM 8   // reserved in front of the data, the package head is prepended there
+#endif
+#ifndef CCBUFFER_POOL_MAX_BLOCK
+#define CCBUFFER_POOL_MAX_BLOCK 65536   // the biggest pooled block, a power of 2, 0 turns the pool off
+#endif
+#ifndef CCBUFFER_POOL_CACHE_BYTES
+#define CCBUFFER_POOL_CACHE_BYTES 65536   // kept per size class by each thread before the depot takes them
+#endif
 
 #ifndef SINGLE_DELEGATE_INSTANCE_FUNC
 #define SINGLE_DELEGATE_INSTANCE_FUNC(_CLASS_) \
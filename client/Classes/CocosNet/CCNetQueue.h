@@ -0,0 +1,113 @@
+﻿/****************************************************************************
+Copyright (c) 2014 Lijunlin - Jason lee
+
+Created by Lijunlin - Jason lee on 2014
+
+jason.lee.c@foxmail.com
+http://www.cocos2d-x.org
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+****************************************************************************/
+#ifndef __CCNET_QUEUE_H__
+#define __CCNET_QUEUE_H__
+
+#include "cocos2d.h"
+#include <atomic>
+#include <vector>
+
+NS_CC_BEGIN
+
+#ifndef CCNET_CACHE_LINE_SIZE
+#define CCNET_CACHE_LINE_SIZE 64
+#endif
+
+/**
+ * class  : NetQueue
+ * descpt : bounded lock free queue for exactly one producer thread and one consumer thread.
+ *          each side only writes its own index, so push and pop are a load and a store,
+ *          the indexes live on separate cache lines.
+ */
+template<typename T>
+class NetQueue
+{
+public:
+	// the capacity is rounded up to a power of 2
+	explicit NetQueue(unsigned int uCapacity)
+	: m_uMask(0)
+	, m_uHead(0)
+	, m_uTail(0)
+	{
+		unsigned int uSize = 1;
+		while( uSize < uCapacity )
+		{
+			uSize <<= 1;
+		}
+		m_vSlots.resize(uSize);
+		m_uMask = uSize - 1;
+	}
+
+	// producer thread only, false when full
+	bool push(const T& tValue)
+	{
+		const unsigned int uTail = m_uTail.load(std::memory_order_relaxed);
+		if( uTail - m_uHead.load(std::memory_order_acquire) > m_uMask )
+		{
+			return false;
+		}
+		m_vSlots[uTail & m_uMask] = tValue;
+		m_uTail.store(uTail + 1, std::memory_order_release);
+		return true;
+	}
+
+	// consumer thread only, false when empty
+	bool pop(T& tValue)
+	{
+		const unsigned int uHead = m_uHead.load(std::memory_order_relaxed);
+		if( uHead == m_uTail.load(std::memory_order_acquire) )
+		{
+			return false;
+		}
+		tValue = m_vSlots[uHead & m_uMask];
+		m_uHead.store(uHead + 1, std::memory_order_release);
+		return true;
+	}
+
+	// a hint only when called from the producer
+	bool empty() const
+	{
+		return m_uHead.load(std::memory_order_acquire) == m_uTail.load(std::memory_order_acquire);
+	}
+
+private:
+	NetQueue(const NetQueue&);
+	NetQueue& operator=(const NetQueue&);
+
+private:
+	std::vector<T>            m_vSlots;
+	unsigned int              m_uMask;
+	char                      m_pPad0[CCNET_CACHE_LINE_SIZE];
+	std::atomic<unsigned int> m_uHead;    // next slot to pop, written by the consumer
+	char                      m_pPad1[CCNET_CACHE_LINE_SIZE];
+	std::atomic<unsigned int> m_uTail;    // next slot to push, written by the producer
+	char                      m_pPad2[CCNET_CACHE_LINE_SIZE];
+};
+
+NS_CC_END
+
+#endif //__CCNET_QUEUE_H__
\ No newline at end of file
@@ -0,0 +1,463 @@
+﻿/****************************************************************************
+Copyright (c) 2014 Lijunlin - Jason lee
+
+Created by Lijunlin - Jason lee on 2014
+
+jason.lee.c@foxmail.com
+http://www.cocos2d-x.org
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+****************************************************************************/
+#include "CCNetReactor.h"
+
+NS_CC_BEGIN
+
+#define REACTOR_SCHEDULE_KEY "NetReactor"
+#define REACTOR_ORIGINAL_EVENTS 16
+
+NetReactor::NetReactor()
+: m_nDeadlines(0)
+, m_bAutoSchedule(false)
+, m_bRunSchedule(false)
+#if CCNET_USE_EPOLL
+, m_nEpoll(-1)
+, m_vEvents(REACTOR_ORIGINAL_EVENTS)
+#elif CCNET_PLATFORM_POSIX
+, m_bPollFdsDirty(false)
+#endif
+{
+	m_oWakeup.nReadFd = -1;
+	m_oWakeup.nWriteFd = -1;
+
+#if CCNET_USE_EPOLL
+	m_nEpoll = epoll_create(REACTOR_ORIGINAL_EVENTS);
+	if( m_nEpoll < 0 )
+	{
+		CCLOGERROR("create epoll failed");
+	}
+	else
+	{
+		fcntl(m_nEpoll, F_SETFD, FD_CLOEXEC);
+	}
+#endif
+}
+
+NetReactor::~NetReactor()
+{
+	setAutoSchedule(false);
+#if CCNET_PLATFORM_POSIX
+	if( m_oWakeup.nReadFd >= 0 )
+	{
+		::close(m_oWakeup.nReadFd);
+	}
+	if( m_oWakeup.nWriteFd >= 0 && m_oWakeup.nWriteFd != m_oWakeup.nReadFd )
+	{
+		::close(m_oWakeup.nWriteFd);
+	}
+#endif
+#if CCNET_USE_EPOLL
+	if( m_nEpoll >= 0 )
+	{
+		::close(m_nEpoll);
+	}
+#endif
+}
+
+NetReactor* NetReactor::sharedReactor()
+{
+	static NetReactor* pRet = NULL;
+	if( !pRet )
+	{
+		pRet = new NetReactor();
+		pRet->setAutoSchedule(true);
+	}
+	return pRet;
+}
+
+bool NetReactor::addSocket(SOCKET uSocket, ReactorHandler* pHandler, int nEvents)
+{
+	if( uSocket == INVALID_SOCKET || !pHandler || m_mHandlers.count(uSocket) )
+		return false;
+
+	if( !control(uSocket, nEvents, true) )
+		return false;
+
+	_HANDLER tHandler;
+	tHandler.pHandler = pHandler;
+	tHandler.nEvents = nEvents;
+	tHandler.bDeadline = false;
+	m_mHandlers[uSocket] = tHandler;
+
+	updateScheduler();
+	return true;
+}
+
+bool NetReactor::modifySocket(SOCKET uSocket, int nEvents)
+{
+	std::map<SOCKET, _HANDLER>::iterator it = m_mHandlers.find(uSocket);
+	if( it == m_mHandlers.end() )
+		return false;
+
+	if( it->second.nEvents == nEvents )
+		return true;
+
+	if( !control(uSocket, nEvents, false) )
+		return false;
+
+	it->second.nEvents = nEvents;
+	return true;
+}
+
+void NetReactor::removeSocket(SOCKET uSocket)
+{
+	std::map<SOCKET, _HANDLER>::iterator it = m_mHandlers.find(uSocket);
+	if( it == m_mHandlers.end() )
+		return;
+
+	if( it->second.bDeadline )
+	{
+		--m_nDeadlines;
+	}
+	m_mHandlers.erase(it);
+
+#if CCNET_USE_EPOLL
+	epoll_event tEvent;
+	memset(&tEvent, 0, sizeof(tEvent));
+	epoll_ctl(m_nEpoll, EPOLL_CTL_DEL, (int)uSocket, &tEvent);
+#elif CCNET_PLATFORM_POSIX
+	m_bPollFdsDirty = true;
+#endif
+
+	updateScheduler();
+}
+
+void NetReactor::setDeadline(SOCKET uSocket, float fSeconds)
+{
+	std::map<SOCKET, _HANDLER>::iterator it = m_mHandlers.find(uSocket);
+	if( it == m_mHandlers.end() )
+		return;
+
+	_HANDLER& tHandler = it->second;
+	if( fSeconds > 0.0f )
+	{
+		if( !tHandler.bDeadline )
+		{
+			++m_nDeadlines;
+		}
+		tHandler.bDeadline = true;
+		tHandler.tDeadline = std::chrono::steady_clock::now()
+			+ std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<float>(fSeconds));
+	}
+	else if( tHandler.bDeadline )
+	{
+		--m_nDeadlines;
+		tHandler.bDeadline = false;
+	}
+}
+
+bool NetReactor::empty() const
+{
+	return m_mHandlers.empty();
+}
+
+void NetReactor::setAutoSchedule(bool bAutoSchedule)
+{
+	m_bAutoSchedule = bAutoSchedule;
+	updateScheduler();
+}
+
+bool NetReactor::enableWakeup()
+{
+	if( m_oWakeup.nReadFd >= 0 )
+		return true;
+
+#if CCNET_USE_EPOLL
+	int nFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+	if( nFd < 0 )
+		return false;
+	m_oWakeup.nReadFd = nFd;
+	m_oWakeup.nWriteFd = nFd;
+#elif CCNET_PLATFORM_POSIX
+	int pFds[2];
+	if( pipe(pFds) != 0 )
+		return false;
+	for( int i = 0; i < 2; ++i )
+	{
+		fcntl(pFds[i], F_SETFL, fcntl(pFds[i], F_GETFL, 0) | O_NONBLOCK);
+		fcntl(pFds[i], F_SETFD, FD_CLOEXEC);
+	}
+	m_oWakeup.nReadFd = pFds[0];
+	m_oWakeup.nWriteFd = pFds[1];
+#else
+	// winsock can not select on a pipe, a threaded user polls with a timeout instead
+	return false;
+#endif
+
+#if CCNET_PLATFORM_POSIX
+	return addSocket((SOCKET)m_oWakeup.nReadFd, &m_oWakeup, eReactorRead);
+#endif
+}
+
+void NetReactor::wakeup()
+{
+#if CCNET_USE_EPOLL
+	if( m_oWakeup.nWriteFd >= 0 )
+	{
+		uint64_t uOne = 1;
+		ssize_t nRet = ::write(m_oWakeup.nWriteFd, &uOne, sizeof(uOne));
+		(void)nRet;
+	}
+#elif CCNET_PLATFORM_POSIX
+	if( m_oWakeup.nWriteFd >= 0 )
+	{
+		char cOne = 1;
+		ssize_t nRet = ::write(m_oWakeup.nWriteFd, &cOne, sizeof(cOne));
+		(void)nRet;
+	}
+#endif
+}
+
+void NetReactor::_WAKEUP::onReadable()
+{
+#if CCNET_PLATFORM_POSIX
+	char pDrain[64];
+	while( ::read(nReadFd, pDrain, sizeof(pDrain)) > 0 );
+#endif
+}
+
+bool NetReactor::control(SOCKET uSocket, int nEvents, bool bAdd)
+{
+#if CCNET_USE_EPOLL
+	epoll_event tEvent;
+	memset(&tEvent, 0, sizeof(tEvent));
+	tEvent.data.fd = (int)uSocket;
+	if( nEvents & eReactorRead )
+		tEvent.events |= EPOLLIN;
+	if( nEvents & eReactorWrite )
+		tEvent.events |= EPOLLOUT;
+
+	if( epoll_ctl(m_nEpoll, bAdd ? EPOLL_CTL_ADD : EPOLL_CTL_MOD, (int)uSocket, &tEvent) != 0 )
+	{
+		CCLOGERROR("epoll_ctl failed %d", errno);
+		return false;
+	}
+#elif CCNET_PLATFORM_POSIX
+	m_bPollFdsDirty = true;
+#endif
+	return true;
+}
+
+int NetReactor::poll(int nTimeoutMs)
+{
+	if( m_mHandlers.empty() )
+		return 0;
+
+	// never sleep past the nearest deadline
+	if( m_nDeadlines > 0 && nTimeoutMs != 0 )
+	{
+		std::chrono::steady_clock::time_point tNow = std::chrono::steady_clock::now();
+		for( std::map<SOCKET, _HANDLER>::iterator it = m_mHandlers.begin(); it != m_mHandlers.end(); ++it )
+		{
+			if( it->second.bDeadline )
+			{
+				long long llLeft = std::chrono::duration_cast<std::chrono::milliseconds>(it->second.tDeadline - tNow).count() + 1;
+				llLeft = llLeft > 0 ? llLeft : 0;
+				if( nTimeoutMs < 0 || llLeft < nTimeoutMs )
+				{
+					nTimeoutMs = (int)llLeft;
+				}
+			}
+		}
+	}
+
+	int nCount = 0;
+
+#if CCNET_USE_EPOLL
+	int nReady = epoll_wait(m_nEpoll, &m_vEvents[0], (int)m_vEvents.size(), nTimeoutMs);
+	for( int i = 0; i < nReady; ++i )
+	{
+		const unsigned int uEvents = m_vEvents[i].events;
+		nCount += dispatch((SOCKET)m_vEvents[i].data.fd,
+			(uEvents & (EPOLLIN | EPOLLHUP | EPOLLERR)) != 0,
+			(uEvents & (EPOLLOUT | EPOLLHUP | EPOLLERR)) != 0,
+			(uEvents & (EPOLLHUP | EPOLLERR)) != 0);
+	}
+	if( nReady == (int)m_vEvents.size() )
+	{
+		m_vEvents.resize(m_vEvents.size() * 2);
+	}
+#elif CCNET_PLATFORM_POSIX
+	if( m_bPollFdsDirty )
+	{
+		m_vPollFds.clear();
+		for( std::map<SOCKET, _HANDLER>::iterator it = m_mHandlers.begin(); it != m_mHandlers.end(); ++it )
+		{
+			pollfd tPollFd;
+			tPollFd.fd = (int)it->first;
+			tPollFd.events = 0;
+			tPollFd.revents = 0;
+			if( it->second.nEvents & eReactorRead )
+				tPollFd.events |= POLLIN;
+			if( it->second.nEvents & eReactorWrite )
+				tPollFd.events |= POLLOUT;
+			m_vPollFds.push_back(tPollFd);
+		}
+		m_bPollFdsDirty = false;
+	}
+
+	int nReady = ::poll(&m_vPollFds[0], (nfds_t)m_vPollFds.size(), nTimeoutMs);
+	for( size_t i = 0; nReady > 0 && i < m_vPollFds.size(); ++i )
+	{
+		// a callback may rebuild the list, so copy the entry out first
+		const pollfd tPollFd = m_vPollFds[i];
+		if( tPollFd.revents == 0 )
+			continue;
+
+		--nReady;
+		nCount += dispatch((SOCKET)tPollFd.fd,
+			(tPollFd.revents & (POLLIN | POLLHUP | POLLERR)) != 0,
+			(tPollFd.revents & (POLLOUT | POLLHUP | POLLERR)) != 0,
+			(tPollFd.revents & (POLLHUP | POLLERR | POLLNVAL)) != 0);
+		if( m_bPollFdsDirty )
+			break;
+	}
+#else
+	fd_set tReadFds, tWriteFds, tExceptFds;
+	FD_ZERO(&tReadFds);
+	FD_ZERO(&tWriteFds);
+	FD_ZERO(&tExceptFds);
+	std::vector<SOCKET> vSockets;
+	vSockets.reserve(m_mHandlers.size());
+	for( std::map<SOCKET, _HANDLER>::iterator it = m_mHandlers.begin(); it != m_mHandlers.end(); ++it )
+	{
+		vSockets.push_back(it->first);
+		if( it->second.nEvents & eReactorRead )
+			FD_SET(it->first, &tReadFds);
+		if( it->second.nEvents & eReactorWrite )
+			FD_SET(it->first, &tWriteFds);
+		// winsock reports a failed connect here
+		FD_SET(it->first, &tExceptFds);
+	}
+
+	struct timeval tv;
+	tv.tv_sec = nTimeoutMs / 1000;
+	tv.tv_usec = (nTimeoutMs % 1000) * 1000;
+	int nReady = select(0, &tReadFds, &tWriteFds, &tExceptFds, nTimeoutMs < 0 ? NULL : &tv);
+	for( size_t i = 0; nReady > 0 && i < vSockets.size(); ++i )
+	{
+		const SOCKET uSocket = vSockets[i];
+		const bool bError = FD_ISSET(uSocket, &tExceptFds) != 0;
+		nCount += dispatch(uSocket,
+			FD_ISSET(uSocket, &tReadFds) != 0 || bError,
+			FD_ISSET(uSocket, &tWriteFds) != 0 || bError,
+			bError);
+	}
+#endif
+
+	nCount += checkDeadlines();
+	return nCount;
+}
+
+int NetReactor::dispatch(SOCKET uSocket, bool bReadable, bool bWritable, bool bError)
+{
+	std::map<SOCKET, _HANDLER>::iterator it = m_mHandlers.find(uSocket);
+	if( it == m_mHandlers.end() )
+		return 0;
+
+	ReactorHandler* pHandler = it->second.pHandler;
+	int nCount = 0;
+	if( bReadable && (it->second.nEvents & eReactorRead) )
+	{
+		pHandler->onReadable();
+		++nCount;
+
+		// the handler may have removed itself
+		it = m_mHandlers.find(uSocket);
+		if( it == m_mHandlers.end() || it->second.pHandler != pHandler )
+			return nCount;
+	}
+
+	if( bWritable && (it->second.nEvents & eReactorWrite) )
+	{
+		pHandler->onWritable();
+		++nCount;
+	}
+
+	if( bError && nCount == 0 )
+	{
+		pHandler->onError();
+		++nCount;
+	}
+	return nCount;
+}
+
+int NetReactor::checkDeadlines()
+{
+	if( m_nDeadlines == 0 )
+		return 0;
+
+	std::vector<SOCKET> vExpired;
+	std::chrono::steady_clock::time_point tNow = std::chrono::steady_clock::now();
+	for( std::map<SOCKET, _HANDLER>::iterator it = m_mHandlers.begin(); it != m_mHandlers.end(); ++it )
+	{
+		if( it->second.bDeadline && it->second.tDeadline <= tNow )
+		{
+			vExpired.push_back(it->first);
+		}
+	}
+
+	int nCount = 0;
+	for( size_t i = 0; i < vExpired.size(); ++i )
+	{
+		std::map<SOCKET, _HANDLER>::iterator it = m_mHandlers.find(vExpired[i]);
+		if( it == m_mHandlers.end() || !it->second.bDeadline )
+			continue;
+
+		it->second.bDeadline = false;
+		--m_nDeadlines;
+		it->second.pHandler->onTimeout();
+		++nCount;
+	}
+	return nCount;
+}
+
+void NetReactor::runSchedule(float dt)
+{
+	poll(0);
+}
+
+void NetReactor::updateScheduler()
+{
+	bool bRunSchedule = m_bAutoSchedule && !m_mHandlers.empty();
+	if( bRunSchedule == m_bRunSchedule )
+		return;
+
+	Scheduler* pScheduler = Director::getInstance()->getScheduler();
+	if( bRunSchedule )
+	{
+		pScheduler->schedule(CC_CALLBACK_1(NetReactor::runSchedule, this), this, 0.0f, false, REACTOR_SCHEDULE_KEY);
+	}
+	else
+	{
+		pScheduler->unschedule(REACTOR_SCHEDULE_KEY, this);
+	}
+	m_bRunSchedule = bRunSchedule;
+}
+
+NS_CC_END
\ No newline at end of file
@@ -0,0 +1,177 @@
+﻿/****************************************************************************
+Copyright (c) 2014 Lijunlin - Jason lee
+
+Created by Lijunlin - Jason lee on 2014
+
+jason.lee.c@foxmail.com
+http://www.cocos2d-x.org
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+****************************************************************************/
+#ifndef __CCNET_REACTOR_H__
+#define __CCNET_REACTOR_H__
+
+#include "cocos2d.h"
+#include "CCNetMacros.h"
+#include <map>
+#include <vector>
+#include <chrono>
+
+NS_CC_BEGIN
+
+/**
+ * enum   : ReactorEvent
+ * descpt : the readiness a handler is interested in
+ */
+enum ReactorEvent
+{
+	eReactorNone				= 0,
+	eReactorRead				= 1,
+	eReactorWrite				= 2,
+};
+
+/**
+ * class  : ReactorHandler
+ * descpt : receives the readiness of one socket from the reactor
+ */
+class ReactorHandler
+{
+public:
+	virtual ~ReactorHandler(){}
+
+	// the socket has data, or the peer closed it
+	virtual void onReadable() = 0;
+
+	// the socket can take more data, or the pending connect finished
+	virtual void onWritable() = 0;
+
+	// error or hang up that no read/write interest picked up
+	virtual void onError() = 0;
+
+	// the deadline set by NetReactor::setDeadline passed
+	virtual void onTimeout(){}
+};
+
+/**
+ * class  : NetReactor
+ * descpt : waits on all registered sockets with one call (epoll, poll or select),
+ *          then dispatches the ready ones to their handlers.
+ *          a reactor must only be used from one thread.
+ */
+class NetReactor
+{
+public:
+	NetReactor();
+	virtual ~NetReactor();
+
+	// the reactor of the cocos thread, polled once per frame while it has sockets
+	static NetReactor* sharedReactor();
+
+public:
+	// watch a socket, nEvents is a mask of ReactorEvent
+	bool addSocket(SOCKET uSocket, ReactorHandler* pHandler, int nEvents);
+
+	// change the interest of a watched socket
+	bool modifySocket(SOCKET uSocket, int nEvents);
+
+	// stop watching, safe inside a callback. call it before closing the socket
+	void removeSocket(SOCKET uSocket);
+
+	// call onTimeout after fSeconds, zero or less clears the deadline
+	void setDeadline(SOCKET uSocket, float fSeconds);
+
+	// wait at most nTimeoutMs (0 does not block, -1 waits forever), return the number of callbacks
+	int poll(int nTimeoutMs);
+
+	// no socket is watched
+	bool empty() const;
+
+	// poll from the director scheduler while any socket is watched
+	void setAutoSchedule(bool bAutoSchedule);
+
+	// let another thread interrupt a blocking poll, false where it is not supported
+	bool enableWakeup();
+
+	// interrupt the running or the next poll, safe from any thread
+	void wakeup();
+
+private:
+	// apply the interest to the backend
+	bool control(SOCKET uSocket, int nEvents, bool bAdd);
+
+	// call the handler of a ready socket, it is looked up again after every callback
+	int dispatch(SOCKET uSocket, bool bReadable, bool bWritable, bool bError);
+
+	// fire the passed deadlines
+	int checkDeadlines();
+
+	// frame call
+	void runSchedule(float dt);
+
+	// registe or unregiste the frame call as the sockets come and go
+	void updateScheduler();
+
+private:
+
+	/**
+	 * struct : _HANDLER
+	 * descpt : a watched socket
+	 */
+	struct _HANDLER
+	{
+		ReactorHandler* pHandler;
+		int nEvents;
+		bool bDeadline;
+		std::chrono::steady_clock::time_point tDeadline;
+	};
+
+	/**
+	 * class  : _WAKEUP
+	 * descpt : drains the eventfd or pipe used by wakeup
+	 */
+	class _WAKEUP : public ReactorHandler
+	{
+	public:
+		virtual void onReadable();
+		virtual void onWritable(){}
+		virtual void onError(){}
+
+	public:
+		int nReadFd;
+		int nWriteFd;
+	};
+
+private:
+	std::map<SOCKET, _HANDLER> m_mHandlers;
+	int                        m_nDeadlines;
+	bool                       m_bAutoSchedule;
+	bool                       m_bRunSchedule;
+	_WAKEUP                    m_oWakeup;
+#if CCNET_USE_EPOLL
+	int                        m_nEpoll;
+	std::vector<epoll_event>   m_vEvents;
+#elif CCNET_PLATFORM_POSIX
+	std::vector<pollfd>        m_vPollFds;
+	bool                       m_bPollFdsDirty;
+#endif
+};
+
+NS_CC_END
+
+#endif //__CCNET_REACTOR_H__
\ No newline at end of file
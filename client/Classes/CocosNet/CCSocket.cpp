@@ -32,6 +32,13 @@ NS_CC_BEGIN
 static bool bStartup = false;
 #endif
 
+// a peer reset must come back as an error, not as SIGPIPE
+#if defined(MSG_NOSIGNAL)
+#define CCNET_SEND_FLAGS MSG_NOSIGNAL
+#else
+#define CCNET_SEND_FLAGS 0
+#endif
+
 Socket::Socket()
 : m_uSocket(INVALID_SOCKET)
 {
@@ -75,7 +82,7 @@ bool Socket::ccInit()
 	}
 #endif
 
-#if( CC_TARGET_PLATFORM == CC_PLATFORM_IOS || CC_TARGET_PLATFORM == CC_PLATFORM_ANDROID )
+#if CCNET_PLATFORM_POSIX
 	int nFlags = fcntl(m_uSocket, F_GETFL, 0);
     int nRet = fcntl(m_uSocket, F_SETFL, nFlags | O_NONBLOCK);
 	if( nRet == SOCKET_ERROR )
@@ -94,6 +101,11 @@ bool Socket::ccInit()
 		return false;
 	}
 
+#if defined(SO_NOSIGPIPE)
+	int nNoSigPipe = 1;
+	setsockopt(m_uSocket, SOL_SOCKET, SO_NOSIGPIPE, (char*)&nNoSigPipe, sizeof(nNoSigPipe));
+#endif
+
 	return true;
 }
 
@@ -105,7 +117,7 @@ void Socket::ccClose()
 		closesocket(m_uSocket);
 #endif
 
-#if( CC_TARGET_PLATFORM == CC_PLATFORM_IOS || CC_TARGET_PLATFORM == CC_PLATFORM_ANDROID )
+#if CCNET_PLATFORM_POSIX
 		close(m_uSocket);        
 #endif
 		m_uSocket = INVALID_SOCKET;
@@ -145,7 +157,7 @@ bool Socket::ccConnect()
 		}
 #endif
 
-#if( CC_TARGET_PLATFORM == CC_PLATFORM_IOS || CC_TARGET_PLATFORM == CC_PLATFORM_ANDROID )
+#if CCNET_PLATFORM_POSIX
 		if( nRet == SOCKET_ERROR && errno == EINPROGRESS )
 		{
 			return true;
@@ -167,7 +179,7 @@ void Socket::ccDisconnect()
 		shutdown(m_uSocket, SD_BOTH);
 #endif
 
-#if( CC_TARGET_PLATFORM == CC_PLATFORM_IOS || CC_TARGET_PLATFORM == CC_PLATFORM_ANDROID )
+#if CCNET_PLATFORM_POSIX
         shutdown(m_uSocket, SHUT_RDWR);
 #endif
 #endif
@@ -180,12 +192,32 @@ void Socket::setInetAddress(const InetAddress& oInetAddress)
 	m_oInetAddress = oInetAddress;
 }
 
+SOCKET Socket::getSocket() const
+{
+	return m_uSocket;
+}
+
+// the last call failed only because the non-blocking socket had nothing to do
+static bool isWouldBlock()
+{
+#if( CC_TARGET_PLATFORM == CC_PLATFORM_WIN32 )
+	return WSAGetLastError() == WSAEWOULDBLOCK;
+#else
+	return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR;
+#endif
+}
+
 int Socket::ccRead(char* _buff, int _len)
 {
 	if( m_uSocket == INVALID_SOCKET )
 		return eSocketIoError;
 
-	return ::recv(m_uSocket, _buff, _len, 0);
+	int nRet = ::recv(m_uSocket, _buff, _len, 0);
+	if( nRet == SOCKET_ERROR && isWouldBlock() )
+	{
+		return eSocketWouldBlock;
+	}
+	return nRet;
 }
 
 int Socket::ccWrite(char* _buff, int _len)
@@ -193,12 +225,55 @@ int Socket::ccWrite(char* _buff, int _len)
 	if( m_uSocket == INVALID_SOCKET )
 		return eSocketIoError;
 
-#if( CC_TARGET_PLATFORM == CC_PLATFORM_WIN32 || CC_TARGET_PLATFORM == CC_PLATFORM_ANDROID )
-	return ::send(m_uSocket, _buff, _len, 0);
-#endif
+	int nRet = ::send(m_uSocket, _buff, _len, CCNET_SEND_FLAGS);
+	if( nRet == SOCKET_ERROR && isWouldBlock() )
+	{
+		return eSocketWouldBlock;
+	}
+	return nRet;
+}
+
+int Socket::ccWritev(const SocketIoVec* _vecs, int _count)
+{
+	if( m_uSocket == INVALID_SOCKET )
+		return eSocketIoError;
+
+	_count = _count < SOCKET_WRITE_IOV_MAX ? _count : SOCKET_WRITE_IOV_MAX;
+
+#if( CC_TARGET_PLATFORM == CC_PLATFORM_WIN32 )
+	WSABUF pBufs[SOCKET_WRITE_IOV_MAX];
+	for( int i = 0; i < _count; ++i )
+	{
+		pBufs[i].buf = (char*)_vecs[i].pData;
+		pBufs[i].len = _vecs[i].uLength;
+	}
+
+	DWORD dwSent = 0;
+	if( WSASend(m_uSocket, pBufs, (DWORD)_count, &dwSent, 0, NULL, NULL) == SOCKET_ERROR )
+	{
+		return isWouldBlock() ? eSocketWouldBlock : eSocketIoError;
+	}
+	return (int)dwSent;
+#else
+	// sendmsg rather than writev, it takes the no-sigpipe flag
+	struct iovec pVecs[SOCKET_WRITE_IOV_MAX];
+	for( int i = 0; i < _count; ++i )
+	{
+		pVecs[i].iov_base = (void*)_vecs[i].pData;
+		pVecs[i].iov_len = _vecs[i].uLength;
+	}
 
-#if( CC_TARGET_PLATFORM == CC_PLATFORM_IOS )
-    return ::send(m_uSocket, _buff, _len, SO_NOSIGPIPE);
+	struct msghdr tMsg;
+	memset(&tMsg, 0, sizeof(tMsg));
+	tMsg.msg_iov = pVecs;
+	tMsg.msg_iovlen = _count;
+
+	int nRet = (int)::sendmsg(m_uSocket, &tMsg, CCNET_SEND_FLAGS);
+	if( nRet == SOCKET_ERROR && isWouldBlock() )
+	{
+		return eSocketWouldBlock;
+	}
+	return nRet;
 #endif
 }
 
@@ -265,7 +340,7 @@ int Socket::ccIsConnected()
 
 			return eSocketConnected;
 
-#elif( CC_TARGET_PLATFORM == CC_PLATFORM_IOS || CC_TARGET_PLATFORM == CC_PLATFORM_ANDROID )
+#elif CCNET_PLATFORM_POSIX
 
 			int nError;
 			socklen_t len = sizeof(nError);
@@ -285,4 +360,20 @@ int Socket::ccIsConnected()
 	return eSocketConnecting;
 }
 
+int Socket::ccCheckConnect()
+{
+	// only valid once the socket was reported writable or failed, no select here
+	int nError = 0;
+#if( CC_TARGET_PLATFORM == CC_PLATFORM_WIN32 )
+	int len = sizeof(nError);
+#else
+	socklen_t len = sizeof(nError);
+#endif
+	if( getsockopt(m_uSocket, SOL_SOCKET, SO_ERROR, (char*)&nError, &len) == SOCKET_ERROR )
+	{
+		return eSocketConnectFailed;
+	}
+	return nError == 0 ? eSocketConnected : eSocketConnectFailed;
+}
+
 NS_CC_END
\ No newline at end of file
@@ -52,6 +52,17 @@ enum SocketStatus
 	eSocketIoClosed				=  0,
 	eSocketIoError				= -1,
 	eSocketCreateFailed			= -2,
+	eSocketWouldBlock			= -3,
+};
+
+/**
+ * struct : SocketIoVec
+ * descpt : one piece of a gathered write
+ */
+struct SocketIoVec
+{
+	const char* pData;
+	unsigned int uLength;
 };
 
 /**
@@ -68,13 +79,16 @@ public:
 	bool ccInit();
 	int  ccRead(char* _buff, int _len);
 	int  ccWrite(char* _buff, int _len);
+	int  ccWritev(const SocketIoVec* _vecs, int _count);
 	int  ccIsConnected();
+	int  ccCheckConnect();
 	bool ccIsReadable();
 	bool ccIsWritable();
 	void ccClose();
 	bool ccConnect();
 	void ccDisconnect();
 	void setInetAddress(const InetAddress& oInetAddress);
+	SOCKET getSocket() const;
 
 protected:
 	SOCKET m_uSocket;
@@ -32,15 +32,19 @@ THE SOFTWARE.
 NS_CC_BEGIN
 
 class Buffer;
+class BufferPool;
 class InetAddress;
 class Socket;
 class NetDelegate;
+class NetReactor;
 
 NS_CC_END
 
+#include "CCBufferPool.h"
 #include "CCBuffer.h"
 #include "CCInetAddress.h"
 #include "CCSocket.h"
+#include "CCNetReactor.h"
 #include "CCNetDelegate.h"
 
 
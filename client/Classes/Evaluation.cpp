@@ -0,0 +1,170 @@
+﻿#include "Evaluation.h"
+#include <sstream>
+#include "json/document.h"
+
+
+namespace
+{
+	const char* const kFeatureNames[kEvalFeatureNum] =
+	{
+		"material",
+		"mobility",
+		"threat",
+		"line",
+		"tempo",
+	};
+
+	// 可走的步数
+	int CountMobility(FBitboard own, FBitboard empty)
+	{
+		int count = 0;
+		while (own)
+		{
+			int square = helper::LowestSquare(own);
+			own &= own - 1;
+			count += helper::PopCount(helper::AdjacentSquares(square) & empty);
+		}
+		return count;
+	}
+
+	// 下一步可吃掉的对方棋子
+	FBitboard CollectThreats(FBitboard own, FBitboard other)
+	{
+		FBitboard threats = 0;
+		const FBitboard empty = static_cast<FBitboard>(~(own | other));
+		FBitboard pieces = own;
+		while (pieces)
+		{
+			int source = helper::LowestSquare(pieces);
+			pieces &= pieces - 1;
+			FBitboard targets = helper::AdjacentSquares(source) & empty;
+			while (targets)
+			{
+				int target = helper::LowestSquare(targets);
+				targets &= targets - 1;
+				FBitboard moved = static_cast<FBitboard>((own & ~(1 << source)) | (1 << target));
+				threats |= helper::ComputeKilled(moved, other, target);
+			}
+		}
+		return threats;
+	}
+
+	// 线上相连的两子
+	int CountLinePairs(FBitboard own)
+	{
+		int count = 0;
+		for (int i = 0; i < kCheckerboardRowNum; ++i)
+		{
+			int row = (own >> (i * kCheckerboardColNum)) & 0xF;
+			count += helper::PopCount(static_cast<FBitboard>(row & (row >> 1)));
+		}
+		for (int i = 0; i < kCheckerboardRowNum - 1; ++i)
+		{
+			FBitboard rows = static_cast<FBitboard>((own >> (i * kCheckerboardColNum)) & 0xF);
+			FBitboard next = static_cast<FBitboard>((own >> ((i + 1) * kCheckerboardColNum)) & 0xF);
+			count += helper::PopCount(rows & next);
+		}
+		return count;
+	}
+}
+
+FEvalWeights::FEvalWeights()
+{
+	values[EVAL_MATERIAL] = 100;
+	values[EVAL_MOBILITY] = 4;
+	values[EVAL_THREAT] = 30;
+	values[EVAL_LINE] = 8;
+	values[EVAL_TEMPO] = 5;
+}
+
+Evaluation::Evaluation()
+{
+
+}
+
+// 设置权重
+void Evaluation::setWeights(const FEvalWeights &weights)
+{
+	weights_ = weights;
+}
+
+// 获取权重
+const FEvalWeights& Evaluation::getWeights() const
+{
+	return weights_;
+}
+
+// 评估局面
+int Evaluation::evaluate(const Position &pos) const
+{
+	int features[kEvalFeatureNum];
+	extractFeatures(pos, features);
+
+	int score = 0;
+	for (int i = 0; i < kEvalFeatureNum; ++i)
+	{
+		score += features[i] * weights_.values[i];
+	}
+	return score;
+}
+
+// 提取局面特征
+void Evaluation::extractFeatures(const Position &pos, int features[kEvalFeatureNum])
+{
+	const FBitboard own = pos.getPieces(pos.getSideToMove());
+	const FBitboard other = pos.getPieces(helper::OpponentOf(pos.getSideToMove()));
+	const FBitboard empty = static_cast<FBitboard>(~(own | other));
+
+	features[EVAL_MATERIAL] = helper::PopCount(own) - helper::PopCount(other);
+	features[EVAL_MOBILITY] = CountMobility(own, empty) - CountMobility(other, empty);
+	features[EVAL_THREAT] = helper::PopCount(CollectThreats(own, other)) - helper::PopCount(CollectThreats(other, own));
+	features[EVAL_LINE] = CountLinePairs(own) - CountLinePairs(other);
+	features[EVAL_TEMPO] = 1;
+}
+
+// 获取特征名称
+const char* Evaluation::getFeatureName(int feature)
+{
+	return feature >= 0 && feature < kEvalFeatureNum ? kFeatureNames[feature] : "";
+}
+
+// 从json解析权重
+bool Evaluation::parseWeights(const std::string &json, FEvalWeights &weights)
+{
+	rapidjson::Document doc;
+	doc.Parse<0>(json.c_str());
+	if (doc.HasParseError() || !doc.IsObject())
+	{
+		return false;
+	}
+
+	// 全部校验通过才修改
+	FEvalWeights parsed = weights;
+	for (int i = 0; i < kEvalFeatureNum; ++i)
+	{
+		if (doc.HasMember(kFeatureNames[i]) && doc[kFeatureNames[i]].IsInt())
+		{
+			const int value = doc[kFeatureNames[i]].GetInt();
+			if (value < -kMaxEvalWeight || value > kMaxEvalWeight)
+			{
+				return false;
+			}
+			parsed.values[i] = value;
+		}
+	}
+	weights = parsed;
+	return true;
+}
+
+// 权重序列化为json
+std::string Evaluation::serializeWeights(const FEvalWeights &weights)
+{
+	std::ostringstream out;
+	out << "{\n";
+	for (int i = 0; i < kEvalFeatureNum; ++i)
+	{
+		out << "\t\"" << kFeatureNames[i] << "\": " << weights.values[i] << (i + 1 < kEvalFeatureNum ? ",\n" : "\n");
+	}
+	out << "}";
+	return out.str();
+}
\ No newline at end of file
@@ -0,0 +1,82 @@
+﻿#ifndef __EVALUATION_H__
+#define __EVALUATION_H__
+
+#include <string>
+#include "Position.h"
+
+/**
+ * 评估特征（均为走棋方减去对方）
+ */
+enum FEvalFeature
+{
+	EVAL_MATERIAL,								// 棋子数量
+	EVAL_MOBILITY,								// 可走的步数
+	EVAL_THREAT,								// 下一步可吃掉的对方棋子
+	EVAL_LINE,									// 线上相连的两子（吃子的前提）
+	EVAL_TEMPO,									// 先手
+	kEvalFeatureNum,
+};
+
+static const int kMaxEvalWeight = 1000;		// 单个权重的绝对值上限
+
+/**
+ * 评估权重
+ */
+struct FEvalWeights
+{
+	int values[kEvalFeatureNum];
+
+	FEvalWeights();
+};
+
+/**
+ * 线性评估函数
+ */
+class Evaluation
+{
+public:
+	Evaluation();
+
+public:
+	/**
+	 * 设置权重
+	 */
+	void setWeights(const FEvalWeights &weights);
+
+	/**
+	 * 获取权重
+	 */
+	const FEvalWeights& getWeights() const;
+
+	/**
+	 * 评估局面（走棋方视角）
+	 */
+	int evaluate(const Position &pos) const;
+
+public:
+	/**
+	 * 提取局面特征
+	 */
+	static void extractFeatures(const Position &pos, int features[kEvalFeatureNum]);
+
+	/**
+	 * 获取特征名称（与配置文件中的字段对应）
+	 */
+	static const char* getFeatureName(int feature);
+
+	/**
+	 * 从json解析权重，缺失的字段保持原值
+	 * @return bool 格式错误或权重超出 ±kMaxEvalWeight 时返回 false，权重不变
+	 */
+	static bool parseWeights(const std::string &json, FEvalWeights &weights);
+
+	/**
+	 * 权重序列化为json
+	 */
+	static std::string serializeWeights(const FEvalWeights &weights);
+
+private:
+	FEvalWeights weights_;
+};
+
+#endif
\ No newline at end of file
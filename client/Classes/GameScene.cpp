@@ -1,8 +1,11 @@
 ﻿#include "GameScene.h"
 
+#include <ctime>
+#include <algorithm>
 #include <numeric>
 #include "Language.h"
 #include "VisibleRect.h"
+#include "ReplayScene.h"
 #include "WelcomeScene.h"
 #include "ColorGenerator.h"
 #include "CheckerboardLayer.h"
@@ -13,19 +16,70 @@ enum MenuItemType
 {
 	Restart = 1,
 	GotoMainMenu,
+	Hint,
+	Undo,
+	Replay,
 };
 
+namespace
+{
+	// 提示的搜索限制
+	FSearchLimits HintLimits()
+	{
+		FSearchLimits limits;
+		limits.max_nodes = 200000;
+		limits.max_time_ms = 1000;
+		return limits;
+	}
+
+	// 复盘每一步的搜索限制
+	FSearchLimits ReviewLimits()
+	{
+		FSearchLimits limits;
+		limits.max_nodes = 50000;
+		return limits;
+	}
+
+	// 判定为失误的分差
+	const int kBlunderThreshold = 150;
+
+	// 机器人每帧搜索占帧间隔的比例，剩余时间留给渲染
+	const double kRobotSliceRatio = 0.25;
+
+	// 机器人思考的最长墙钟时间，设备较慢时在此之前以已完成的迭代结果走棋
+	const int kRobotThinkTimeMs = 3000;
+
+	// 机器人每帧的搜索时间预算（微秒）
+	int RobotSliceBudget()
+	{
+		return std::max(static_cast<int>(Director::getInstance()->getAnimationInterval() * 1000000 * kRobotSliceRatio), 1000);
+	}
+}
+
 GameScene::GameScene()
 	: checkerboard_(nullptr)
 	, game_tips_(nullptr)
 	, selected_item_(nullptr)
+	, game_serial_(0)
+	, hint_action_num_(0)
+	, review_serial_(0)
+	, review_pending_(false)
+	, first_chess_type_(FChessPieceType::NONE)
 {
 
 }
 
 GameScene::~GameScene()
 {
-
+	// 等待后台分析结束
+	if (hint_future_.valid())
+	{
+		hint_future_.wait();
+	}
+	if (review_future_.valid())
+	{
+		review_future_.wait();
+	}
 }
 
 Scene* GameScene::createScene()
@@ -44,10 +98,10 @@ bool GameScene::init()
     }
 
 	// 创建菜单
-	std::array<MenuItemType, 2> tags = { Restart, GotoMainMenu };
-	std::array<const char*, 2> menu_texts = { "restart", "mainmenu" };
-	float start_x = VisibleRect::rightBottom().x - kMenuItemWidth * 2 - kMenuItemInterval * 2;
-	for (int i = 0; i < 2; ++i)
+	std::array<MenuItemType, kMenuItemNum> tags = { Replay, Undo, Hint, Restart, GotoMainMenu };
+	std::array<const char*, kMenuItemNum> menu_texts = { "replay", "undo", "hint", "restart", "mainmenu" };
+	float start_x = VisibleRect::rightBottom().x - kMenuItemWidth * kMenuItemNum - kMenuItemInterval * kMenuItemNum;
+	for (int i = 0; i < kMenuItemNum; ++i)
 	{
 		auto menu_item = LayerColor::create();
 		menu_item->setAnchorPoint(Vec2(0.0f, 0.0f));
@@ -68,7 +122,19 @@ bool GameScene::init()
 
 	// 玩家操作图层
 	logic_.reset(new SingleLogic());
-	robot_.reset(new SimpleRobot(logic_.get()));
+	robot_.reset(new SimpleRobot(logic_.get(), time(nullptr)));
+	robot_->setSliceBudget(RobotSliceBudget());
+	FSearchLimits robot_limits = robot_->getSearchLimits();
+	robot_limits.max_time_ms = kRobotThinkTimeMs;
+	robot_->setSearchLimits(robot_limits);
+#if COCOS2D_DEBUG > 0
+	robot_->setSearchLogger([](const FSearchResult &result)
+	{
+		CCLOG("robot search: %s", helper::FormatSearchStats(result.stats).c_str());
+	});
+#endif
+	analyzer_.reset(new Analyzer());
+	loadEvaluator();
 	checkerboard_ = CheckerboardLayer::create(logic_.get());
 	addChild(checkerboard_, 1);
 
@@ -91,13 +157,45 @@ bool GameScene::init()
 	getEventDispatcher()->addEventListenerWithSceneGraphPriority(listener, menu_touch_layer);
 
 	// 监听游戏逻辑
-	logic_->addActionUpdateCallback(std::bind(&GameScene::onBeReady, this));
+	logic_->addActionListener(helper::ActionMask(FActionType::BEREADY) | helper::ActionMask(FActionType::MOVED)
+		| helper::ActionMask(FActionType::GAMEOVER) | helper::ActionMask(FActionType::DRAW)
+		| helper::ActionMask(FActionType::UNDO) | helper::ActionMask(FActionType::REDO),
+		std::bind(&GameScene::onActions, this, std::placeholders::_1));
 	
 	scheduleUpdate();
 
     return true;
 }
 
+// 加载评估函数
+void GameScene::loadEvaluator()
+{
+	Data data = FileUtils::getInstance()->getDataFromFile("config/eval.json");
+	if (!data.isNull())
+	{
+		FEvalWeights weights;
+		if (Evaluation::parseWeights(std::string((const char *)data.getBytes(), data.getSize()), weights))
+		{
+			robot_->setEvalWeights(weights);
+			analyzer_->setEvalWeights(weights);
+		}
+		else
+		{
+			CCLOGERROR("Eval weights parse error!");
+		}
+	}
+
+	// 可选的神经网络评估
+	if (FileUtils::getInstance()->isFileExist("config/nnue.bin"))
+	{
+		Data network = FileUtils::getInstance()->getDataFromFile("config/nnue.bin");
+		if (!robot_->loadNetwork((const char *)network.getBytes(), network.getSize()))
+		{
+			CCLOGERROR("NNUE weights load error!");
+		}
+	}
+}
+
 void GameScene::setGameTips(const std::string &str)
 {
 	game_tips_->setString(str);
@@ -109,15 +207,143 @@ void GameScene::startGame()
 	logic_->ready();
 }
 
-// 准备完毕
-void GameScene::onBeReady()
+// 游戏逻辑动作
+void GameScene::onActions(const FActionSpan &actions)
+{
+	for (const FAction &action : actions)
+	{
+		if (action.type == FActionType::BEREADY)
+		{
+			robot_->reset(logic_->getUpperplayerChesspieceType());
+			checkerboard_->reset(logic_->getBelowplayerChesspieceType());
+
+			// 记录初始局面用于赛后复盘
+			++game_serial_;
+			review_pending_ = false;
+			game_moves_.clear();
+			initial_checkerboard_ = logic_->getCheckerboard();
+			initial_state_ = logic_->saveState();
+			first_chess_type_ = helper::OpponentOf(logic_->getStandbyChesspieceType());
+		}
+		else if (action.type == FActionType::MOVED || action.type == FActionType::REDO)
+		{
+			FMoveTrack track = { action.source, action.target };
+			game_moves_.push_back(track);
+		}
+		else if (action.type == FActionType::UNDO && action.source != FVec2::invalid())
+		{
+			// 悔棋后对局继续，丢弃进行中的复盘
+			++game_serial_;
+			review_pending_ = false;
+			game_moves_.pop_back();
+		}
+		else if (action.type == FActionType::GAMEOVER || action.type == FActionType::DRAW)
+		{
+			review_pending_ = true;
+		}
+	}
+}
+
+// 悔棋，一直退回到轮到玩家走棋
+void GameScene::undoMove()
+{
+	if (!logic_->undo())
+	{
+		return;
+	}
+
+	while (logic_->canUndo() && helper::OpponentOf(logic_->getStandbyChesspieceType()) != logic_->getBelowplayerChesspieceType())
+	{
+		logic_->undo();
+	}
+}
+
+// 请求提示（后台搜索，不阻塞当前帧）
+void GameScene::requestHint()
+{
+	if (hint_future_.valid() || review_future_.valid())
+	{
+		return;
+	}
+
+	FChessPieceType side = helper::OpponentOf(logic_->getStandbyChesspieceType());
+	if (side != logic_->getBelowplayerChesspieceType())
+	{
+		return;
+	}
+
+	hint_action_num_ = logic_->getActionNum();
+	Analyzer *analyzer = analyzer_.get();
+	FChessArray checkerboard = logic_->getCheckerboard();
+	hint_future_ = std::async(std::launch::async, [=]()
+	{
+		return analyzer->analyze(checkerboard, side, 1, HintLimits());
+	});
+}
+
+// 回放本局（暂停当前对局，返回后继续）
+void GameScene::startReplay()
+{
+	if (game_moves_.empty())
+	{
+		return;
+	}
+
+	Scene *scene = ReplayScene::createScene(initial_state_, game_moves_, logic_->getBelowplayerChesspieceType());
+	Director::getInstance()->pushScene(TransitionFade::create(0.5f, scene));
+}
+
+// 开始赛后复盘（后台搜索，不阻塞当前帧）
+void GameScene::startReview()
+{
+	if (game_moves_.empty())
+	{
+		return;
+	}
+
+	review_serial_ = game_serial_;
+	Analyzer *analyzer = analyzer_.get();
+	FChessArray initial = initial_checkerboard_;
+	FChessPieceType first = first_chess_type_;
+	std::vector<FMoveTrack> moves = game_moves_;
+	review_future_ = std::async(std::launch::async, [=]()
+	{
+		analyzer->clear();
+		return analyzer->reviewGame(initial, first, moves, ReviewLimits());
+	});
+}
+
+// 检查后台分析结果
+void GameScene::pollAnalysis()
 {
-	FAction action = logic_->getActionFromQueue(logic_->getActionNum() - 1);
-	if (action.type == FActionType::BEREADY)
+	const std::chrono::seconds zero(0);
+	if (hint_future_.valid() && hint_future_.wait_for(zero) == std::future_status::ready)
 	{
-		robot_->reset(logic_->getUpperplayerChesspieceType());
-		checkerboard_->reset(logic_->getBelowplayerChesspieceType());
-	}	
+		std::vector<FAnalysisLine> lines = hint_future_.get();
+
+		// 局面已经变化时丢弃
+		if (!lines.empty() && hint_action_num_ == logic_->getActionNum())
+		{
+			checkerboard_->showHint(lines.front().move.toMoveTrack());
+		}
+	}
+
+	if (review_future_.valid() && review_future_.wait_for(zero) == std::future_status::ready)
+	{
+		std::vector<FMoveReview> reviews = review_future_.get();
+		if (review_serial_ == game_serial_)
+		{
+			int blunders = Analyzer::countBlunders(reviews, logic_->getBelowplayerChesspieceType(), first_chess_type_, kBlunderThreshold);
+			setGameTips(game_tips_->getString() + "\n" + StringUtils::format(lang("review").c_str(), blunders));
+		}
+	}
+
+	// 分析器同一时间只能执行一个任务，等提示结束后再开始复盘
+	if (review_pending_ && !hint_future_.valid() && !review_future_.valid())
+	{
+		review_pending_ = false;
+		startReview();
+	}
 }
 
 void GameScene::update(float delta)
@@ -125,6 +351,8 @@ void GameScene::update(float delta)
 	if (logic_.get())
 	{
 		logic_->update(delta);
+		robot_->update();
+		pollAnalysis();
 	}
 }
 
@@ -135,7 +363,7 @@ void GameScene::onEnterTransitionDidFinish()
 
 bool GameScene::onTouchBegan(Touch *touch, Event *unused_event)
 {
-	for (int i = Restart; i <= GotoMainMenu; ++i)
+	for (int i = Restart; i <= Replay; ++i)
 	{
 		if (getChildByTag(i)->getBoundingBox().containsPoint(touch->getLocation()))
 		{
@@ -154,7 +382,7 @@ void GameScene::onTouchMoved(Touch *touch, Event *unused_event)
 
 void GameScene::onTouchEnded(Touch *touch, Event *unused_event)
 {
-	for (int i = Restart; i <= GotoMainMenu; ++i)
+	for (int i = Restart; i <= Replay; ++i)
 	{
 		if (getChildByTag(i)->getBoundingBox().containsPoint(touch->getLocation()))
 		{
@@ -167,6 +395,21 @@ void GameScene::onTouchEnded(Touch *touch, Event *unused_event)
 						startGame();
 						break;
 					}
+					case Hint:
+					{
+						requestHint();
+						break;
+					}
+					case Undo:
+					{
+						undoMove();
+						break;
+					}
+					case Replay:
+					{
+						startReplay();
+						break;
+					}
 					case GotoMainMenu:
 					{
 						runAction(Sequence::create(
@@ -1,7 +1,9 @@
 ﻿#ifndef __GAMESCENE_H__
 #define __GAMESCENE_H__
 
+#include <future>
 #include "cocos2d.h"
+#include "Analyzer.h"
 #include "SingleLogic.h"
 #include "SimpleRobot.h"
 
@@ -10,8 +12,9 @@ class CheckerboardLayer;
 class GameScene : public cocos2d::Layer
 {
 	static const int kMenuItemInterval = 5;		// 子菜单间距
-	static const int kMenuItemWidth = 140;		// 子菜单宽度
+	static const int kMenuItemWidth = 118;		// 子菜单宽度
 	static const int kMenuItemHeight = 100;		// 子菜单高度
+	static const int kMenuItemNum = 5;			// 子菜单数量
 
 public:
 	GameScene();
@@ -39,18 +42,41 @@ public:
 private:
 	void startGame();
 
-	void onBeReady();
+	void loadEvaluator();
+
+	void onActions(const FActionSpan &actions);
+
+	void requestHint();
+
+	void undoMove();
+
+	void startReplay();
+
+	void startReview();
+
+	void pollAnalysis();
 
 	virtual void update(float delta) override;
 
 	virtual void onEnterTransitionDidFinish() override;
 
 private:
-	CheckerboardLayer*			checkerboard_;
-	cocos2d::Label*				game_tips_;
-	cocos2d::Node*				selected_item_;
-	std::auto_ptr<SingleLogic>	logic_;
-	std::auto_ptr<SimpleRobot>	robot_;
+	CheckerboardLayer*							checkerboard_;
+	cocos2d::Label*								game_tips_;
+	cocos2d::Node*								selected_item_;
+	std::auto_ptr<SingleLogic>					logic_;
+	std::auto_ptr<SimpleRobot>					robot_;
+	std::auto_ptr<Analyzer>						analyzer_;
+	int											game_serial_;
+	int											hint_action_num_;
+	int											review_serial_;
+	bool										review_pending_;
+	FChessArray									initial_checkerboard_;
+	FGameState									initial_state_;
+	FChessPieceType								first_chess_type_;
+	std::vector<FMoveTrack>						game_moves_;
+	std::future<std::vector<FAnalysisLine>>		hint_future_;
+	std::future<std::vector<FMoveReview>>		review_future_;
 };
 
 #endif
\ No newline at end of file
@@ -1,15 +1,96 @@
 ﻿#include "LogicBase.h"
 #include <cmath>
 #include <cassert>
+#include <algorithm>
+#include "Position.h"
+#include "MoveQueue.h"
+#include "ActionLog.h"
+#include "ActionDispatcher.h"
+#include "json/document.h"
 
 
+namespace
+{
+	const uint16_t kActionTypeMask = 0x0F;
+	const uint16_t kChessTypeShift = 4;
+	const uint16_t kChessTypeMask = 0x03;
+	const uint16_t kSourceValidBit = 0x40;
+	const uint16_t kTargetValidBit = 0x80;
+	const uint16_t kSourceShift = 12;
+	const uint16_t kTargetShift = 8;
+	const uint16_t kSquareMask = 0x0F;
+	const FActionType kLastActionType = FActionType::REDO;
+
+	// 棋盘位置转格子编号，不在棋盘时返回-1
+	int SquareOf(const FVec2 &pos)
+	{
+		bool valid = pos.x >= 0 && pos.y >= 0 && pos.x < kCheckerboardColNum && pos.y < kCheckerboardRowNum;
+		return valid ? pos.y * kCheckerboardColNum + pos.x : -1;
+	}
+
+	FVec2 PositionOf(int square)
+	{
+		return FVec2(square % kCheckerboardColNum, square / kCheckerboardColNum);
+	}
+}
+
+// 压缩动作
+FPackedAction FPackedAction::fromAction(const FAction &action)
+{
+	static_assert(kCheckerboardRowNum * kCheckerboardColNum <= 16, "packed action assumes 4 bits per square");
+	assert(static_cast<int>(action.type) <= kActionTypeMask);
+
+	uint16_t bits = static_cast<uint16_t>(static_cast<int>(action.type) & kActionTypeMask);
+	bits |= static_cast<uint16_t>((action.chess_type & kChessTypeMask) << kChessTypeShift);
+	int source = SquareOf(action.source);
+	int target = SquareOf(action.target);
+	if (source >= 0)
+	{
+		bits |= static_cast<uint16_t>(kSourceValidBit | (source << kSourceShift));
+	}
+	if (target >= 0)
+	{
+		bits |= static_cast<uint16_t>(kTargetValidBit | (target << kTargetShift));
+	}
+
+	FPackedAction packed = { bits };
+	return packed;
+}
+
+// 解压动作
+FAction FPackedAction::toAction() const
+{
+	FAction action;
+	action.type = static_cast<FActionType>(bits & kActionTypeMask);
+	action.chess_type = static_cast<FChessPieceType>((bits >> kChessTypeShift) & kChessTypeMask);
+	action.source = bits & kSourceValidBit ? PositionOf((bits >> kSourceShift) & kSquareMask) : FVec2::invalid();
+	action.target = bits & kTargetValidBit ? PositionOf((bits >> kTargetShift) & kSquareMask) : FVec2::invalid();
+	return action;
+}
+
+// 编码后的字节数
+size_t FPackedAction::getEncodedSize() const
+{
+	return bits & (kSourceValidBit | kTargetValidBit) ? 2 : 1;
+}
+
 LogicBase::LogicBase()
 	: standby_chess_type_(FChessPieceType::BLACK)
+	, move_queue_(new MoveQueue())
+	, action_log_(new ActionLog())
+	, action_dispatcher_(new ActionDispatcher())
+	, dispatch_consumer_(-1)
+	, no_kill_move_num_(0)
+	, no_kill_move_limit_(kDefaultNoKillMoveLimit)
+	, draw_reason_(FDrawReason::NONE)
+	, game_over_(false)
+	, quiet_(false)
 {
 	for (size_t i = 0; i < checkerboard_.size(); ++i)
 	{
 		checkerboard_[i] = FChessPieceType::NONE;
 	}
+	dispatch_consumer_ = action_log_->addConsumer();
 }
 
 LogicBase::~LogicBase()
@@ -20,59 +101,136 @@ LogicBase::~LogicBase()
 // 重置
 void LogicBase::reset()
 {
-	action_queue_.clear();
+	action_log_->clear();
 	standby_chess_type_ = FChessPieceType::BLACK;
 
-	while (!move_queue_.empty())
-	{
-		move_queue_.pop();
-	}
+	cancelMoves();
 
 	for (size_t i = 0; i < checkerboard_.size(); ++i)
 	{
 		checkerboard_[i] = FChessPieceType::NONE;
 	}
+
+	repetition_history_.clear();
+	no_kill_move_num_ = 0;
+	draw_reason_ = FDrawReason::NONE;
+	game_over_ = false;
+	clearHistory();
 }
 
 // 设置棋盘
 void LogicBase::setCheckerboard(const FChessArray &checkerboard)
 {
 	checkerboard_ = checkerboard;
+
+	// 重新开始记录局面
+	repetition_history_.clear();
+	repetition_history_.push(getPositionKey());
+	no_kill_move_num_ = 0;
 }
 
 // 添加移动轨迹
-void LogicBase::addMovetrack(const FMoveTrack &track)
+FMoveTicket LogicBase::addMovetrack(const FMoveTrack &track)
 {
-	move_queue_.push(track);
+	return move_queue_->push(track);
 }
 
-// 获取动作数量
+// 丢弃排队中的走棋
+void LogicBase::cancelMoves()
+{
+	FMoveSubmission submission;
+	while (move_queue_->pop(submission))
+	{
+		FMoveTicket ticket = { submission.ticket };
+		move_queue_->resolve(ticket, FMoveResult::CANCELLED);
+	}
+}
+
+// 保存对局状态
+FGameState LogicBase::saveState() const
+{
+	FGameState state;
+	state.checkerboard = checkerboard_;
+	state.standby_chess_type = standby_chess_type_;
+	state.no_kill_move_num = no_kill_move_num_;
+	state.draw_reason = draw_reason_;
+	state.game_over = game_over_;
+	state.action_num = getActionNum();
+	repetition_history_.save(state.repetition_history);
+	return state;
+}
+
+// 恢复对局状态
+void LogicBase::restoreState(const FGameState &state)
+{
+	cancelMoves();
+	checkerboard_ = state.checkerboard;
+	standby_chess_type_ = state.standby_chess_type;
+	no_kill_move_num_ = state.no_kill_move_num;
+	draw_reason_ = state.draw_reason;
+	game_over_ = state.game_over;
+	repetition_history_.restore(state.repetition_history);
+	clearHistory();
+}
+
+// 查询走棋结果
+FMoveResult LogicBase::getMoveResult(FMoveTicket ticket) const
+{
+	return move_queue_->getResult(ticket);
+}
+
+// 获取累计的动作数量
 size_t LogicBase::getActionNum() const
 {
-	return action_queue_.size();
+	return static_cast<size_t>(action_log_->getTotalNum());
 }
 
-// 取出动作信息
-FAction LogicBase::getActionFromQueue(size_t index)
+// 注册动作消费者
+int LogicBase::addActionConsumer()
 {
-	FAction action;
-	action.type = FActionType::NONE;
-	action.chess_type = FChessPieceType::NONE;
-	if (index < action_queue_.size())
-	{
-		action = action_queue_[index];
-	}
-	return action;
+	return action_log_->addConsumer();
 }
 
-// 添加动作更新通知
-void LogicBase::addActionUpdateCallback(const std::function<void()> &callback)
+// 注销动作消费者
+void LogicBase::removeActionConsumer(int consumer)
 {
-	assert(callback != nullptr);
-	if (callback != nullptr)
-	{
-		action_callback_list_.push_back(callback);
-	}
+	action_log_->removeConsumer(consumer);
+}
+
+// 获取未读动作
+FActionSpan LogicBase::peekActions(int consumer) const
+{
+	return action_log_->peek(consumer);
+}
+
+// 标记动作已读
+void LogicBase::consumeActions(int consumer, size_t count)
+{
+	action_log_->consume(consumer, count);
+}
+
+// 获取消费者的读取位置
+uint64_t LogicBase::getActionCursor(int consumer) const
+{
+	return action_log_->getCursor(consumer);
+}
+
+// 获取并清除消费者的溢出标记
+bool LogicBase::takeActionOverflow(int consumer)
+{
+	return action_log_->takeOverflow(consumer);
+}
+
+// 订阅动作
+int LogicBase::addActionListener(FActionMask mask, const FActionHandler &handler)
+{
+	return action_dispatcher_->addListener(mask, handler);
+}
+
+// 取消订阅
+void LogicBase::removeActionListener(int listener)
+{
+	action_dispatcher_->removeListener(listener);
 }
 
 // 获取棋盘数据
@@ -103,10 +261,15 @@ void LogicBase::addAction(FActionType type, FChessPieceType chess_type, const FV
 	action.source = source;
 	action.target = target;
 	action.chess_type = chess_type;
-	action_queue_.push_back(action);
-	for (auto &func : action_callback_list_)
+	if (!quiet_)
 	{
-		func();
+		action_log_->push(action);
+	}
+
+	// 对局结束后不再接受走棋
+	if (type == FActionType::GAMEOVER || type == FActionType::DRAW)
+	{
+		game_over_ = true;
 	}
 }
 
@@ -137,7 +300,61 @@ FChessPieceType LogicBase::getStandbyChesspieceType() const
 // 是否相邻
 bool LogicBase::isAdjacent(const FVec2 &a, const FVec2 &b) const
 {
-	return isInCheckerboard(a) && isInCheckerboard(a) && (std::abs(a.x + a.y - b.x - b.y) == 1);
+	return isInCheckerboard(a) && isInCheckerboard(b) && std::abs(a.x - b.x) + std::abs(a.y - b.y) == 1;
+}
+
+// 设置连续多少步没有吃子判和
+void LogicBase::setNoKillMoveLimit(int limit)
+{
+	no_kill_move_limit_ = std::min(std::max(limit, 1), kMaxRepetitionHistory - 1);
+}
+
+// 获取连续多少步没有吃子判和
+int LogicBase::getNoKillMoveLimit() const
+{
+	return no_kill_move_limit_;
+}
+
+// 获取连续没有吃子的步数
+int LogicBase::getNoKillMoveNum() const
+{
+	return no_kill_move_num_;
+}
+
+// 获取和棋原因
+FDrawReason LogicBase::getDrawReason() const
+{
+	return draw_reason_;
+}
+
+// 对局是否结束
+bool LogicBase::isGameOver() const
+{
+	return game_over_;
+}
+
+// 当前局面的哈希
+uint64_t LogicBase::getPositionKey() const
+{
+	return Position::fromCheckerboard(checkerboard_, helper::OpponentOf(standby_chess_type_)).getHash();
+}
+
+// 分发未通知的动作
+void LogicBase::dispatchActions()
+{
+	while (action_log_->getPendingNum(dispatch_consumer_) > 0)
+	{
+		// 复制到连续的批次中（日志回绕时分两段），先标记已读再通知，回调中重置逻辑或添加动作都不会影响本批次
+		dispatch_batch_.clear();
+		for (FActionSpan actions = action_log_->peek(dispatch_consumer_); !actions.empty(); actions = action_log_->peek(dispatch_consumer_))
+		{
+			dispatch_batch_.insert(dispatch_batch_.end(), actions.data, actions.data + actions.size());
+			action_log_->consume(dispatch_consumer_, actions.size());
+		}
+
+		FActionSpan batch = { dispatch_batch_.data(), dispatch_batch_.size() };
+		action_dispatcher_->dispatch(batch);
+	}
 }
 
 // 获取所有可行的移动路径
@@ -173,74 +390,262 @@ std::vector<FMoveTrack> LogicBase::getAllMovetrack(FChessPieceType type) const
 	return track_array;
 }
 
-// 更新
-void LogicBase::update(float dt)
+// 校验走棋
+FMoveResult LogicBase::checkMove(const FVec2 &source, const FVec2 &target) const
 {
-	while (!move_queue_.empty())
+	if (!isInCheckerboard(source) || !isInCheckerboard(target))
 	{
-		const FVec2 &source = move_queue_.front().source;
-		const FVec2 &target = move_queue_.front().target;
-
-		if (source != target && isValidChesspiece(source) && !isValidChesspiece(target)
-			&& isAdjacent(source, target) && checkerboard_[target.y  * kCheckerboardRowNum + target.x] != standby_chess_type_)
-		{
-			// 交换数据
-			std::swap(checkerboard_[source.y  * kCheckerboardRowNum + source.x], checkerboard_[target.y  * kCheckerboardRowNum + target.x]);
+		return FMoveResult::OUT_OF_CHECKERBOARD;
+	}
+	if (!isAdjacent(source, target))
+	{
+		return FMoveResult::NOT_ADJACENT;
+	}
+	if (game_over_)
+	{
+		return FMoveResult::GAME_OVER;
+	}
+	if (!isValidChesspiece(source))
+	{
+		return FMoveResult::NO_CHESSPIECE;
+	}
+	if (isValidChesspiece(target))
+	{
+		return FMoveResult::TARGET_OCCUPIED;
+	}
+	// 待机的一方刚走过棋
+	if (getChesspieceType(source) == standby_chess_type_)
+	{
+		return FMoveResult::NOT_YOUR_TURN;
+	}
+	return FMoveResult::ACCEPTED;
+}
 
-			// 新增动作
-			addAction(FActionType::MOVED, checkerboard_[target.y  * kCheckerboardRowNum + target.x], source, target);
+// 执行已校验的走棋
+FMoveDelta LogicBase::applyMove(const FVec2 &source, const FVec2 &target, FActionType move_type)
+{
+	FMoveDelta delta;
+	delta.source = static_cast<uint8_t>(SquareOf(source));
+	delta.target = static_cast<uint8_t>(SquareOf(target));
+	delta.killed = 0;
+	delta.no_kill_move_num = static_cast<uint8_t>(no_kill_move_num_);
+	delta.blocked = 0;
+
+	// 交换数据
+	std::swap(checkerboard_[source.y  * kCheckerboardRowNum + source.x], checkerboard_[target.y  * kCheckerboardRowNum + target.x]);
+
+	// 新增动作
+	addAction(move_type, checkerboard_[target.y  * kCheckerboardRowNum + target.x], source, target);
+
+	// 检测杀棋
+	std::set<FVec2> killed_set = helper::CheckKillChesspiece(checkerboard_, target);
+	for (auto &pos : killed_set)
+	{
+		checkerboard_[pos.y  * kCheckerboardRowNum + pos.x] = FChessPieceType::NONE;
+		delta.killed |= static_cast<uint16_t>(1 << SquareOf(pos));
+		addAction(FActionType::KILLED, FChessPieceType::NONE, target, pos);
+	}
 
-			// 检测杀棋
-			std::set<FVec2> killed_set = helper::CheckKillChesspiece(checkerboard_, target);
-			for (auto &pos : killed_set)
-			{
-				checkerboard_[pos.y  * kCheckerboardRowNum + pos.x] = FChessPieceType::NONE;
-				addAction(FActionType::KILLED, FChessPieceType::NONE, target, pos);
-			}
+	// 是否无棋可用
+	int count = 0;
+	standby_chess_type_ = checkerboard_[target.y  * kCheckerboardRowNum + target.x];
+	auto other_chess_type = standby_chess_type_ == FChessPieceType::WHITE ? FChessPieceType::BLACK : FChessPieceType::WHITE;
 
-			// 是否无棋可用
-			int count = 0;
-			standby_chess_type_ = checkerboard_[target.y  * kCheckerboardRowNum + target.x];
-			auto other_chess_type = standby_chess_type_ == FChessPieceType::WHITE ? FChessPieceType::BLACK : FChessPieceType::WHITE;
-			for (size_t i = 0; i < checkerboard_.size(); ++i)
-			{
-				if (checkerboard_[i] == other_chess_type)
-				{
-					++count;
-				}
-			}
+	// 记录局面，吃子后之前的局面不会再出现（保留一份用于悔棋）
+	if (killed_set.empty())
+	{
+		++no_kill_move_num_;
+	}
+	else
+	{
+		no_kill_move_num_ = 0;
+		killed_histories_.emplace_back();
+		repetition_history_.save(killed_histories_.back());
+		repetition_history_.clear();
+	}
+	int repetitions = repetition_history_.push(getPositionKey());
+	for (size_t i = 0; i < checkerboard_.size(); ++i)
+	{
+		if (checkerboard_[i] == other_chess_type)
+		{
+			++count;
+		}
+	}
 
-			// 游戏是否结束
-			if (count <= 1)
+	// 游戏是否结束
+	if (count <= 1)
+	{
+		addAction(FActionType::GAMEOVER, standby_chess_type_, FVec2::invalid(), FVec2::invalid());
+	}
+	else
+	{
+		// 玩家待机	
+		if (!getAllMovetrack(other_chess_type).empty())
+		{
+			// 重复局面或长时间没有吃子判和
+			draw_reason_ = repetitions >= kRepetitionDrawCount ? FDrawReason::REPETITION
+				: no_kill_move_num_ >= no_kill_move_limit_ ? FDrawReason::MOVE_LIMIT : FDrawReason::NONE;
+			if (draw_reason_ != FDrawReason::NONE)
 			{
-				addAction(FActionType::GAMEOVER, standby_chess_type_, FVec2::invalid(), FVec2::invalid());
+				addAction(FActionType::DRAW, FChessPieceType::NONE, FVec2::invalid(), FVec2::invalid());
 			}
 			else
 			{
-				// 玩家待机	
-				if (!getAllMovetrack(other_chess_type).empty())
-				{
-					addAction(FActionType::STANDBY, standby_chess_type_, FVec2::invalid(), FVec2::invalid());
-				}
-				else
-				{
-					// 山穷水尽
-					addAction(FActionType::GAMEOVER, standby_chess_type_, FVec2::invalid(), FVec2::invalid());
-					for (size_t i = 0; i < checkerboard_.size(); ++i)
-					{
-						if (checkerboard_[i] == other_chess_type)
-						{
-							int row = i / kCheckerboardColNum;
-							int col = i % kCheckerboardColNum;
-							addAction(FActionType::KILLED, FChessPieceType::NONE, FVec2::invalid(), FVec2(col, row));
-						}
-					}
-				}
+				addAction(FActionType::STANDBY, standby_chess_type_, FVec2::invalid(), FVec2::invalid());
 			}
 		}
+		else
+		{
+			// 山穷水尽
+			delta.blocked = 1;
+			addAction(FActionType::GAMEOVER, standby_chess_type_, FVec2::invalid(), FVec2::invalid());
+			addBlockedActions();
+		}
+	}
+
+	return delta;
+}
+
+// 对手无棋可走时产生剩余棋子被吃掉的动作
+bool LogicBase::addBlockedActions()
+{
+	const FChessPieceType other_chess_type = helper::OpponentOf(standby_chess_type_);
+	if (std::count(checkerboard_.begin(), checkerboard_.end(), other_chess_type) <= 1 || !getAllMovetrack(other_chess_type).empty())
+	{
+		return false;
+	}
+
+	for (size_t i = 0; i < checkerboard_.size(); ++i)
+	{
+		if (checkerboard_[i] == other_chess_type)
+		{
+			int row = i / kCheckerboardColNum;
+			int col = i % kCheckerboardColNum;
+			addAction(FActionType::KILLED, FChessPieceType::NONE, FVec2::invalid(), FVec2(col, row));
+		}
+	}
+	return true;
+}
 
-		move_queue_.pop();
+// 立即执行走棋
+FMoveResult LogicBase::playMove(const FVec2 &source, const FVec2 &target, bool quiet)
+{
+	FMoveResult result = checkMove(source, target);
+	if (result == FMoveResult::ACCEPTED)
+	{
+		// 新的走棋之后不能再重做
+		quiet_ = quiet;
+		undo_history_.push_back(applyMove(source, target, FActionType::MOVED));
+		redo_history_.clear();
+		quiet_ = false;
 	}
+	return result;
+}
+
+// 悔一步棋
+bool LogicBase::undo()
+{
+	if (undo_history_.empty())
+	{
+		return false;
+	}
+
+	cancelMoves();
+	const FMoveDelta delta = undo_history_.back();
+	undo_history_.pop_back();
+	redo_history_.push_back(delta);
+
+	// 棋子退回
+	const FVec2 source = PositionOf(delta.source);
+	const FVec2 target = PositionOf(delta.target);
+	const FChessPieceType mover = checkerboard_[delta.target];
+	const FChessPieceType victim = mover == FChessPieceType::WHITE ? FChessPieceType::BLACK : FChessPieceType::WHITE;
+	std::swap(checkerboard_[delta.source], checkerboard_[delta.target]);
+	addAction(FActionType::UNDO, mover, target, source);
+
+	// 被吃掉的棋子复活，无棋可走时界面上被吃掉的棋子也要恢复
+	for (int square = 0; square < static_cast<int>(checkerboard_.size()); ++square)
+	{
+		if (delta.killed & (1 << square))
+		{
+			checkerboard_[square] = victim;
+			addAction(FActionType::UNDO, victim, FVec2::invalid(), PositionOf(square));
+		}
+		else if (delta.blocked && checkerboard_[square] == victim)
+		{
+			addAction(FActionType::UNDO, victim, FVec2::invalid(), PositionOf(square));
+		}
+	}
+
+	// 恢复局面记录
+	if (delta.killed != 0)
+	{
+		assert(!killed_histories_.empty());
+		repetition_history_.restore(killed_histories_.back());
+		killed_histories_.pop_back();
+	}
+	else
+	{
+		repetition_history_.pop();
+	}
+	no_kill_move_num_ = delta.no_kill_move_num;
+	draw_reason_ = FDrawReason::NONE;
+	game_over_ = false;
+
+	// 轮到走棋方重新走
+	standby_chess_type_ = victim;
+	addAction(FActionType::STANDBY, standby_chess_type_, FVec2::invalid(), FVec2::invalid());
+	return true;
+}
+
+// 重做悔掉的一步棋
+bool LogicBase::redo()
+{
+	if (redo_history_.empty())
+	{
+		return false;
+	}
+
+	cancelMoves();
+	const FMoveDelta delta = redo_history_.back();
+	redo_history_.pop_back();
+	undo_history_.push_back(applyMove(PositionOf(delta.source), PositionOf(delta.target), FActionType::REDO));
+	return true;
+}
+
+// 是否可以悔棋
+bool LogicBase::canUndo() const
+{
+	return !undo_history_.empty();
+}
+
+// 是否可以重做
+bool LogicBase::canRedo() const
+{
+	return !redo_history_.empty();
+}
+
+// 清空悔棋记录
+void LogicBase::clearHistory()
+{
+	undo_history_.clear();
+	redo_history_.clear();
+	killed_histories_.clear();
+}
+
+// 更新
+void LogicBase::update(float dt)
+{
+	FMoveSubmission submission;
+	while (move_queue_->pop(submission))
+	{
+		const FVec2 &source = submission.track.source;
+		const FVec2 &target = submission.track.target;
+		const FMoveTicket ticket = { submission.ticket };
+		move_queue_->resolve(ticket, playMove(source, target, false));
+	}
+
+	dispatchActions();
 }
 
 namespace helper
@@ -359,4 +764,59 @@ namespace helper
 		horizontal_set.insert(vertical_set.begin(), vertical_set.end());
 		return horizontal_set;
 	}
+
+	// 把动作编码追加到数据流
+	size_t EncodeAction(const FAction &action, std::vector<uint8_t> &stream)
+	{
+		FPackedAction packed = FPackedAction::fromAction(action);
+		size_t size = packed.getEncodedSize();
+		stream.push_back(static_cast<uint8_t>(packed.bits & 0xFF));
+		if (size == 2)
+		{
+			stream.push_back(static_cast<uint8_t>(packed.bits >> 8));
+		}
+		return size;
+	}
+
+	// 从数据流解码一个动作
+	size_t DecodeAction(const uint8_t *data, size_t size, FAction &action)
+	{
+		if (size == 0 || (data[0] & kActionTypeMask) > static_cast<int>(kLastActionType)
+			|| ((data[0] >> kChessTypeShift) & kChessTypeMask) > FChessPieceType::BLACK)
+		{
+			return 0;
+		}
+
+		FPackedAction packed = { data[0] };
+		size_t length = packed.getEncodedSize();
+		if (length > size)
+		{
+			return 0;
+		}
+		if (length == 2)
+		{
+			packed.bits |= static_cast<uint16_t>(data[1] << 8);
+		}
+		action = packed.toAction();
+		return length;
+	}
+
+	// 解析棋盘配置
+	bool ParseCheckerboard(const std::string &json, FChessArray &checkerboard)
+	{
+		rapidjson::Document doc;
+		doc.Parse<0>(json.c_str());
+		if (doc.HasParseError() || !doc.IsArray() || doc.Size() != checkerboard.size())
+		{
+			return false;
+		}
+
+		for (size_t i = 0; i < doc.Size(); ++i)
+		{
+			int row = i / kCheckerboardColNum;
+			int col = i % kCheckerboardColNum;
+			checkerboard[row * kCheckerboardRowNum + col] = static_cast<FChessPieceType>(doc[doc.Size() - i - 1].GetInt());
+		}
+		return true;
+	}
 }
\ No newline at end of file
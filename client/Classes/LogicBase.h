@@ -3,9 +3,14 @@
 
 #include <set>
 #include <array>
-#include <queue>
+#include <string>
+#include <vector>
+#include <memory>
+#include <cstddef>
+#include <cstdint>
 #include <numeric>
 #include <functional>
+#include "RepetitionHistory.h"
 
 /**
  * 棋子类型枚举
@@ -29,6 +34,56 @@ enum class FActionType
 	KILLED,										// 杀棋
 	STANDBY,									// 待机
 	GAMEOVER,									// 游戏结束
+	DRAW,										// 和棋
+	UNDO,										// 悔棋（有来源位置时为棋子退回，否则为被吃掉的棋子复活）
+	REDO,										// 重做（之后与正常走棋一样跟随杀棋、待机等动作）
+};
+
+/**
+ * 和棋原因
+ */
+enum class FDrawReason
+{
+	NONE,
+	REPETITION,									// 同一局面出现三次
+	MOVE_LIMIT,									// 连续多步没有吃子
+};
+
+/**
+ * 走棋结果
+ */
+enum class FMoveResult
+{
+	PENDING,									// 排队中
+	ACCEPTED,									// 已执行
+	QUEUE_FULL,									// 队列已满
+	OUT_OF_CHECKERBOARD,						// 不在棋盘内
+	NOT_ADJACENT,								// 不是相邻的格子
+	NO_CHESSPIECE,								// 来源位置没有棋子
+	TARGET_OCCUPIED,							// 目标位置已有棋子
+	NOT_YOUR_TURN,								// 不是该棋子的回合
+	GAME_OVER,									// 对局已结束
+	CANCELLED,									// 重新开始时丢弃
+	EXPIRED,									// 票据无效或结果已被覆盖
+};
+
+/**
+ * 走棋票据，提交走棋后用于查询结果
+ */
+struct FMoveTicket
+{
+	uint64_t id;
+
+	static FMoveTicket invalid()
+	{
+		FMoveTicket ticket = { 0 };
+		return ticket;
+	}
+
+	bool isValid() const
+	{
+		return id != 0;
+	}
 };
 
 /**
@@ -88,11 +143,101 @@ struct FAction
 	FVec2			target;						// 目标位置
 };
 
+/**
+ * 压缩的动作（2字节）
+ * 低字节：低4位动作类型，2位棋子类型，来源位置是否有效，目标位置是否有效
+ * 高字节：高4位来源格子，低4位目标格子
+ * 没有位置的动作只用到低字节，写入数据流时只占1字节
+ */
+struct FPackedAction
+{
+	uint16_t bits;
+
+	static FPackedAction fromAction(const FAction &action);
+
+	FAction toAction() const;
+
+	/**
+	 * 编码后的字节数（1或2）
+	 */
+	size_t getEncodedSize() const;
+};
+
+/**
+ * 动作的连续视图（指向动作日志内部，不复制，添加新动作前有效）
+ * 元素按值解压，遍历时使用 const FAction & 或 FAction 接收
+ */
+struct FActionSpan
+{
+	struct FIterator
+	{
+		const FPackedAction* ptr;
+
+		FAction operator* () const { return ptr->toAction(); }
+		FIterator& operator++ () { ++ptr; return *this; }
+		bool operator!= (const FIterator &that) const { return ptr != that.ptr; }
+	};
+
+	const FPackedAction*	data;
+	size_t					count;
+
+	FIterator begin() const { FIterator itr = { data }; return itr; }
+	FIterator end() const { FIterator itr = { data + count }; return itr; }
+	size_t size() const { return count; }
+	bool empty() const { return count == 0; }
+	FAction operator[] (size_t index) const { return data[index].toAction(); }
+};
+
+/**
+ * 动作类型掩码，每种动作类型占一位
+ */
+typedef uint32_t FActionMask;
+
+static const FActionMask kAllActionMask = 0xFFFFFFFF;
+
+/**
+ * 动作订阅回调，参数为本次更新产生的一批连续动作
+ */
+typedef std::function<void(const FActionSpan &)> FActionHandler;
+
+class MoveQueue;
+class ActionLog;
+class ActionDispatcher;
+
 static const int kCheckerboardRowNum = 4;		// 棋盘行数
 static const int kCheckerboardColNum = 4;		// 棋盘列数
+static const int kRepetitionDrawCount = 3;		// 同一局面出现几次判和
+static const int kDefaultNoKillMoveLimit = 100;	// 默认连续多少步没有吃子判和
 
 typedef std::array<FChessPieceType, kCheckerboardRowNum * kCheckerboardColNum> FChessArray;
 
+/**
+ * 走棋记录（6字节），悔棋和重做都不需要从头重放
+ */
+struct FMoveDelta
+{
+	uint8_t		source;							// 来源格子
+	uint8_t		target;							// 目标格子
+	uint16_t	killed;							// 被吃掉的棋子（格子位掩码）
+	uint8_t		no_kill_move_num;				// 走棋前连续没有吃子的步数
+	uint8_t		blocked;						// 走棋后对方无棋可走（对方剩余的棋子在界面上被吃掉）
+};
+
+/**
+ * 对局状态快照
+ * 固定大小、可以直接按值复制（约2KB），局面重复历史只保存哈希栈，恢复时重建计数表
+ */
+struct FGameState
+{
+	FChessArray			checkerboard;			// 棋盘
+	FChessPieceType		standby_chess_type;		// 待机棋子类型（刚走过棋的一方）
+	int					no_kill_move_num;		// 连续没有吃子的步数
+	FDrawReason			draw_reason;			// 和棋原因
+	bool				game_over;				// 对局是否结束
+	uint64_t			action_num;				// 快照时的动作日志位置（只用于标识，例如服务器按它重新同步消费者，恢复时不使用）
+	FRepetitionSnapshot	repetition_history;		// 局面重复历史
+};
+
 class LogicBase
 {
 public:
@@ -116,25 +261,65 @@ public:
 	virtual FChessPieceType getBelowplayerChesspieceType() const = 0;
 
 	/**
-	 * 移动棋子
+	 * 移动棋子（可以在任意线程调用）
+	 * @return FMoveTicket 走棋票据，update 中校验后得到结果
+	 */
+	virtual FMoveTicket moveChesspiece(const FVec2 &source, const FVec2 &target) = 0;
+
+	/**
+	 * 查询走棋结果（可以在任意线程调用）
 	 */
-	virtual void moveChesspiece(const FVec2 &source, const FVec2 &target) = 0;
+	FMoveResult getMoveResult(FMoveTicket ticket) const;
 
 public:
 	/**
-	 * 获取动作数量
+	 * 获取累计的动作数量
 	 */
 	size_t getActionNum() const;
 
 	/**
-	 * 获取动作信息
+	 * 注册动作消费者，从当前位置开始读取
+	 * @return int 消费者编号
+	 */
+	int addActionConsumer();
+
+	/**
+	 * 注销动作消费者
+	 */
+	void removeActionConsumer(int consumer);
+
+	/**
+	 * 获取未读动作（连续视图，回绕时分两次返回）
+	 */
+	FActionSpan peekActions(int consumer) const;
+
+	/**
+	 * 标记动作已读，所有消费者都读过的动作即被释放
+	 */
+	void consumeActions(int consumer, size_t count);
+
+	/**
+	 * 获取消费者的读取位置（与 getActionNum 同一计数，重置时跳到末尾）
+	 */
+	uint64_t getActionCursor(int consumer) const;
+
+	/**
+	 * 获取并清除消费者的溢出标记，为真时有未读动作被覆盖，需要按当前局面重新同步
 	 */
-	FAction getActionFromQueue(size_t index);
+	bool takeActionOverflow(int consumer);
 
 	/**
-	 * 添加动作更新回调
+	 * 订阅动作，批次中包含掩码中的动作类型时才回调
+	 * 动作不在产生时通知，而是在 update 结束时把本次产生的动作作为一批分发，每个订阅者每次更新最多回调一次；
+	 * 回调中走棋只会进入队列，下一次 update 才处理
+	 * @return int 订阅者编号
 	 */
-	void addActionUpdateCallback(const std::function<void()> &callback);
+	int addActionListener(FActionMask mask, const FActionHandler &handler);
+
+	/**
+	 * 取消订阅
+	 */
+	void removeActionListener(int listener);
 
 	/**
 	 * 获取棋盘数据
@@ -172,7 +357,64 @@ public:
 	bool isAdjacent(const FVec2 &a, const FVec2 &b) const;
 
 	/**
-	 * 更新
+	 * 设置连续多少步没有吃子判和（不超过 kMaxRepetitionHistory - 1）
+	 */
+	void setNoKillMoveLimit(int limit);
+
+	/**
+	 * 获取连续多少步没有吃子判和
+	 */
+	int getNoKillMoveLimit() const;
+
+	/**
+	 * 获取连续没有吃子的步数
+	 */
+	int getNoKillMoveNum() const;
+
+	/**
+	 * 获取和棋原因（未和棋时为 NONE）
+	 */
+	FDrawReason getDrawReason() const;
+
+	/**
+	 * 对局是否结束
+	 */
+	bool isGameOver() const;
+
+	/**
+	 * 保存对局状态
+	 */
+	FGameState saveState() const;
+
+	/**
+	 * 恢复对局状态，丢弃排队中的走棋和悔棋记录；不产生动作，由调用者决定如何通知（例如重新开始时添加 START）
+	 */
+	void restoreState(const FGameState &state);
+
+	/**
+	 * 悔一步棋（只在逻辑线程调用），丢弃排队中的走棋，产生 UNDO 和 STANDBY 动作
+	 * @return bool 没有可以悔的棋时返回 false
+	 */
+	bool undo();
+
+	/**
+	 * 重做悔掉的一步棋（只在逻辑线程调用），有新的走棋后不能再重做
+	 * @return bool 没有可以重做的棋时返回 false
+	 */
+	bool redo();
+
+	/**
+	 * 是否可以悔棋
+	 */
+	bool canUndo() const;
+
+	/**
+	 * 是否可以重做
+	 */
+	bool canRedo() const;
+
+	/**
+	 * 更新（校验并执行排队的走棋，然后分发产生的动作），只在逻辑线程调用
 	 */
 	void update(float dt);
 
@@ -192,31 +434,93 @@ protected:
 	void setCheckerboard(const FChessArray &checkerboard);
 
 	/**
-	 * 添加移动轨迹
+	 * 添加移动轨迹（无锁，可以在任意线程调用）
 	 */
-	void addMovetrack(const FMoveTrack &track);
+	FMoveTicket addMovetrack(const FMoveTrack &track);
 
 	/**
 	 * 添加动作
 	 */
 	void addAction(FActionType type, FChessPieceType chess_type, const FVec2 &source, const FVec2 &target);
 
+	/**
+	 * 待机方的对手剩余多于一个棋子但无棋可走时，产生这些棋子被吃掉的动作（界面上移除，棋盘数据保留用于悔棋）
+	 * @return bool 对手是否无棋可走
+	 */
+	bool addBlockedActions();
+
+	/**
+	 * 立即校验并执行走棋（不经过走棋队列），只在逻辑线程调用
+	 * @param bool 静默执行，不产生动作（跳转、快进时使用）
+	 */
+	FMoveResult playMove(const FVec2 &source, const FVec2 &target, bool quiet);
+
 private:
 	/**
 	 * 获取所有可行的移动路径
 	 */
 	std::vector<FMoveTrack> getAllMovetrack(FChessPieceType type) const;
 
+	/**
+	 * 校验走棋
+	 */
+	FMoveResult checkMove(const FVec2 &source, const FVec2 &target) const;
+
+	/**
+	 * 丢弃排队中的走棋
+	 */
+	void cancelMoves();
+
+	/**
+	 * 清空悔棋记录
+	 */
+	void clearHistory();
+
+	/**
+	 * 执行已校验的走棋，产生动作（走棋动作类型为 MOVED 或 REDO）
+	 * @return FMoveDelta 走棋记录
+	 */
+	FMoveDelta applyMove(const FVec2 &source, const FVec2 &target, FActionType move_type);
+
+	/**
+	 * 当前局面（棋盘和走棋方）的哈希
+	 */
+	uint64_t getPositionKey() const;
+
+	/**
+	 * 分发未通知的动作（单层循环，回调中产生的动作作为下一批继续分发）
+	 */
+	void dispatchActions();
+
 private:
 	FChessPieceType							standby_chess_type_;
-	std::queue<FMoveTrack>					move_queue_;
-	std::vector<FAction>					action_queue_;
+	std::unique_ptr<MoveQueue>				move_queue_;
+	std::unique_ptr<ActionLog>				action_log_;
+	std::unique_ptr<ActionDispatcher>		action_dispatcher_;
+	int										dispatch_consumer_;
+	std::vector<FPackedAction>				dispatch_batch_;
 	FChessArray								checkerboard_;
-	std::vector< std::function<void()> >	action_callback_list_;
+	RepetitionHistory						repetition_history_;
+	int										no_kill_move_num_;
+	int										no_kill_move_limit_;
+	FDrawReason								draw_reason_;
+	bool									game_over_;
+	bool									quiet_;
+	std::vector<FMoveDelta>					undo_history_;
+	std::vector<FMoveDelta>					redo_history_;
+	std::vector<FRepetitionSnapshot>		killed_histories_;	// 吃子前的局面重复历史，悔掉吃子时恢复
 };
 
 namespace helper
 {
+	/**
+	 * 动作类型对应的掩码
+	 */
+	inline FActionMask ActionMask(FActionType type)
+	{
+		return static_cast<FActionMask>(1) << static_cast<int>(type);
+	}
+
 	/**
 	 * 获取横向相连的棋子
 	 * @param FChessArray 棋牌信息
@@ -246,6 +550,26 @@ namespace helper
 	 * @param FVec2 移动过的棋子的位置
 	 */
 	std::set<FVec2> CheckKillChesspiece(const FChessArray &checkerboard, const FVec2 &pos);
+
+	/**
+	 * 把动作编码追加到数据流（1~2字节）
+	 * @return size_t 写入的字节数
+	 */
+	size_t EncodeAction(const FAction &action, std::vector<uint8_t> &stream);
+
+	/**
+	 * 从数据流解码一个动作
+	 * @return size_t 读取的字节数，数据不完整或无效时返回0
+	 */
+	size_t DecodeAction(const uint8_t *data, size_t size, FAction &action);
+
+	/**
+	 * 解析棋盘配置（config/init.json 格式）
+	 * @param std::string json文本
+	 * @param FChessArray 棋牌信息
+	 * @return bool 是否解析成功
+	 */
+	bool ParseCheckerboard(const std::string &json, FChessArray &checkerboard);
 }
 
 #endif
\ No newline at end of file
@@ -0,0 +1,103 @@
+﻿#include "MoveQueue.h"
+
+
+namespace
+{
+	const uint64_t kResultBits = 8;
+	const uint64_t kResultMask = (1 << kResultBits) - 1;
+}
+
+MoveQueue::MoveQueue()
+	: enqueue_pos_(0)
+	, dequeue_pos_(0)
+	, next_ticket_(1)
+{
+	for (size_t i = 0; i < kMoveQueueCapacity; ++i)
+	{
+		cells_[i].sequence.store(i, std::memory_order_relaxed);
+	}
+	for (size_t i = 0; i < kMoveResultCapacity; ++i)
+	{
+		results_[i].store(0, std::memory_order_relaxed);
+	}
+}
+
+// 提交走棋
+FMoveTicket MoveQueue::push(const FMoveTrack &track)
+{
+	FMoveTicket ticket = { next_ticket_.fetch_add(1, std::memory_order_relaxed) };
+	resolve(ticket, FMoveResult::PENDING);
+
+	uint64_t pos = enqueue_pos_.load(std::memory_order_relaxed);
+	FCell *cell = nullptr;
+	for (;;)
+	{
+		cell = &cells_[pos & (kMoveQueueCapacity - 1)];
+		uint64_t sequence = cell->sequence.load(std::memory_order_acquire);
+		int64_t diff = static_cast<int64_t>(sequence) - static_cast<int64_t>(pos);
+		if (diff == 0)
+		{
+			// 格子空闲，抢占写入位置
+			if (enqueue_pos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+			{
+				break;
+			}
+		}
+		else if (diff < 0)
+		{
+			// 消费者还没有取走上一圈的走棋
+			resolve(ticket, FMoveResult::QUEUE_FULL);
+			return ticket;
+		}
+		else
+		{
+			pos = enqueue_pos_.load(std::memory_order_relaxed);
+		}
+	}
+
+	cell->submission.ticket = ticket.id;
+	cell->submission.track = track;
+	cell->sequence.store(pos + 1, std::memory_order_release);
+	return ticket;
+}
+
+// 取出最早的走棋
+bool MoveQueue::pop(FMoveSubmission &submission)
+{
+	FCell &cell = cells_[dequeue_pos_ & (kMoveQueueCapacity - 1)];
+	if (cell.sequence.load(std::memory_order_acquire) != dequeue_pos_ + 1)
+	{
+		return false;
+	}
+
+	submission = cell.submission;
+	cell.sequence.store(dequeue_pos_ + kMoveQueueCapacity, std::memory_order_release);
+	++dequeue_pos_;
+	return true;
+}
+
+// 记录走棋结果
+void MoveQueue::resolve(FMoveTicket ticket, FMoveResult result)
+{
+	uint64_t value = (ticket.id << kResultBits) | static_cast<uint64_t>(result);
+	results_[ticket.id & (kMoveResultCapacity - 1)].store(value, std::memory_order_release);
+}
+
+// 查询走棋结果
+FMoveResult MoveQueue::getResult(FMoveTicket ticket) const
+{
+	if (!ticket.isValid())
+	{
+		return FMoveResult::EXPIRED;
+	}
+
+	uint64_t value = results_[ticket.id & (kMoveResultCapacity - 1)].load(std::memory_order_acquire);
+	uint64_t id = value >> kResultBits;
+	if (id == ticket.id)
+	{
+		return static_cast<FMoveResult>(value & kResultMask);
+	}
+
+	// 还没有写入（提交线程尚未记录）视为等待中，已被更新的票据覆盖则结果过期
+	return id < ticket.id ? FMoveResult::PENDING : FMoveResult::EXPIRED;
+}
@@ -0,0 +1,73 @@
+﻿#ifndef __MOVEQUEUE_H__
+#define __MOVEQUEUE_H__
+
+#include <atomic>
+#include <cstdint>
+#include "LogicBase.h"
+
+static const size_t kMoveQueueCapacity = 64;		// 最多排队的走棋数（2的幂）
+static const size_t kMoveResultCapacity = 1024;		// 最多保留的走棋结果（2的幂）
+
+/**
+ * 排队的走棋
+ */
+struct FMoveSubmission
+{
+	uint64_t	ticket;
+	FMoveTrack	track;
+};
+
+/**
+ * 多生产者单消费者的走棋队列
+ * 固定容量的环形数组，每个格子带序号（Vyukov 有界队列），界面、机器人线程、网络线程都可以无锁提交，
+ * 只有逻辑线程在 update 中取出；走棋结果按票据编号写入另一个环形数组，任何线程都可以无锁查询。
+ */
+class MoveQueue
+{
+public:
+	MoveQueue();
+
+public:
+	/**
+	 * 分配票据并提交走棋（任意线程），队列已满时票据直接记为 QUEUE_FULL
+	 */
+	FMoveTicket push(const FMoveTrack &track);
+
+	/**
+	 * 取出最早的走棋（仅逻辑线程）
+	 */
+	bool pop(FMoveSubmission &submission);
+
+	/**
+	 * 记录走棋结果
+	 */
+	void resolve(FMoveTicket ticket, FMoveResult result);
+
+	/**
+	 * 查询走棋结果（任意线程）
+	 */
+	FMoveResult getResult(FMoveTicket ticket) const;
+
+private:
+	/**
+	 * 队列格子，序号等于写入位置时可写，等于写入位置+1时可读
+	 */
+	struct FCell
+	{
+		std::atomic<uint64_t>	sequence;
+		FMoveSubmission			submission;
+	};
+
+private:
+	MoveQueue(const MoveQueue &) = delete;
+	MoveQueue& operator= (const MoveQueue &) = delete;
+
+private:
+	FCell					cells_[kMoveQueueCapacity];
+	std::atomic<uint64_t>	enqueue_pos_;
+	uint64_t				dequeue_pos_;
+	std::atomic<uint64_t>	next_ticket_;
+	std::atomic<uint64_t>	results_[kMoveResultCapacity];		// 票据编号 << 8 | 结果
+};
+
+#endif
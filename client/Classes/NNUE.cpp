@@ -0,0 +1,266 @@
+﻿#include "NNUE.h"
+#include <cstring>
+#include <cassert>
+
+#if defined(__SSSE3__)
+#include <tmmintrin.h>
+#define NNUE_USE_SSSE3 1
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define NNUE_USE_SSE2 1
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define NNUE_USE_NEON 1
+#endif
+
+
+namespace
+{
+	// 第二层输出右移位数
+	const int kL2Shift = 6;
+
+	// 输出层缩放
+	const int kOutputScale = 16;
+
+	// 截断激活的上限
+	const int kActivationMax = 127;
+
+	// 特征索引（黑棋视角上下翻转棋盘，两个视角共享权重）
+	inline int FeatureIndex(int perspective, int color, int square)
+	{
+		return (color == perspective ? 0 : kSquareNum) + (perspective == 0 ? square : square ^ 0xC);
+	}
+
+	inline int ColorIndex(FChessPieceType type)
+	{
+		return type == FChessPieceType::WHITE ? 0 : 1;
+	}
+
+	inline int16_t ClippedRelu(int value)
+	{
+		return static_cast<int16_t>(value < 0 ? 0 : value > kActivationMax ? kActivationMax : value);
+	}
+
+	inline void AddFeature(int16_t *values, const int16_t *weights)
+	{
+		for (int i = 0; i < kNNUEL1Num; ++i)
+		{
+			values[i] += weights[i];
+		}
+	}
+
+	inline void SubFeature(int16_t *values, const int16_t *weights)
+	{
+		for (int i = 0; i < kNNUEL1Num; ++i)
+		{
+			values[i] -= weights[i];
+		}
+	}
+
+	// uint8 激活与 int8 权重点积
+	inline int32_t DotProduct(const uint8_t *input, const int8_t *weights)
+	{
+		const int size = 2 * kNNUEL1Num;
+#if NNUE_USE_SSSE3
+		const __m128i ones = _mm_set1_epi16(1);
+		__m128i sum = _mm_setzero_si128();
+		for (int i = 0; i < size; i += 16)
+		{
+			__m128i a = _mm_load_si128(reinterpret_cast<const __m128i *>(input + i));
+			__m128i w = _mm_load_si128(reinterpret_cast<const __m128i *>(weights + i));
+			sum = _mm_add_epi32(sum, _mm_madd_epi16(_mm_maddubs_epi16(a, w), ones));
+		}
+		sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(1, 0, 3, 2)));
+		sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(2, 3, 0, 1)));
+		return _mm_cvtsi128_si32(sum);
+#elif NNUE_USE_SSE2
+		const __m128i zero = _mm_setzero_si128();
+		__m128i sum = _mm_setzero_si128();
+		for (int i = 0; i < size; i += 16)
+		{
+			__m128i a = _mm_load_si128(reinterpret_cast<const __m128i *>(input + i));
+			__m128i w = _mm_load_si128(reinterpret_cast<const __m128i *>(weights + i));
+			__m128i a_lo = _mm_unpacklo_epi8(a, zero);
+			__m128i a_hi = _mm_unpackhi_epi8(a, zero);
+			__m128i w_lo = _mm_srai_epi16(_mm_unpacklo_epi8(w, w), 8);
+			__m128i w_hi = _mm_srai_epi16(_mm_unpackhi_epi8(w, w), 8);
+			sum = _mm_add_epi32(sum, _mm_madd_epi16(a_lo, w_lo));
+			sum = _mm_add_epi32(sum, _mm_madd_epi16(a_hi, w_hi));
+		}
+		sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(1, 0, 3, 2)));
+		sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(2, 3, 0, 1)));
+		return _mm_cvtsi128_si32(sum);
+#elif NNUE_USE_NEON
+		int32x4_t sum = vdupq_n_s32(0);
+		for (int i = 0; i < size; i += 16)
+		{
+			int8x16_t a = vreinterpretq_s8_u8(vld1q_u8(input + i));
+			int8x16_t w = vld1q_s8(weights + i);
+			int16x8_t product = vmull_s8(vget_low_s8(a), vget_low_s8(w));
+			product = vmlal_s8(product, vget_high_s8(a), vget_high_s8(w));
+			sum = vpadalq_s16(sum, product);
+		}
+		return vgetq_lane_s32(sum, 0) + vgetq_lane_s32(sum, 1) + vgetq_lane_s32(sum, 2) + vgetq_lane_s32(sum, 3);
+#else
+		int32_t sum = 0;
+		for (int i = 0; i < size; ++i)
+		{
+			sum += static_cast<int32_t>(input[i]) * weights[i];
+		}
+		return sum;
+#endif
+	}
+
+	template <typename T>
+	void WriteValue(std::vector<char> &out, const T &value)
+	{
+		const char *bytes = reinterpret_cast<const char *>(&value);
+		out.insert(out.end(), bytes, bytes + sizeof(T));
+	}
+}
+
+NNUENetwork::NNUENetwork()
+	: out_bias_(0)
+{
+	memset(l1_weights_, 0, sizeof(l1_weights_));
+	memset(l1_bias_, 0, sizeof(l1_bias_));
+	memset(l2_weights_, 0, sizeof(l2_weights_));
+	memset(l2_bias_, 0, sizeof(l2_bias_));
+	memset(out_weights_, 0, sizeof(out_weights_));
+}
+
+// 从内存加载权重
+bool NNUENetwork::load(const char *data, size_t size)
+{
+	const size_t expected = sizeof(kNNUEFileMagic) + sizeof(uint32_t) + sizeof(l1_weights_) + sizeof(l1_bias_)
+		+ sizeof(l2_weights_) + sizeof(l2_bias_) + sizeof(out_weights_) + sizeof(out_bias_);
+	if (data == nullptr || size != expected || memcmp(data, kNNUEFileMagic, sizeof(kNNUEFileMagic)) != 0)
+	{
+		return false;
+	}
+
+	uint32_t version = 0;
+	const char *ptr = data + sizeof(kNNUEFileMagic);
+	memcpy(&version, ptr, sizeof(version));
+	if (version != kNNUEFileVersion)
+	{
+		return false;
+	}
+	ptr += sizeof(version);
+
+	memcpy(l1_weights_, ptr, sizeof(l1_weights_));
+	ptr += sizeof(l1_weights_);
+	memcpy(l1_bias_, ptr, sizeof(l1_bias_));
+	ptr += sizeof(l1_bias_);
+	memcpy(l2_weights_, ptr, sizeof(l2_weights_));
+	ptr += sizeof(l2_weights_);
+	memcpy(l2_bias_, ptr, sizeof(l2_bias_));
+	ptr += sizeof(l2_bias_);
+	memcpy(out_weights_, ptr, sizeof(out_weights_));
+	ptr += sizeof(out_weights_);
+	memcpy(&out_bias_, ptr, sizeof(out_bias_));
+	return true;
+}
+
+// 序列化权重
+std::vector<char> NNUENetwork::save() const
+{
+	std::vector<char> out(kNNUEFileMagic, kNNUEFileMagic + sizeof(kNNUEFileMagic));
+	WriteValue(out, kNNUEFileVersion);
+	WriteValue(out, l1_weights_);
+	WriteValue(out, l1_bias_);
+	WriteValue(out, l2_weights_);
+	WriteValue(out, l2_bias_);
+	WriteValue(out, out_weights_);
+	WriteValue(out, out_bias_);
+	return out;
+}
+
+// 随机初始化权重
+void NNUENetwork::randomize(Random &random)
+{
+	for (int i = 0; i < kNNUEInputNum; ++i)
+	{
+		for (int j = 0; j < kNNUEL1Num; ++j)
+		{
+			l1_weights_[i][j] = static_cast<int16_t>(static_cast<int>(random.nextInt(129)) - 64);
+		}
+	}
+	for (int j = 0; j < kNNUEL1Num; ++j)
+	{
+		l1_bias_[j] = static_cast<int16_t>(static_cast<int>(random.nextInt(65)) - 32);
+	}
+	for (int i = 0; i < kNNUEL2Num; ++i)
+	{
+		for (int j = 0; j < 2 * kNNUEL1Num; ++j)
+		{
+			l2_weights_[i][j] = static_cast<int8_t>(static_cast<int>(random.nextInt(65)) - 32);
+		}
+		l2_bias_[i] = static_cast<int32_t>(random.nextInt(257)) - 128;
+		out_weights_[i] = static_cast<int16_t>(static_cast<int>(random.nextInt(129)) - 64);
+	}
+	out_bias_ = 0;
+}
+
+// 根据局面重新计算累加器
+void NNUENetwork::refresh(const Position &pos, FAccumulator &acc) const
+{
+	for (int perspective = 0; perspective < 2; ++perspective)
+	{
+		memcpy(acc.values[perspective], l1_bias_, sizeof(l1_bias_));
+		for (int color = 0; color < 2; ++color)
+		{
+			FBitboard pieces = pos.getPieces(color == 0 ? FChessPieceType::WHITE : FChessPieceType::BLACK);
+			while (pieces)
+			{
+				int square = helper::LowestSquare(pieces);
+				pieces &= pieces - 1;
+				AddFeature(acc.values[perspective], l1_weights_[FeatureIndex(perspective, color, square)]);
+			}
+		}
+	}
+}
+
+// 增量更新累加器
+void NNUENetwork::update(FAccumulator &acc, const FAccumulator &parent, FChessPieceType mover, const FMove &move, FBitboard killed) const
+{
+	const int own = ColorIndex(mover);
+	const int other = own ^ 1;
+	acc = parent;
+	for (int perspective = 0; perspective < 2; ++perspective)
+	{
+		int16_t *values = acc.values[perspective];
+		SubFeature(values, l1_weights_[FeatureIndex(perspective, own, move.source)]);
+		AddFeature(values, l1_weights_[FeatureIndex(perspective, own, move.target)]);
+
+		FBitboard pieces = killed;
+		while (pieces)
+		{
+			int square = helper::LowestSquare(pieces);
+			pieces &= pieces - 1;
+			SubFeature(values, l1_weights_[FeatureIndex(perspective, other, square)]);
+		}
+	}
+}
+
+// 评估
+int NNUENetwork::evaluate(const FAccumulator &acc, FChessPieceType side_to_move) const
+{
+	// 第一层：走棋方视角在前
+	alignas(16) uint8_t input[2 * kNNUEL1Num];
+	const int own = ColorIndex(side_to_move);
+	for (int i = 0; i < kNNUEL1Num; ++i)
+	{
+		input[i] = static_cast<uint8_t>(ClippedRelu(acc.values[own][i]));
+		input[kNNUEL1Num + i] = static_cast<uint8_t>(ClippedRelu(acc.values[own ^ 1][i]));
+	}
+
+	// 第二层
+	int32_t output = out_bias_;
+	for (int i = 0; i < kNNUEL2Num; ++i)
+	{
+		int32_t hidden = ClippedRelu((DotProduct(input, l2_weights_[i]) + l2_bias_[i]) >> kL2Shift);
+		output += hidden * out_weights_[i];
+	}
+	return output / kOutputScale;
+}
\ No newline at end of file
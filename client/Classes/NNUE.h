@@ -0,0 +1,82 @@
+﻿#ifndef __NNUE_H__
+#define __NNUE_H__
+
+#include <string>
+#include <vector>
+#include "Random.h"
+#include "Position.h"
+
+static const int kNNUEInputNum = 2 * kSquareNum;	// 输入：己方、对方各16个格子
+static const int kNNUEL1Num = 32;					// 第一层（每个视角）
+static const int kNNUEL2Num = 16;					// 第二层
+static const uint32_t kNNUEFileVersion = 1;
+static const char kNNUEFileMagic[4] = { 'S', 'S', 'C', 'N' };
+
+/**
+ * 第一层累加器，分别保存白棋和黑棋视角
+ */
+struct FAccumulator
+{
+	alignas(16) int16_t values[2][kNNUEL1Num];
+};
+
+/**
+ * 量化神经网络评估（NNUE）
+ * 权重文件为小端格式：
+ *   char[4] magic, uint32 version
+ *   int16 l1_weights[kNNUEInputNum][kNNUEL1Num], int16 l1_bias[kNNUEL1Num]
+ *   int8 l2_weights[kNNUEL2Num][2 * kNNUEL1Num], int32 l2_bias[kNNUEL2Num]
+ *   int16 out_weights[kNNUEL2Num], int32 out_bias
+ * 仓库中没有训练好的权重，也没有训练工具；没有 config/nnue.bin 时搜索使用手写评估
+ */
+class NNUENetwork
+{
+public:
+	NNUENetwork();
+
+public:
+	/**
+	 * 从内存加载权重
+	 */
+	bool load(const char *data, size_t size);
+
+	/**
+	 * 序列化权重
+	 */
+	std::vector<char> save() const;
+
+	/**
+	 * 随机初始化权重（用于测试和基准）
+	 */
+	void randomize(Random &random);
+
+	/**
+	 * 根据局面重新计算累加器
+	 */
+	void refresh(const Position &pos, FAccumulator &acc) const;
+
+	/**
+	 * 增量更新累加器
+	 * @param FAccumulator 走棋后的累加器
+	 * @param FAccumulator 走棋前的累加器
+	 * @param FChessPieceType 走棋方
+	 * @param FMove 走法
+	 * @param FBitboard 被吃掉的棋子
+	 */
+	void update(FAccumulator &acc, const FAccumulator &parent, FChessPieceType mover, const FMove &move, FBitboard killed) const;
+
+	/**
+	 * 评估（走棋方视角）
+	 */
+	int evaluate(const FAccumulator &acc, FChessPieceType side_to_move) const;
+
+private:
+	alignas(16) int16_t	l1_weights_[kNNUEInputNum][kNNUEL1Num];
+	alignas(16) int16_t	l1_bias_[kNNUEL1Num];
+	alignas(16) int8_t	l2_weights_[kNNUEL2Num][2 * kNNUEL1Num];
+	int32_t				l2_bias_[kNNUEL2Num];
+	int16_t				out_weights_[kNNUEL2Num];
+	int32_t				out_bias_;
+};
+
+#endif
\ No newline at end of file
@@ -0,0 +1,174 @@
+﻿#include "OpeningBook.h"
+#include <cstring>
+#include <fstream>
+#include <algorithm>
+#include <unordered_set>
+#include "TranspositionTable.h"
+
+
+namespace
+{
+	// 文件中每个条目的大小：key(8) | source(1) | target(1) | score(2)
+	const size_t kEntrySize = 12;
+
+	// 构建时使用的置换表大小（MB）
+	const size_t kBuildTTSizeMB = 16;
+
+	inline bool EntryLess(const FBookEntry &a, const FBookEntry &b)
+	{
+		return a.key < b.key;
+	}
+}
+
+OpeningBook::OpeningBook()
+{
+
+}
+
+// 构建开局库
+void OpeningBook::build(const FChessArray &checkerboard, int plies, const FSearchLimits &limits)
+{
+	entries_.clear();
+
+	// 逐层展开，重复局面只保留一次
+	std::vector<Position> layer;
+	std::unordered_set<uint64_t> visited;
+	const FChessPieceType sides[] = { FChessPieceType::WHITE, FChessPieceType::BLACK };
+	for (FChessPieceType side : sides)
+	{
+		Position pos = Position::fromCheckerboard(checkerboard, side);
+		if (visited.insert(pos.getHash()).second)
+		{
+			layer.push_back(pos);
+		}
+	}
+
+	Search search;
+	TranspositionTable tt(kBuildTTSizeMB);
+	search.setTranspositionTable(&tt);
+	Random random;
+	for (int ply = 0; ply < plies && !layer.empty(); ++ply)
+	{
+		std::vector<Position> next_layer;
+		for (const Position &pos : layer)
+		{
+			if (pos.isLost())
+			{
+				continue;
+			}
+
+			FSearchResult result = search.run(pos, limits, random);
+			if (result.best_move.isValid())
+			{
+				FBookEntry entry = { pos.getHash(), result.best_move, static_cast<int16_t>(result.score) };
+				entries_.push_back(entry);
+			}
+
+			FMove moves[kMaxMoveNum];
+			int move_num = pos.generateMoves(moves);
+			for (int i = 0; i < move_num; ++i)
+			{
+				Position child = pos;
+				child.makeMove(moves[i]);
+				if (visited.insert(child.getHash()).second)
+				{
+					next_layer.push_back(child);
+				}
+			}
+		}
+		layer.swap(next_layer);
+	}
+
+	std::sort(entries_.begin(), entries_.end(), EntryLess);
+}
+
+// 从内存加载
+bool OpeningBook::load(const char *data, size_t size)
+{
+	const size_t header_size = sizeof(kBookFileMagic) + sizeof(uint32_t) * 2;
+	if (size < header_size || memcmp(data, kBookFileMagic, sizeof(kBookFileMagic)) != 0)
+	{
+		return false;
+	}
+
+	uint32_t version = 0;
+	uint32_t count = 0;
+	memcpy(&version, data + sizeof(kBookFileMagic), sizeof(version));
+	memcpy(&count, data + sizeof(kBookFileMagic) + sizeof(version), sizeof(count));
+	if (version != kBookFileVersion || size != header_size + static_cast<size_t>(count) * kEntrySize)
+	{
+		return false;
+	}
+
+	std::vector<FBookEntry> entries(count);
+	const char *p = data + header_size;
+	for (uint32_t i = 0; i < count; ++i, p += kEntrySize)
+	{
+		memcpy(&entries[i].key, p, sizeof(uint64_t));
+		entries[i].move.source = static_cast<uint8_t>(p[8]);
+		entries[i].move.target = static_cast<uint8_t>(p[9]);
+		memcpy(&entries[i].score, p + 10, sizeof(int16_t));
+	}
+	std::sort(entries.begin(), entries.end(), EntryLess);
+	entries_.swap(entries);
+	return true;
+}
+
+// 保存到文件
+bool OpeningBook::save(const std::string &filename) const
+{
+	std::ofstream out(filename.c_str(), std::ios::binary);
+	if (!out)
+	{
+		return false;
+	}
+
+	const uint32_t count = static_cast<uint32_t>(entries_.size());
+	out.write(kBookFileMagic, sizeof(kBookFileMagic));
+	out.write(reinterpret_cast<const char *>(&kBookFileVersion), sizeof(kBookFileVersion));
+	out.write(reinterpret_cast<const char *>(&count), sizeof(count));
+	for (const FBookEntry &entry : entries_)
+	{
+		char buffer[kEntrySize];
+		memcpy(buffer, &entry.key, sizeof(uint64_t));
+		buffer[8] = static_cast<char>(entry.move.source);
+		buffer[9] = static_cast<char>(entry.move.target);
+		memcpy(buffer + 10, &entry.score, sizeof(int16_t));
+		out.write(buffer, sizeof(buffer));
+	}
+	return static_cast<bool>(out);
+}
+
+// 查询局面
+bool OpeningBook::probe(const Position &pos, FMove &move, int &score) const
+{
+	FBookEntry target;
+	target.key = pos.getHash();
+	auto it = std::lower_bound(entries_.begin(), entries_.end(), target, EntryLess);
+	if (it == entries_.end() || it->key != target.key)
+	{
+		return false;
+	}
+
+	FMove moves[kMaxMoveNum];
+	int move_num = pos.generateMoves(moves);
+	if (std::find(moves, moves + move_num, it->move) == moves + move_num)
+	{
+		return false;
+	}
+	move = it->move;
+	score = it->score;
+	return true;
+}
+
+// 清空
+void OpeningBook::clear()
+{
+	entries_.clear();
+}
+
+// 条目数量
+size_t OpeningBook::getEntryNum() const
+{
+	return entries_.size();
+}
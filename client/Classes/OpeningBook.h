@@ -0,0 +1,71 @@
+﻿#ifndef __OPENINGBOOK_H__
+#define __OPENINGBOOK_H__
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include "Search.h"
+#include "Position.h"
+
+static const uint32_t kBookFileVersion = 1;
+static const char kBookFileMagic[4] = { 'S', 'S', 'O', 'B' };
+
+/**
+ * 开局库条目
+ */
+struct FBookEntry
+{
+	uint64_t	key;							// 局面哈希
+	FMove		move;							// 最佳走法
+	int16_t		score;							// 搜索分数（走棋方视角）
+};
+
+/**
+ * 开局库
+ * 保存开局阶段局面的最佳走法，按局面哈希排序后二分查找。
+ * 构建或加载完成后只读，多个线程可以同时查询。
+ */
+class OpeningBook
+{
+public:
+	OpeningBook();
+
+public:
+	/**
+	 * 从初始局面（双方各自先手）展开指定步数内的所有局面，逐一搜索最佳走法
+	 * @param FChessArray 初始棋盘
+	 * @param int 步数
+	 * @param FSearchLimits 每个局面的搜索限制
+	 */
+	void build(const FChessArray &checkerboard, int plies, const FSearchLimits &limits);
+
+	/**
+	 * 从内存加载
+	 */
+	bool load(const char *data, size_t size);
+
+	/**
+	 * 保存到文件
+	 */
+	bool save(const std::string &filename) const;
+
+	/**
+	 * 查询局面，走法不合法（哈希冲突）时返回 false
+	 */
+	bool probe(const Position &pos, FMove &move, int &score) const;
+
+	/**
+	 * 清空
+	 */
+	void clear();
+
+	/**
+	 * 条目数量
+	 */
+	size_t getEntryNum() const;
+
+private:
+	std::vector<FBookEntry>	entries_;
+};
+
+#endif
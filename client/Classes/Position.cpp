@@ -0,0 +1,359 @@
+﻿#include "Position.h"
+#include <cassert>
+
+
+namespace
+{
+	// 棋子类型转数组下标
+	inline int ToIndex(FChessPieceType type)
+	{
+		assert(type == FChessPieceType::WHITE || type == FChessPieceType::BLACK);
+		return type == FChessPieceType::WHITE ? 0 : 1;
+	}
+
+	// 数组下标转棋子类型
+	inline FChessPieceType ToType(int index)
+	{
+		return index == 0 ? FChessPieceType::WHITE : FChessPieceType::BLACK;
+	}
+
+	/**
+	 * 预计算表
+	 * line_killed: 一条线（4格）上走棋方与对方的分布 -> 被吃掉的格子
+	 * adjacent: 每个格子上下左右相邻的格子
+	 * zobrist: 按字节查表的 Zobrist 键（颜色、高低字节、字节值）
+	 */
+	struct FTables
+	{
+		uint8_t		line_killed[16][16];
+		FBitboard	adjacent[kSquareNum];
+		uint64_t	zobrist[2][2][256];
+		uint64_t	zobrist_side;
+
+		FTables()
+		{
+			static_assert(kCheckerboardRowNum == 4 && kCheckerboardColNum == 4, "Position requires a 4x4 checkerboard");
+
+			// 与 helper::CheckKillChesspiece 一致：恰好三子相连且另一格为空，
+			// 其中两颗是走棋方、对方棋子不在中间时吃掉对方棋子
+			for (int own = 0; own < 16; ++own)
+			{
+				for (int other = 0; other < 16; ++other)
+				{
+					uint8_t killed = 0;
+					int occupied = own | other;
+					if ((own & other) == 0 && (occupied == 0x7 || occupied == 0xE))
+					{
+						int middle = occupied == 0x7 ? 0x2 : 0x4;
+						if (helper::PopCount(static_cast<FBitboard>(own)) == 2 && (other & middle) == 0)
+						{
+							killed = static_cast<uint8_t>(other);
+						}
+					}
+					line_killed[own][other] = killed;
+				}
+			}
+
+			for (int square = 0; square < kSquareNum; ++square)
+			{
+				int row = square / kCheckerboardColNum;
+				int col = square % kCheckerboardColNum;
+				FBitboard bb = 0;
+				if (col > 0) bb |= 1 << (square - 1);
+				if (col < kCheckerboardColNum - 1) bb |= 1 << (square + 1);
+				if (row > 0) bb |= 1 << (square - kCheckerboardColNum);
+				if (row < kCheckerboardRowNum - 1) bb |= 1 << (square + kCheckerboardColNum);
+				adjacent[square] = bb;
+			}
+
+			// 固定种子生成，哈希值在不同平台和进程间保持一致
+			uint64_t square_keys[2][kSquareNum];
+			uint64_t seed = 0x9e3779b97f4a7c15ULL;
+			for (int color = 0; color < 2; ++color)
+			{
+				for (int square = 0; square < kSquareNum; ++square)
+				{
+					square_keys[color][square] = NextKey(seed);
+				}
+			}
+			zobrist_side = NextKey(seed);
+
+			for (int color = 0; color < 2; ++color)
+			{
+				for (int half = 0; half < 2; ++half)
+				{
+					for (int value = 0; value < 256; ++value)
+					{
+						uint64_t key = 0;
+						for (int bit = 0; bit < 8; ++bit)
+						{
+							if ((value >> bit) & 1)
+							{
+								key ^= square_keys[color][half * 8 + bit];
+							}
+						}
+						zobrist[color][half][value] = key;
+					}
+				}
+			}
+		}
+
+		static uint64_t NextKey(uint64_t &seed)
+		{
+			uint64_t z = (seed += 0x9e3779b97f4a7c15ULL);
+			z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+			z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+			return z ^ (z >> 31);
+		}
+	};
+
+	const FTables& GetTables()
+	{
+		static const FTables tables;
+		return tables;
+	}
+
+	// 提取一行
+	inline int ExtractRow(FBitboard bb, int row)
+	{
+		return (bb >> (row * kCheckerboardColNum)) & 0xF;
+	}
+
+	// 提取一列
+	inline int ExtractCol(FBitboard bb, int col)
+	{
+		return ((bb >> col) & 1) | (((bb >> (col + 4)) & 1) << 1) | (((bb >> (col + 8)) & 1) << 2) | (((bb >> (col + 12)) & 1) << 3);
+	}
+
+	// 一行展开为位棋盘
+	inline FBitboard DepositRow(int line, int row)
+	{
+		return static_cast<FBitboard>(line << (row * kCheckerboardColNum));
+	}
+
+	// 一列展开为位棋盘
+	inline FBitboard DepositCol(int line, int col)
+	{
+		return static_cast<FBitboard>(((line & 1) << col) | (((line >> 1) & 1) << (col + 4)) | (((line >> 2) & 1) << (col + 8)) | (((line >> 3) & 1) << (col + 12)));
+	}
+}
+
+// 转换为移动轨迹
+FMoveTrack FMove::toMoveTrack() const
+{
+	FMoveTrack track = {
+		FVec2(source % kCheckerboardColNum, source / kCheckerboardColNum),
+		FVec2(target % kCheckerboardColNum, target / kCheckerboardColNum)
+	};
+	return track;
+}
+
+// 从移动轨迹转换
+FMove FMove::fromMoveTrack(const FMoveTrack &track)
+{
+	FMove move = {
+		static_cast<uint8_t>(track.source.y * kCheckerboardColNum + track.source.x),
+		static_cast<uint8_t>(track.target.y * kCheckerboardColNum + track.target.x)
+	};
+	return move;
+}
+
+Position::Position()
+	: side_(0)
+{
+	pieces_[0] = pieces_[1] = 0;
+}
+
+// 从棋盘数据构建局面
+Position Position::fromCheckerboard(const FChessArray &checkerboard, FChessPieceType side_to_move)
+{
+	Position pos;
+	for (size_t i = 0; i < checkerboard.size(); ++i)
+	{
+		if (checkerboard[i] != FChessPieceType::NONE)
+		{
+			pos.pieces_[ToIndex(checkerboard[i])] |= 1 << i;
+		}
+	}
+	pos.side_ = static_cast<uint8_t>(ToIndex(side_to_move));
+	return pos;
+}
+
+// 从位棋盘构建局面
+Position Position::fromBitboards(FBitboard white, FBitboard black, FChessPieceType side_to_move)
+{
+	assert((white & black) == 0);
+	Position pos;
+	pos.pieces_[0] = white;
+	pos.pieces_[1] = black;
+	pos.side_ = static_cast<uint8_t>(ToIndex(side_to_move));
+	return pos;
+}
+
+// 转换为棋盘数据
+FChessArray Position::toCheckerboard() const
+{
+	FChessArray checkerboard;
+	for (int i = 0; i < kSquareNum; ++i)
+	{
+		checkerboard[i] = (pieces_[0] >> i) & 1 ? FChessPieceType::WHITE
+			: (pieces_[1] >> i) & 1 ? FChessPieceType::BLACK : FChessPieceType::NONE;
+	}
+	return checkerboard;
+}
+
+// 获取轮到走棋的一方
+FChessPieceType Position::getSideToMove() const
+{
+	return ToType(side_);
+}
+
+// 获取某一方的棋子
+FBitboard Position::getPieces(FChessPieceType type) const
+{
+	return pieces_[ToIndex(type)];
+}
+
+// 获取所有棋子
+FBitboard Position::getOccupied() const
+{
+	return pieces_[0] | pieces_[1];
+}
+
+// 获取局面哈希
+uint64_t Position::getHash() const
+{
+	const FTables &tables = GetTables();
+	uint64_t hash = side_ ? tables.zobrist_side : 0;
+	for (int color = 0; color < 2; ++color)
+	{
+		hash ^= tables.zobrist[color][0][pieces_[color] & 0xFF];
+		hash ^= tables.zobrist[color][1][pieces_[color] >> 8];
+	}
+	return hash;
+}
+
+// 生成所有走法
+int Position::generateMoves(FMove *moves) const
+{
+	const FTables &tables = GetTables();
+	const FBitboard empty = static_cast<FBitboard>(~getOccupied());
+	int count = 0;
+	FBitboard own = pieces_[side_];
+	while (own)
+	{
+		int source = helper::LowestSquare(own);
+		own &= own - 1;
+		FBitboard targets = tables.adjacent[source] & empty;
+		while (targets)
+		{
+			int target = helper::LowestSquare(targets);
+			targets &= targets - 1;
+			moves[count].source = static_cast<uint8_t>(source);
+			moves[count].target = static_cast<uint8_t>(target);
+			++count;
+		}
+	}
+	assert(count <= kMaxMoveNum);
+	return count;
+}
+
+// 某一方是否有棋可走
+bool Position::hasMoves(FChessPieceType type) const
+{
+	const FTables &tables = GetTables();
+	const FBitboard empty = static_cast<FBitboard>(~getOccupied());
+	FBitboard own = pieces_[ToIndex(type)];
+	while (own)
+	{
+		int source = helper::LowestSquare(own);
+		own &= own - 1;
+		if (tables.adjacent[source] & empty)
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+// 轮到走棋的一方是否已经输了
+bool Position::isLost() const
+{
+	return helper::PopCount(pieces_[side_]) <= 1 || !hasMoves(getSideToMove());
+}
+
+// 走棋
+FBitboard Position::makeMove(const FMove &move)
+{
+	assert((pieces_[side_] >> move.source) & 1);
+	assert(!((getOccupied() >> move.target) & 1));
+
+	FBitboard &own = pieces_[side_];
+	FBitboard &other = pieces_[side_ ^ 1];
+	own = static_cast<FBitboard>((own & ~(1 << move.source)) | (1 << move.target));
+
+	FBitboard killed = helper::ComputeKilled(own, other, move.target);
+	other &= ~killed;
+	side_ ^= 1;
+	return killed;
+}
+
+// 撤销走棋
+void Position::unmakeMove(const FMove &move, FBitboard killed)
+{
+	side_ ^= 1;
+	FBitboard &own = pieces_[side_];
+	FBitboard &other = pieces_[side_ ^ 1];
+	other |= killed;
+	own = static_cast<FBitboard>((own & ~(1 << move.target)) | (1 << move.source));
+}
+
+namespace helper
+{
+	// 计算棋子数量
+	int PopCount(FBitboard bb)
+	{
+		int count = 0;
+		while (bb)
+		{
+			bb &= bb - 1;
+			++count;
+		}
+		return count;
+	}
+
+	// 获取最低位棋子的格子索引
+	int LowestSquare(FBitboard bb)
+	{
+		assert(bb != 0);
+		int square = 0;
+		while (!((bb >> square) & 1))
+		{
+			++square;
+		}
+		return square;
+	}
+
+	// 获取相邻格子
+	FBitboard AdjacentSquares(int square)
+	{
+		return GetTables().adjacent[square];
+	}
+
+	// 计算落子后可吃掉的棋子
+	FBitboard ComputeKilled(FBitboard own, FBitboard other, int target)
+	{
+		const FTables &tables = GetTables();
+		int row = target / kCheckerboardColNum;
+		int col = target % kCheckerboardColNum;
+		FBitboard killed = DepositRow(tables.line_killed[ExtractRow(own, row)][ExtractRow(other, row)], row);
+		killed |= DepositCol(tables.line_killed[ExtractCol(own, col)][ExtractCol(other, col)], col);
+		return killed;
+	}
+
+	// 获取对方棋子类型
+	FChessPieceType OpponentOf(FChessPieceType type)
+	{
+		return type == FChessPieceType::WHITE ? FChessPieceType::BLACK : FChessPieceType::WHITE;
+	}
+}
\ No newline at end of file
@@ -0,0 +1,160 @@
+﻿#ifndef __POSITION_H__
+#define __POSITION_H__
+
+#include <cstdint>
+#include "LogicBase.h"
+
+/**
+ * 位棋盘，每一位对应一个格子（索引 = y * kCheckerboardColNum + x）
+ */
+typedef uint16_t FBitboard;
+
+static const int kSquareNum = kCheckerboardRowNum * kCheckerboardColNum;
+static const int kMaxMoveNum = 32;				// 单个局面最多的走法数量
+
+/**
+ * 走法
+ */
+struct FMove
+{
+	uint8_t source;								// 来源格子
+	uint8_t target;								// 目标格子
+
+	bool operator== (const FMove &that) const
+	{
+		return source == that.source && target == that.target;
+	}
+
+	bool operator!= (const FMove &that) const
+	{
+		return !(*this == that);
+	}
+
+	static FMove invalid()
+	{
+		FMove move = { 0xff, 0xff };
+		return move;
+	}
+
+	bool isValid() const
+	{
+		return source < kSquareNum && target < kSquareNum;
+	}
+
+	FMoveTrack toMoveTrack() const;
+
+	static FMove fromMoveTrack(const FMoveTrack &track);
+};
+
+/**
+ * 搜索用的紧凑局面，规则与 LogicBase::update 保持一致
+ */
+class Position
+{
+public:
+	Position();
+
+	/**
+	 * 从棋盘数据构建局面
+	 * @param FChessArray 棋盘数据
+	 * @param FChessPieceType 轮到走棋的一方
+	 */
+	static Position fromCheckerboard(const FChessArray &checkerboard, FChessPieceType side_to_move);
+
+	/**
+	 * 从位棋盘构建局面
+	 */
+	static Position fromBitboards(FBitboard white, FBitboard black, FChessPieceType side_to_move);
+
+	/**
+	 * 转换为棋盘数据
+	 */
+	FChessArray toCheckerboard() const;
+
+public:
+	/**
+	 * 获取轮到走棋的一方
+	 */
+	FChessPieceType getSideToMove() const;
+
+	/**
+	 * 获取某一方的棋子
+	 */
+	FBitboard getPieces(FChessPieceType type) const;
+
+	/**
+	 * 获取所有棋子
+	 */
+	FBitboard getOccupied() const;
+
+	/**
+	 * 获取局面哈希（Zobrist）
+	 */
+	uint64_t getHash() const;
+
+	/**
+	 * 生成所有走法
+	 * @param FMove* 走法数组，至少 kMaxMoveNum 个元素
+	 * @return int 走法数量
+	 */
+	int generateMoves(FMove *moves) const;
+
+	/**
+	 * 某一方是否有棋可走
+	 */
+	bool hasMoves(FChessPieceType type) const;
+
+	/**
+	 * 轮到走棋的一方是否已经输了（只剩一颗棋子或无棋可走）
+	 */
+	bool isLost() const;
+
+	/**
+	 * 走棋
+	 * @return FBitboard 被吃掉的棋子
+	 */
+	FBitboard makeMove(const FMove &move);
+
+	/**
+	 * 撤销走棋
+	 * @param FBitboard makeMove 返回的被吃掉的棋子
+	 */
+	void unmakeMove(const FMove &move, FBitboard killed);
+
+private:
+	FBitboard		pieces_[2];
+	uint8_t			side_;
+};
+
+namespace helper
+{
+	/**
+	 * 计算棋子数量
+	 */
+	int PopCount(FBitboard bb);
+
+	/**
+	 * 获取最低位棋子的格子索引
+	 */
+	int LowestSquare(FBitboard bb);
+
+	/**
+	 * 获取相邻格子
+	 */
+	FBitboard AdjacentSquares(int square);
+
+	/**
+	 * 计算落子后可吃掉的棋子
+	 * @param FBitboard 走棋方棋子（已落子）
+	 * @param FBitboard 对方棋子
+	 * @param int 落子位置
+	 */
+	FBitboard ComputeKilled(FBitboard own, FBitboard other, int target);
+
+	/**
+	 * 获取对方棋子类型
+	 */
+	FChessPieceType OpponentOf(FChessPieceType type);
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,470 @@
+﻿#include "ProofSolver.h"
+#include <algorithm>
+
+
+namespace
+{
+	// 每个桶的条目数
+	const size_t kBucketSize = 4;
+
+	// 攻击方为黑棋时的局面键值扰动（同一局面两种证明的含义不同）
+	const uint64_t kBlackAttackerKey = 0x6a09e667f3bcc909ULL;
+
+	// 未证明的条目按剩余步数区分，证明和反证的条目每个局面只有一个
+	inline uint64_t DepthKey(int depth)
+	{
+		return static_cast<uint64_t>(depth) * 0x9e3779b97f4a7c15ULL;
+	}
+
+	// 累加时不超过无穷大减一，只有真正证明或反证的节点才取无穷大
+	inline uint32_t SaturatedAdd(uint32_t a, uint32_t b)
+	{
+		if (a == kProofInfinity || b == kProofInfinity)
+		{
+			return kProofInfinity;
+		}
+		return static_cast<uint32_t>(std::min<uint64_t>(static_cast<uint64_t>(a) + b, kProofInfinity - 1));
+	}
+}
+
+ProofSolver::ProofSolver(size_t tt_size_mb)
+	: mask_(0)
+	, attacker_(FChessPieceType::NONE)
+	, nodes_(0)
+	, stopped_(false)
+{
+	size_t count = kBucketSize;
+	size_t bytes = std::max<size_t>(tt_size_mb, 1) * 1024 * 1024;
+	while (count * 2 * sizeof(FProofEntry) <= bytes)
+	{
+		count *= 2;
+	}
+	table_.resize(count);
+	mask_ = count / kBucketSize - 1;
+	clear();
+}
+
+// 清空置换表
+void ProofSolver::clear()
+{
+	for (auto &entry : table_)
+	{
+		entry.key = 0;
+		entry.pn = 1;
+		entry.dn = 1;
+		entry.work = 0;
+		entry.depth = 0;
+		entry.padding = 0;
+	}
+}
+
+// 求解局面
+FProofStats ProofSolver::solve(const Position &pos, const FProofLimits &limits)
+{
+	limits_ = limits;
+	nodes_ = 0;
+	stopped_ = false;
+	start_time_ = std::chrono::steady_clock::now();
+
+	FProofStats stats;
+	const FChessPieceType side = pos.getSideToMove();
+	FChessPieceType winner = FChessPieceType::NONE;
+	if (pos.isLost())
+	{
+		stats.result = FProofResult::LOSS;
+	}
+	else
+	{
+		// 奇数步只可能是走棋方取胜，偶数步只可能是对方取胜
+		for (int plies = 1; plies <= limits_.max_plies && !stopped_; ++plies)
+		{
+			FChessPieceType attacker = plies % 2 == 1 ? side : helper::OpponentOf(side);
+			bool proven = prove(pos, attacker, plies);
+			if (!stopped_)
+			{
+				stats.plies = plies;
+			}
+			if (proven)
+			{
+				stats.result = attacker == side ? FProofResult::WIN : FProofResult::LOSS;
+				winner = attacker;
+				break;
+			}
+		}
+		if (winner == FChessPieceType::NONE && !stopped_)
+		{
+			stats.result = FProofResult::DRAW;
+		}
+	}
+
+	// 证明树大小与取胜变例，不受限制约束
+	if (winner != FChessPieceType::NONE)
+	{
+		attacker_ = winner;
+		limits_ = FProofLimits();
+
+		Position root = pos;
+		std::unordered_set<uint64_t> visited;
+		countProof(root, stats.plies, visited);
+		stats.proof_size = visited.size();
+		stats.line = extractLine(pos, stats.plies);
+	}
+
+	stats.nodes = nodes_;
+	stats.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time_).count();
+	stats.tt_used = countUsedEntries();
+	return stats;
+}
+
+// 证明攻击方在指定步数内取胜
+bool ProofSolver::prove(const Position &pos, FChessPieceType attacker, int plies)
+{
+	attacker_ = attacker;
+
+	Position root = pos;
+	FProofNumbers numbers = lookup(root, plies);
+	while (numbers.pn != 0 && numbers.dn != 0 && !stopped_)
+	{
+		numbers = mid(root, kProofInfinity, kProofInfinity, plies);
+	}
+	return numbers.pn == 0;
+}
+
+// 多重迭代加深
+ProofSolver::FProofNumbers ProofSolver::mid(Position &pos, uint32_t thpn, uint32_t thdn, int remaining)
+{
+	const uint64_t start_nodes = nodes_++;
+	shouldStop();
+
+	const bool or_node = pos.getSideToMove() == attacker_;
+	FMove moves[kMaxMoveNum];
+	int move_num = pos.generateMoves(moves);
+
+	// 搜索过的子节点使用返回值，不依赖置换表条目是否被替换
+	FProofNumbers children[kMaxMoveNum];
+	bool searched[kMaxMoveNum] = { false };
+
+	FProofNumbers numbers;
+	while (true)
+	{
+		// 攻击方走棋时取最小证明数，防守方走棋时取最小反证数
+		uint32_t min_value = kProofInfinity;
+		uint32_t second_value = kProofInfinity;
+		uint32_t sum_value = 0;
+		int best = -1;
+		for (int i = 0; i < move_num; ++i)
+		{
+			if (!searched[i])
+			{
+				FBitboard killed = pos.makeMove(moves[i]);
+				children[i] = lookup(pos, remaining - 1);
+				pos.unmakeMove(moves[i], killed);
+			}
+
+			uint32_t value = or_node ? children[i].pn : children[i].dn;
+			uint32_t other = or_node ? children[i].dn : children[i].pn;
+			if (value < min_value)
+			{
+				second_value = min_value;
+				min_value = value;
+				best = i;
+			}
+			else if (value < second_value)
+			{
+				second_value = value;
+			}
+			sum_value = SaturatedAdd(sum_value, other);
+		}
+		numbers.pn = or_node ? min_value : sum_value;
+		numbers.dn = or_node ? sum_value : min_value;
+
+		if (numbers.pn >= thpn || numbers.dn >= thdn || best < 0 || stopped_)
+		{
+			break;
+		}
+
+		// 子节点阈值
+		const FProofNumbers &child = children[best];
+		uint32_t child_thpn = 0;
+		uint32_t child_thdn = 0;
+		if (or_node)
+		{
+			child_thpn = std::min(thpn, SaturatedAdd(second_value, 1));
+			child_thdn = SaturatedAdd(thdn - numbers.dn, child.dn);
+		}
+		else
+		{
+			child_thpn = SaturatedAdd(thpn - numbers.pn, child.pn);
+			child_thdn = std::min(thdn, SaturatedAdd(second_value, 1));
+		}
+
+		FBitboard killed = pos.makeMove(moves[best]);
+		children[best] = mid(pos, child_thpn, child_thdn, remaining - 1);
+		searched[best] = true;
+		pos.unmakeMove(moves[best], killed);
+	}
+
+	store(entryKey(pos), numbers, remaining, nodes_ - start_nodes);
+	return numbers;
+}
+
+// 查询局面的证明数与反证数
+ProofSolver::FProofNumbers ProofSolver::lookup(const Position &pos, int remaining, int *proven_depth) const
+{
+	FProofNumbers numbers = { 1, 1 };
+	if (proven_depth != nullptr)
+	{
+		*proven_depth = 0;
+	}
+
+	// 终局
+	if (pos.isLost())
+	{
+		numbers.pn = pos.getSideToMove() == attacker_ ? kProofInfinity : 0;
+		numbers.dn = pos.getSideToMove() == attacker_ ? 0 : kProofInfinity;
+		return numbers;
+	}
+
+	// 步数用完仍未取胜
+	if (remaining <= 0)
+	{
+		numbers.pn = kProofInfinity;
+		numbers.dn = 0;
+		return numbers;
+	}
+
+	const uint64_t key = entryKey(pos);
+	const FProofEntry *entry = probe(key);
+	if (entry != nullptr)
+	{
+		if (entry->pn == 0 && entry->depth <= remaining)
+		{
+			numbers.pn = 0;
+			numbers.dn = kProofInfinity;
+			if (proven_depth != nullptr)
+			{
+				*proven_depth = entry->depth;
+			}
+			return numbers;
+		}
+		if (entry->dn == 0 && entry->depth >= remaining)
+		{
+			numbers.pn = kProofInfinity;
+			numbers.dn = 0;
+			return numbers;
+		}
+	}
+
+	entry = probe(key ^ DepthKey(remaining));
+	if (entry != nullptr)
+	{
+		numbers.pn = entry->pn;
+		numbers.dn = entry->dn;
+	}
+	return numbers;
+}
+
+// 统计证明树大小
+void ProofSolver::countProof(Position &pos, int remaining, std::unordered_set<uint64_t> &visited)
+{
+	if (!visited.insert(entryKey(pos)).second || pos.isLost() || remaining <= 0)
+	{
+		return;
+	}
+
+	FMove moves[kMaxMoveNum];
+	int move_num = pos.generateMoves(moves);
+	if (pos.getSideToMove() != attacker_)
+	{
+		// 防守方的所有走法都需要证明
+		for (int i = 0; i < move_num; ++i)
+		{
+			FBitboard killed = pos.makeMove(moves[i]);
+			countProof(pos, remaining - 1, visited);
+			pos.unmakeMove(moves[i], killed);
+		}
+		return;
+	}
+
+	// 攻击方只需要一个已证明的走法，置换表条目被替换时重新证明
+	int best = selectProvenMove(pos, moves, move_num, remaining);
+	if (best < 0)
+	{
+		mid(pos, kProofInfinity, kProofInfinity, remaining);
+		best = selectProvenMove(pos, moves, move_num, remaining);
+	}
+	if (best >= 0)
+	{
+		FBitboard killed = pos.makeMove(moves[best]);
+		countProof(pos, remaining - 1, visited);
+		pos.unmakeMove(moves[best], killed);
+	}
+}
+
+// 攻击方选择已证明的最短走法
+int ProofSolver::selectProvenMove(Position &pos, const FMove *moves, int move_num, int remaining) const
+{
+	int best = -1;
+	int best_depth = 0;
+	for (int i = 0; i < move_num; ++i)
+	{
+		int depth = 0;
+		FBitboard killed = pos.makeMove(moves[i]);
+		bool proven = lookup(pos, remaining - 1, &depth).pn == 0;
+		pos.unmakeMove(moves[i], killed);
+		if (proven && (best < 0 || depth < best_depth))
+		{
+			best = i;
+			best_depth = depth;
+		}
+	}
+	return best;
+}
+
+// 提取取胜变例
+std::vector<FMove> ProofSolver::extractLine(const Position &pos, int plies)
+{
+	std::vector<FMove> line;
+	Position current = pos;
+	for (int remaining = plies; remaining > 0 && !current.isLost(); --remaining)
+	{
+		FMove moves[kMaxMoveNum];
+		int move_num = current.generateMoves(moves);
+		int best = -1;
+		if (current.getSideToMove() == attacker_)
+		{
+			best = selectProvenMove(current, moves, move_num, remaining);
+			if (best < 0)
+			{
+				mid(current, kProofInfinity, kProofInfinity, remaining);
+				best = selectProvenMove(current, moves, move_num, remaining);
+			}
+		}
+		else
+		{
+			// 防守方选择证明所需步数最多的走法
+			int best_depth = -1;
+			for (int i = 0; i < move_num; ++i)
+			{
+				int depth = 0;
+				FBitboard killed = current.makeMove(moves[i]);
+				if (lookup(current, remaining - 1, &depth).pn != 0)
+				{
+					mid(current, kProofInfinity, kProofInfinity, remaining - 1);
+					lookup(current, remaining - 1, &depth);
+				}
+				current.unmakeMove(moves[i], killed);
+				if (depth > best_depth)
+				{
+					best = i;
+					best_depth = depth;
+				}
+			}
+		}
+		if (best < 0)
+		{
+			break;
+		}
+		line.push_back(moves[best]);
+		current.makeMove(moves[best]);
+	}
+	return line;
+}
+
+// 查找置换表
+const ProofSolver::FProofEntry* ProofSolver::probe(uint64_t key) const
+{
+	const FProofEntry *bucket = &table_[(key & mask_) * kBucketSize];
+	for (size_t i = 0; i < kBucketSize; ++i)
+	{
+		if (bucket[i].key == key)
+		{
+			return &bucket[i];
+		}
+	}
+	return nullptr;
+}
+
+// 保存到置换表
+void ProofSolver::store(uint64_t key, const FProofNumbers &numbers, int depth, uint64_t work)
+{
+	const bool solved = numbers.pn == 0 || numbers.dn == 0;
+	if (!solved)
+	{
+		key ^= DepthKey(depth);
+	}
+
+	// 桶满时替换子树最小的条目
+	FProofEntry *bucket = &table_[(key & mask_) * kBucketSize];
+	FProofEntry *target = &bucket[0];
+	for (size_t i = 0; i < kBucketSize; ++i)
+	{
+		if (bucket[i].key == key || bucket[i].key == 0)
+		{
+			target = &bucket[i];
+			break;
+		}
+		if (bucket[i].work < target->work)
+		{
+			target = &bucket[i];
+		}
+	}
+
+	uint32_t total_work = static_cast<uint32_t>(std::min<uint64_t>(work, UINT32_MAX));
+	if (target->key == key && solved)
+	{
+		// 步数更少的证明、步数更多的反证包含更多信息，不被覆盖
+		if (target->pn == 0 && (numbers.pn != 0 || target->depth <= depth))
+		{
+			return;
+		}
+		if (target->dn == 0 && numbers.dn == 0 && target->depth >= depth)
+		{
+			return;
+		}
+	}
+	if (target->key == key)
+	{
+		total_work = static_cast<uint32_t>(std::min<uint64_t>(static_cast<uint64_t>(target->work) + total_work, UINT32_MAX));
+	}
+	target->key = key;
+	target->pn = numbers.pn;
+	target->dn = numbers.dn;
+	target->work = total_work;
+	target->depth = static_cast<uint16_t>(depth);
+}
+
+// 置换表键值
+uint64_t ProofSolver::entryKey(const Position &pos) const
+{
+	uint64_t key = pos.getHash();
+	return attacker_ == FChessPieceType::BLACK ? key ^ kBlackAttackerKey : key;
+}
+
+// 统计已使用的条目
+size_t ProofSolver::countUsedEntries() const
+{
+	return static_cast<size_t>(std::count_if(table_.begin(), table_.end(), [](const FProofEntry &entry)
+	{
+		return entry.key != 0;
+	}));
+}
+
+// 是否需要停止
+bool ProofSolver::shouldStop()
+{
+	if (stopped_)
+	{
+		return true;
+	}
+	if (limits_.max_nodes != 0 && nodes_ >= limits_.max_nodes)
+	{
+		stopped_ = true;
+	}
+	else if (limits_.max_time_ms > 0 && (nodes_ & 0xFFF) == 0)
+	{
+		auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start_time_);
+		stopped_ = elapsed.count() >= limits_.max_time_ms;
+	}
+	return stopped_;
+}
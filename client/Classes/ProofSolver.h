@@ -0,0 +1,160 @@
+﻿#ifndef __PROOFSOLVER_H__
+#define __PROOFSOLVER_H__
+
+#include <chrono>
+#include <vector>
+#include <cstdint>
+#include <unordered_set>
+#include "Position.h"
+
+static const uint32_t kProofInfinity = 0x3FFFFFFF;	// 证明数、反证数的无穷大
+
+/**
+ * 证明结果（走棋方视角）
+ */
+enum class FProofResult
+{
+	UNKNOWN,									// 超出节点数或时间限制
+	WIN,										// 走棋方必胜
+	LOSS,										// 走棋方必败
+	DRAW,										// 最大步数内双方都无法强制取胜
+};
+
+/**
+ * 证明限制
+ */
+struct FProofLimits
+{
+	uint64_t	max_nodes;						// 最大节点数（0表示不限制）
+	int			max_time_ms;					// 最大耗时（0表示不限制）
+	int			max_plies;						// 最大步数
+
+	FProofLimits() : max_nodes(0), max_time_ms(0), max_plies(101) {}
+};
+
+/**
+ * 证明结果及统计
+ */
+struct FProofStats
+{
+	FProofResult		result;					// 证明结果
+	int					plies;					// 取胜步数，未证明时为已完成的最大步数
+	uint64_t			nodes;					// 展开的节点数
+	uint64_t			proof_size;				// 证明树的局面数（仅 WIN、LOSS）
+	double				seconds;				// 耗时
+	size_t				tt_used;				// 置换表已使用的条目数
+	std::vector<FMove>	line;					// 获胜方的一条取胜变例
+
+	FProofStats() : result(FProofResult::UNKNOWN), plies(0), nodes(0), proof_size(0), seconds(0.0), tt_used(0) {}
+};
+
+/**
+ * 证明数搜索（df-pn）求解器
+ * 棋局可以循环，直接证明会受到循环路径的影响（GHI 问题），这里改为证明“攻击方在 N 步内取胜”：
+ * 剩余步数严格递减，搜索图中没有环，置换表中的结果与路径无关。
+ * N 从 1 开始逐步加深，双方交替作为攻击方，找到的是最短的强制取胜。
+ * 置换表大小固定，满时替换子树较小的条目。
+ */
+class ProofSolver
+{
+public:
+	explicit ProofSolver(size_t tt_size_mb = 64);
+
+public:
+	/**
+	 * 求解局面
+	 */
+	FProofStats solve(const Position &pos, const FProofLimits &limits);
+
+	/**
+	 * 清空置换表
+	 */
+	void clear();
+
+private:
+	/**
+	 * 证明数与反证数（攻击方视角）
+	 */
+	struct FProofNumbers
+	{
+		uint32_t	pn;
+		uint32_t	dn;
+	};
+
+	/**
+	 * 置换表条目
+	 * 已证明的条目对不少于 depth 的剩余步数有效，已反证的条目对不超过 depth 的剩余步数有效
+	 */
+	struct FProofEntry
+	{
+		uint64_t	key;
+		uint32_t	pn;
+		uint32_t	dn;
+		uint32_t	work;						// 子树展开的节点数
+		uint16_t	depth;						// 剩余步数
+		uint16_t	padding;
+	};
+
+private:
+	/**
+	 * 证明攻击方在指定步数内取胜
+	 */
+	bool prove(const Position &pos, FChessPieceType attacker, int plies);
+
+	/**
+	 * 多重迭代加深（Multiple Iterative Deepening）
+	 */
+	FProofNumbers mid(Position &pos, uint32_t thpn, uint32_t thdn, int remaining);
+
+	/**
+	 * 查询局面的证明数与反证数（终局、步数用完、置换表，都不是时为初始值）
+	 * @param int* 已证明时返回证明所用的剩余步数
+	 */
+	FProofNumbers lookup(const Position &pos, int remaining, int *proven_depth = nullptr) const;
+
+	/**
+	 * 统计证明树大小
+	 */
+	void countProof(Position &pos, int remaining, std::unordered_set<uint64_t> &visited);
+
+	/**
+	 * 攻击方选择已证明的最短走法，没有时返回-1
+	 */
+	int selectProvenMove(Position &pos, const FMove *moves, int move_num, int remaining) const;
+
+	/**
+	 * 提取取胜变例（防守方选择坚持最久的走法）
+	 */
+	std::vector<FMove> extractLine(const Position &pos, int plies);
+
+	/**
+	 * 置换表
+	 */
+	const FProofEntry* probe(uint64_t key) const;
+
+	void store(uint64_t key, const FProofNumbers &numbers, int depth, uint64_t work);
+
+	uint64_t entryKey(const Position &pos) const;
+
+	size_t countUsedEntries() const;
+
+	/**
+	 * 是否需要停止
+	 */
+	bool shouldStop();
+
+private:
+	ProofSolver(const ProofSolver &) = delete;
+	ProofSolver& operator= (const ProofSolver &) = delete;
+
+private:
+	std::vector<FProofEntry>				table_;
+	size_t									mask_;
+	FChessPieceType							attacker_;
+	FProofLimits							limits_;
+	uint64_t								nodes_;
+	bool									stopped_;
+	std::chrono::steady_clock::time_point	start_time_;
+};
+
+#endif
@@ -0,0 +1,67 @@
+﻿#include "Random.h"
+
+
+namespace
+{
+	inline uint64_t Rotl(uint64_t x, int k)
+	{
+		return (x << k) | (x >> (64 - k));
+	}
+
+	// 使用splitmix64展开种子
+	inline uint64_t SplitMix64(uint64_t &x)
+	{
+		uint64_t z = (x += 0x9e3779b97f4a7c15ULL);
+		z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+		z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+		return z ^ (z >> 31);
+	}
+}
+
+Random::Random(uint64_t seed)
+{
+	this->seed(seed);
+}
+
+// 设置种子
+void Random::seed(uint64_t seed)
+{
+	for (int i = 0; i < 4; ++i)
+	{
+		state_[i] = SplitMix64(seed);
+	}
+}
+
+// 生成64位随机数
+uint64_t Random::next()
+{
+	const uint64_t result = Rotl(state_[1] * 5, 7) * 9;
+	const uint64_t t = state_[1] << 17;
+	state_[2] ^= state_[0];
+	state_[3] ^= state_[1];
+	state_[1] ^= state_[2];
+	state_[0] ^= state_[3];
+	state_[2] ^= t;
+	state_[3] = Rotl(state_[3], 45);
+	return result;
+}
+
+// 生成[0, bound)范围内的随机数
+uint32_t Random::nextInt(uint32_t bound)
+{
+	if (bound <= 1)
+	{
+		return 0;
+	}
+
+	// 拒绝采样，避免取模带来的偏差
+	const uint32_t threshold = (0u - bound) % bound;
+	for (;;)
+	{
+		uint32_t r = static_cast<uint32_t>(next() >> 32);
+		if (r >= threshold)
+		{
+			return r % bound;
+		}
+	}
+}
\ No newline at end of file
@@ -0,0 +1,53 @@
+﻿#ifndef __RANDOM_H__
+#define __RANDOM_H__
+
+#include <cstdint>
+
+/**
+ * 可设置种子的随机数生成器（xoshiro256**）
+ * 相同的种子总是产生相同的序列，不依赖平台和标准库实现
+ */
+class Random
+{
+public:
+	static const uint64_t kDefaultSeed = 0x5eed5eed5eed5eedULL;
+
+public:
+	explicit Random(uint64_t seed = kDefaultSeed);
+
+public:
+	/**
+	 * 设置种子
+	 */
+	void seed(uint64_t seed);
+
+	/**
+	 * 生成64位随机数
+	 */
+	uint64_t next();
+
+	/**
+	 * 生成[0, bound)范围内的随机数
+	 */
+	uint32_t nextInt(uint32_t bound);
+
+	/**
+	 * 随机打乱数组
+	 */
+	template <typename T>
+	void shuffle(T *first, int count)
+	{
+		for (int i = count - 1; i > 0; --i)
+		{
+			int j = static_cast<int>(nextInt(static_cast<uint32_t>(i + 1)));
+			T tmp = first[i];
+			first[i] = first[j];
+			first[j] = tmp;
+		}
+	}
+
+private:
+	uint64_t state_[4];
+};
+
+#endif
\ No newline at end of file
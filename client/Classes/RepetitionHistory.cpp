@@ -0,0 +1,79 @@
+﻿#include "RepetitionHistory.h"
+#include <cassert>
+#include <cstring>
+
+
+RepetitionHistory::RepetitionHistory()
+	: size_(0)
+{
+	memset(slots_, 0, sizeof(slots_));
+}
+
+// 清空
+void RepetitionHistory::clear()
+{
+	// 只清理用到的槽位
+	while (size_ > 0)
+	{
+		pop();
+	}
+}
+
+// 记录局面
+int RepetitionHistory::push(uint64_t key)
+{
+	assert(size_ < kMaxRepetitionHistory);
+	history_[size_++] = key;
+	FSlot &slot = slots_[findSlot(key)];
+	slot.key = key;
+	return ++slot.count;
+}
+
+// 撤销最近一次记录
+void RepetitionHistory::pop()
+{
+	// 按后进先出的顺序撤销，计数归零的槽位之后不会有还在使用的探测链，可以直接当作空槽位
+	assert(size_ > 0);
+	--slots_[findSlot(history_[--size_])].count;
+}
+
+// 局面出现的次数
+int RepetitionHistory::count(uint64_t key) const
+{
+	return slots_[findSlot(key)].count;
+}
+
+// 记录的局面数
+int RepetitionHistory::size() const
+{
+	return size_;
+}
+
+// 保存快照
+void RepetitionHistory::save(FRepetitionSnapshot &snapshot) const
+{
+	memcpy(snapshot.keys, history_, size_ * sizeof(history_[0]));
+	snapshot.size = size_;
+}
+
+// 从快照恢复
+void RepetitionHistory::restore(const FRepetitionSnapshot &snapshot)
+{
+	assert(snapshot.size >= 0 && snapshot.size <= kMaxRepetitionHistory);
+	clear();
+	for (int i = 0; i < snapshot.size; ++i)
+	{
+		push(snapshot.keys[i]);
+	}
+}
+
+// 查找局面所在的槽位
+int RepetitionHistory::findSlot(uint64_t key) const
+{
+	int index = static_cast<int>(key & (kRepetitionSlotNum - 1));
+	while (slots_[index].count != 0 && slots_[index].key != key)
+	{
+		index = (index + 1) & (kRepetitionSlotNum - 1);
+	}
+	return index;
+}
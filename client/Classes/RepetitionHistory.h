@@ -0,0 +1,85 @@
+﻿#ifndef __REPETITIONHISTORY_H__
+#define __REPETITIONHISTORY_H__
+
+#include <cstdint>
+
+static const int kMaxRepetitionHistory = 256;	// 最多记录的局面数
+static const int kRepetitionSlotNum = 512;		// 计数表槽位数（2的幂）
+
+/**
+ * 局面重复历史快照
+ * 只保存局面哈希栈（用到的部分），计数表在恢复时重建
+ */
+struct FRepetitionSnapshot
+{
+	uint64_t	keys[kMaxRepetitionHistory];
+	int			size;
+};
+
+/**
+ * 局面重复历史
+ * 按顺序记录局面哈希（栈），同时用开放寻址的计数表统计每个局面出现的次数，记录和查询都是 O(1)。
+ * 吃子后之前的局面不可能再出现，只需要记录最近一次吃子以来的局面，容量固定，可以直接按值复制。
+ */
+class RepetitionHistory
+{
+public:
+	RepetitionHistory();
+
+public:
+	/**
+	 * 清空
+	 */
+	void clear();
+
+	/**
+	 * 记录局面
+	 * @return int 该局面出现的次数（包括本次）
+	 */
+	int push(uint64_t key);
+
+	/**
+	 * 撤销最近一次记录
+	 */
+	void pop();
+
+	/**
+	 * 局面出现的次数
+	 */
+	int count(uint64_t key) const;
+
+	/**
+	 * 记录的局面数
+	 */
+	int size() const;
+
+	/**
+	 * 保存快照
+	 */
+	void save(FRepetitionSnapshot &snapshot) const;
+
+	/**
+	 * 从快照恢复，按顺序重新记录以重建计数表
+	 */
+	void restore(const FRepetitionSnapshot &snapshot);
+
+private:
+	struct FSlot
+	{
+		uint64_t	key;
+		int32_t		count;						// 为0表示空槽位
+	};
+
+private:
+	/**
+	 * 查找局面所在的槽位，不存在时返回应插入的空槽位
+	 */
+	int findSlot(uint64_t key) const;
+
+private:
+	uint64_t	history_[kMaxRepetitionHistory];
+	FSlot		slots_[kRepetitionSlotNum];
+	int			size_;
+};
+
+#endif
@@ -0,0 +1,257 @@
+﻿#include "ReplayLogic.h"
+#include <cassert>
+#include <algorithm>
+#include "Position.h"
+
+
+namespace
+{
+	const int kSquareShift = 4;
+	const uint8_t kSquareMask = 0x0F;
+
+	// 走法压缩为一个字节
+	uint8_t PackMove(const FMoveTrack &track)
+	{
+		int source = track.source.y * kCheckerboardColNum + track.source.x;
+		int target = track.target.y * kCheckerboardColNum + track.target.x;
+		return static_cast<uint8_t>(source << kSquareShift | target);
+	}
+
+	FVec2 PositionOf(int square)
+	{
+		return FVec2(square % kCheckerboardColNum, square / kCheckerboardColNum);
+	}
+}
+
+ReplayLogic::ReplayLogic(int keyframe_interval)
+	: keyframe_interval_(std::max(keyframe_interval, 1))
+	, ply_(0)
+	, playing_(false)
+	, plies_per_second_(1.0f)
+	, elapsed_(0.0f)
+	, below_player_(FChessPieceType::WHITE)
+{
+	// 没有载入对局时回放空棋盘
+	keyframes_.push_back(saveState());
+}
+
+// 准备开始
+void ReplayLogic::ready()
+{
+	pause();
+	reset();
+	addAction(FActionType::BEREADY, getStandbyChesspieceType(), FVec2::invalid(), FVec2::invalid());
+	restorePly(0);
+	addPositionActions();
+}
+
+// 获取上方玩家棋子类型
+FChessPieceType ReplayLogic::getUpperplayerChesspieceType() const
+{
+	return helper::OpponentOf(below_player_);
+}
+
+// 获取下方玩家棋子类型
+FChessPieceType ReplayLogic::getBelowplayerChesspieceType() const
+{
+	return below_player_;
+}
+
+// 移动棋子
+FMoveTicket ReplayLogic::moveChesspiece(const FVec2 &/*source*/, const FVec2 &/*target*/)
+{
+	return FMoveTicket::invalid();
+}
+
+// 载入对局
+int ReplayLogic::load(const FGameState &initial, const std::vector<FMoveTrack> &moves, FChessPieceType below_player)
+{
+	assert(below_player != FChessPieceType::NONE);
+	pause();
+	reset();
+	below_player_ = below_player;
+	moves_.clear();
+	keyframes_.clear();
+
+	// 完整执行一遍，每隔 K 步保存快照
+	restoreState(initial);
+	keyframes_.push_back(saveState());
+	for (const FMoveTrack &track : moves)
+	{
+		if (playMove(track.source, track.target, true) != FMoveResult::ACCEPTED)
+		{
+			break;
+		}
+		moves_.push_back(PackMove(track));
+		if (moves_.size() % keyframe_interval_ == 0)
+		{
+			keyframes_.push_back(saveState());
+		}
+	}
+
+	restorePly(0);
+	return getPlyNum();
+}
+
+// 从录制的动作流载入对局
+int ReplayLogic::loadActions(const FGameState &initial, const uint8_t *data, size_t size, FChessPieceType below_player)
+{
+	std::vector<FMoveTrack> moves;
+	FAction action;
+	for (size_t offset = 0, used = 0; offset < size; offset += used)
+	{
+		used = helper::DecodeAction(data + offset, size - offset, action);
+		if (used == 0)
+		{
+			break;
+		}
+
+		if (action.type == FActionType::START)
+		{
+			// 新的一局
+			moves.clear();
+		}
+		else if (action.type == FActionType::MOVED || action.type == FActionType::REDO)
+		{
+			FMoveTrack track = { action.source, action.target };
+			moves.push_back(track);
+		}
+		else if (action.type == FActionType::UNDO && action.source != FVec2::invalid() && !moves.empty())
+		{
+			moves.pop_back();
+		}
+	}
+	return load(initial, moves, below_player);
+}
+
+// 跳转到第几步
+void ReplayLogic::seek(int ply)
+{
+	reset();
+	restorePly(std::max(0, std::min(ply, getPlyNum())));
+	addPositionActions();
+}
+
+// 前进一步
+bool ReplayLogic::stepForward()
+{
+	if (ply_ >= getPlyNum())
+	{
+		return false;
+	}
+
+	const uint8_t move = moves_[ply_];
+	FMoveResult result = playMove(PositionOf(move >> kSquareShift), PositionOf(move & kSquareMask), false);
+	assert(result == FMoveResult::ACCEPTED);
+	++ply_;
+	return true;
+}
+
+// 后退一步
+bool ReplayLogic::stepBackward()
+{
+	if (ply_ == 0)
+	{
+		return false;
+	}
+
+	// 悔棋记录只覆盖最近一次跳转之后执行的步数，更早的从快照恢复
+	if (undo())
+	{
+		--ply_;
+	}
+	else
+	{
+		seek(ply_ - 1);
+	}
+	return true;
+}
+
+// 自动播放
+void ReplayLogic::play(float plies_per_second)
+{
+	assert(plies_per_second > 0.0f);
+	playing_ = true;
+	plies_per_second_ = plies_per_second;
+	elapsed_ = 0.0f;
+}
+
+// 暂停
+void ReplayLogic::pause()
+{
+	playing_ = false;
+	elapsed_ = 0.0f;
+}
+
+// 是否正在播放
+bool ReplayLogic::isPlaying() const
+{
+	return playing_;
+}
+
+// 当前是第几步
+int ReplayLogic::getPly() const
+{
+	return ply_;
+}
+
+// 总步数
+int ReplayLogic::getPlyNum() const
+{
+	return static_cast<int>(moves_.size());
+}
+
+// 播放计时
+void ReplayLogic::tick(float dt)
+{
+	if (playing_)
+	{
+		// 每次最多前进一步，卡顿时不会一次产生大量动作
+		const float interval = 1.0f / plies_per_second_;
+		elapsed_ = std::min(elapsed_ + dt, interval);
+		if (elapsed_ >= interval)
+		{
+			elapsed_ -= interval;
+			if (!stepForward())
+			{
+				pause();
+			}
+		}
+	}
+	update(dt);
+}
+
+// 从最近的快照恢复到第几步
+void ReplayLogic::restorePly(int ply)
+{
+	assert(ply >= 0 && ply <= getPlyNum());
+	const int keyframe = ply / keyframe_interval_;
+	restoreState(keyframes_[keyframe]);
+	for (int i = keyframe * keyframe_interval_; i < ply; ++i)
+	{
+		const uint8_t move = moves_[i];
+		FMoveResult result = playMove(PositionOf(move >> kSquareShift), PositionOf(move & kSquareMask), true);
+		assert(result == FMoveResult::ACCEPTED);
+	}
+	ply_ = ply;
+}
+
+// 产生当前局面的动作
+void ReplayLogic::addPositionActions()
+{
+	addAction(FActionType::START, getStandbyChesspieceType(), FVec2::invalid(), FVec2::invalid());
+	if (!isGameOver())
+	{
+		addAction(FActionType::STANDBY, getStandbyChesspieceType(), FVec2::invalid(), FVec2::invalid());
+	}
+	else if (getDrawReason() != FDrawReason::NONE)
+	{
+		addAction(FActionType::DRAW, FChessPieceType::NONE, FVec2::invalid(), FVec2::invalid());
+	}
+	else
+	{
+		// 无棋可走结束时与正常对局一样移除对方剩余的棋子，之后悔棋才能把它们复活
+		addAction(FActionType::GAMEOVER, getStandbyChesspieceType(), FVec2::invalid(), FVec2::invalid());
+		addBlockedActions();
+	}
+}
@@ -0,0 +1,126 @@
+﻿#ifndef __REPLAYLOGIC_H__
+#define __REPLAYLOGIC_H__
+
+#include <vector>
+#include <cstdint>
+#include "LogicBase.h"
+
+static const int kDefaultKeyframeInterval = 16;	// 默认每隔多少步保存一个完整快照
+
+/**
+ * 对局回放
+ * 每隔 K 步保存一个完整的对局快照（FGameState），中间每步只记录一个字节的走法（来源、目标格子）。
+ * 跳转到任意一步时从之前最近的快照恢复，再静默执行不超过 K-1 步，代价为 O(K)，与对局长度无关。
+ * 跳转只产生 START 和待机（或结束）动作，界面直接刷新棋盘；逐步播放时产生与正常对局相同的动作，界面播放动画。
+ */
+class ReplayLogic : public LogicBase
+{
+public:
+	explicit ReplayLogic(int keyframe_interval = kDefaultKeyframeInterval);
+
+public:
+	/**
+	 * 准备开始（回到第0步）
+	 */
+	virtual void ready() override;
+
+	/**
+	 * 获取上方玩家棋子类型
+	 */
+	virtual FChessPieceType getUpperplayerChesspieceType() const override;
+
+	/**
+	 * 获取下方玩家棋子类型
+	 */
+	virtual FChessPieceType getBelowplayerChesspieceType() const override;
+
+	/**
+	 * 移动棋子（回放中不能走棋）
+	 */
+	virtual FMoveTicket moveChesspiece(const FVec2 &source, const FVec2 &target) override;
+
+public:
+	/**
+	 * 载入对局，逐步校验，遇到非法走法时截断
+	 * @param FChessPieceType 显示在下方的一方
+	 * @return int 载入的步数
+	 */
+	int load(const FGameState &initial, const std::vector<FMoveTrack> &moves, FChessPieceType below_player = FChessPieceType::WHITE);
+
+	/**
+	 * 从录制的动作流（helper::EncodeAction 编码）载入对局，悔棋和重做还原为最终的走法序列
+	 * @return int 载入的步数
+	 */
+	int loadActions(const FGameState &initial, const uint8_t *data, size_t size, FChessPieceType below_player = FChessPieceType::WHITE);
+
+	/**
+	 * 跳转到第几步（不播放动画），丢弃未播放的动作
+	 */
+	void seek(int ply);
+
+	/**
+	 * 前进一步（产生正常走棋的动作）
+	 * @return bool 已经是最后一步时返回 false
+	 */
+	bool stepForward();
+
+	/**
+	 * 后退一步（能悔棋时产生悔棋动作，否则跳转）
+	 * @return bool 已经是第0步时返回 false
+	 */
+	bool stepBackward();
+
+	/**
+	 * 自动播放
+	 * @param float 每秒多少步
+	 */
+	void play(float plies_per_second);
+
+	/**
+	 * 暂停
+	 */
+	void pause();
+
+	/**
+	 * 是否正在播放
+	 */
+	bool isPlaying() const;
+
+	/**
+	 * 当前是第几步
+	 */
+	int getPly() const;
+
+	/**
+	 * 总步数
+	 */
+	int getPlyNum() const;
+
+	/**
+	 * 播放计时（每次最多前进一步），然后更新，只在逻辑线程调用
+	 */
+	void tick(float dt);
+
+private:
+	/**
+	 * 从最近的快照恢复到第几步（静默）
+	 */
+	void restorePly(int ply);
+
+	/**
+	 * 产生 START 和当前局面的待机（或结束）动作
+	 */
+	void addPositionActions();
+
+private:
+	int							keyframe_interval_;
+	int							ply_;
+	bool						playing_;
+	float						plies_per_second_;
+	float						elapsed_;
+	FChessPieceType				below_player_;
+	std::vector<uint8_t>		moves_;				// 每步一个字节：来源格子 << 4 | 目标格子
+	std::vector<FGameState>		keyframes_;			// 第 i 个为第 i * K 步的快照
+};
+
+#endif
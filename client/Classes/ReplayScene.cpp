@@ -0,0 +1,280 @@
+﻿#include "ReplayScene.h"
+
+#include <array>
+#include "Language.h"
+#include "VisibleRect.h"
+#include "ColorGenerator.h"
+#include "CheckerboardLayer.h"
+using namespace cocos2d;
+
+
+enum MenuItemType
+{
+	First = 1,
+	Previous,
+	Play,
+	Next,
+	Last,
+	SwitchSpeed,
+	Back,
+};
+
+namespace
+{
+	// 播放速度（每秒步数），动画按同样的倍数加速
+	const std::array<int, 4> kReplaySpeeds = { 1, 2, 4, 8 };
+}
+
+ReplayScene::ReplayScene()
+	: checkerboard_(nullptr)
+	, progress_(nullptr)
+	, play_label_(nullptr)
+	, speed_label_(nullptr)
+	, selected_item_(nullptr)
+	, speed_index_(0)
+{
+
+}
+
+ReplayScene::~ReplayScene()
+{
+
+}
+
+Scene* ReplayScene::createScene(const FGameState &initial, const std::vector<FMoveTrack> &moves, FChessPieceType below_player)
+{
+	auto scene = Scene::create();
+	auto layer = ReplayScene::create();
+	layer->logic_->load(initial, moves, below_player);
+	scene->addChild(layer);
+	return scene;
+}
+
+bool ReplayScene::init()
+{
+	if (!Layer::init())
+	{
+		return false;
+	}
+
+	// 创建菜单
+	std::array<MenuItemType, kMenuItemNum> tags = { First, Previous, Play, Next, Last, SwitchSpeed, Back };
+	std::array<std::string, kMenuItemNum> menu_texts = { "|<", "<", lang("replay_play"), ">", ">|", "x1", lang("back") };
+	float start_x = VisibleRect::rightBottom().x - kMenuItemWidth * kMenuItemNum - kMenuItemInterval * kMenuItemNum;
+	for (int i = 0; i < kMenuItemNum; ++i)
+	{
+		auto menu_item = LayerColor::create();
+		menu_item->setAnchorPoint(Vec2(0.0f, 0.0f));
+		menu_item->initWithColor(Color4B(ColorGenerator::instance()->rand()));
+		menu_item->setContentSize(Size(kMenuItemWidth, kMenuItemHeight));
+		menu_item->ignoreAnchorPointForPosition(false);
+		menu_item->setPosition(Vec2(start_x + i * kMenuItemWidth + i * kMenuItemInterval, VisibleRect::rightBottom().y + kMenuItemInterval));
+		menu_item->setTag(tags[i]);
+		addChild(menu_item);
+
+		auto size = menu_item->getContentSize();
+		auto label = Label::createWithSystemFont(menu_texts[i].c_str(), "", 24);
+		label->setColor(Color3B(0, 0, 0));
+		label->setAnchorPoint(Vec2(0.5f, 0.5f));
+		label->setPosition(Vec2(size.width / 2, size.height / 2));
+		menu_item->addChild(label);
+
+		if (tags[i] == Play)
+		{
+			play_label_ = label;
+		}
+		else if (tags[i] == SwitchSpeed)
+		{
+			speed_label_ = label;
+		}
+	}
+
+	// 棋盘只用于观看
+	logic_.reset(new ReplayLogic());
+	checkerboard_ = CheckerboardLayer::create(logic_.get());
+	checkerboard_->setSpectator(true);
+	addChild(checkerboard_, 1);
+
+	// 播放进度
+	progress_ = Label::createWithSystemFont("", "", 48);
+	progress_->setColor(Color3B(255, 0, 0));
+	progress_->setAnchorPoint(Vec2(0.5f, 0.5f));
+	progress_->setPosition(VisibleRect::top() - Vec2(0, 150));
+	addChild(progress_);
+
+	// 开启触摸
+	auto menu_touch_layer = Layer::create();
+	addChild(menu_touch_layer, 2);
+	auto listener = EventListenerTouchOneByOne::create();
+	listener->setSwallowTouches(true);
+	listener->onTouchBegan = CC_CALLBACK_2(ReplayScene::onTouchBegan, this);
+	listener->onTouchMoved = CC_CALLBACK_2(ReplayScene::onTouchMoved, this);
+	listener->onTouchEnded = CC_CALLBACK_2(ReplayScene::onTouchEnded, this);
+	listener->onTouchCancelled = CC_CALLBACK_2(ReplayScene::onTouchCancelled, this);
+	getEventDispatcher()->addEventListenerWithSceneGraphPriority(listener, menu_touch_layer);
+
+	// 监听回放逻辑
+	logic_->addActionListener(helper::ActionMask(FActionType::BEREADY),
+		std::bind(&ReplayScene::onActions, this, std::placeholders::_1));
+
+	scheduleUpdate();
+
+	return true;
+}
+
+// 回放逻辑动作
+void ReplayScene::onActions(const FActionSpan &actions)
+{
+	for (const FAction &action : actions)
+	{
+		if (action.type == FActionType::BEREADY)
+		{
+			checkerboard_->reset(logic_->getBelowplayerChesspieceType());
+		}
+	}
+}
+
+// 跳转（不播放动画，丢弃正在播放的动画）
+void ReplayScene::seek(int ply)
+{
+	checkerboard_->reset(logic_->getBelowplayerChesspieceType());
+	logic_->seek(ply);
+}
+
+// 播放或暂停
+void ReplayScene::togglePlay()
+{
+	if (logic_->isPlaying())
+	{
+		logic_->pause();
+	}
+	else
+	{
+		// 已经播放完时从头开始
+		if (logic_->getPly() == logic_->getPlyNum())
+		{
+			seek(0);
+		}
+		logic_->play(static_cast<float>(kReplaySpeeds[speed_index_]));
+	}
+}
+
+// 切换播放速度
+void ReplayScene::changeSpeed()
+{
+	speed_index_ = (speed_index_ + 1) % static_cast<int>(kReplaySpeeds.size());
+	speed_label_->setString(StringUtils::format("x%d", kReplaySpeeds[speed_index_]));
+	checkerboard_->setAnimationSpeed(static_cast<float>(kReplaySpeeds[speed_index_]));
+	if (logic_->isPlaying())
+	{
+		logic_->play(static_cast<float>(kReplaySpeeds[speed_index_]));
+	}
+}
+
+// 刷新播放进度
+void ReplayScene::refreshProgress()
+{
+	progress_->setString(StringUtils::format("%d / %d", logic_->getPly(), logic_->getPlyNum()));
+	play_label_->setString(lang(logic_->isPlaying() ? "replay_pause" : "replay_play"));
+}
+
+void ReplayScene::update(float delta)
+{
+	if (logic_.get())
+	{
+		logic_->tick(delta);
+		refreshProgress();
+	}
+}
+
+void ReplayScene::onEnterTransitionDidFinish()
+{
+	logic_->ready();
+}
+
+bool ReplayScene::onTouchBegan(Touch *touch, Event *unused_event)
+{
+	for (int i = First; i <= Back; ++i)
+	{
+		if (getChildByTag(i)->getBoundingBox().containsPoint(touch->getLocation()))
+		{
+			selected_item_ = getChildByTag(i);
+			selected_item_->setOpacity(155);
+			return true;
+		}
+	}
+	return false;
+}
+
+void ReplayScene::onTouchMoved(Touch *touch, Event *unused_event)
+{
+
+}
+
+void ReplayScene::onTouchEnded(Touch *touch, Event *unused_event)
+{
+	for (int i = First; i <= Back; ++i)
+	{
+		if (getChildByTag(i)->getBoundingBox().containsPoint(touch->getLocation()))
+		{
+			if (getChildByTag(i) == selected_item_)
+			{
+				switch ((MenuItemType)i)
+				{
+					case First:
+					{
+						logic_->pause();
+						seek(0);
+						break;
+					}
+					case Previous:
+					{
+						logic_->pause();
+						logic_->stepBackward();
+						break;
+					}
+					case Play:
+					{
+						togglePlay();
+						break;
+					}
+					case Next:
+					{
+						logic_->pause();
+						logic_->stepForward();
+						break;
+					}
+					case Last:
+					{
+						// 快进到结尾，不播放动画
+						logic_->pause();
+						seek(logic_->getPlyNum());
+						break;
+					}
+					case SwitchSpeed:
+					{
+						changeSpeed();
+						break;
+					}
+					case Back:
+					{
+						Director::getInstance()->popScene();
+						break;
+					}
+				}
+			}
+			break;
+		}
+	}
+
+	if (selected_item_ != nullptr)
+	{
+		selected_item_->setOpacity(255);
+		selected_item_ = nullptr;
+	}
+}
+
+void ReplayScene::onTouchCancelled(Touch *touch, Event *unused_event)
+{
+	onTouchEnded(touch, unused_event);
+}
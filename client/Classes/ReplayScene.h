@@ -0,0 +1,65 @@
+﻿#ifndef __REPLAYSCENE_H__
+#define __REPLAYSCENE_H__
+
+#include "cocos2d.h"
+#include "ReplayLogic.h"
+
+class CheckerboardLayer;
+
+class ReplayScene : public cocos2d::Layer
+{
+	static const int kMenuItemInterval = 5;		// 子菜单间距
+	static const int kMenuItemWidth = 85;		// 子菜单宽度
+	static const int kMenuItemHeight = 100;		// 子菜单高度
+	static const int kMenuItemNum = 7;			// 子菜单数量
+
+public:
+	ReplayScene();
+
+	~ReplayScene();
+
+	/**
+	 * 创建回放场景
+	 * @param FChessPieceType 显示在下方的一方
+	 */
+	static cocos2d::Scene* createScene(const FGameState &initial, const std::vector<FMoveTrack> &moves, FChessPieceType below_player);
+
+	virtual bool init() override;
+
+	CREATE_FUNC(ReplayScene);
+
+public:
+	virtual bool onTouchBegan(cocos2d::Touch *touch, cocos2d::Event *unused_event) override;
+
+	virtual void onTouchMoved(cocos2d::Touch *touch, cocos2d::Event *unused_event) override;
+
+	virtual void onTouchEnded(cocos2d::Touch *touch, cocos2d::Event *unused_event) override;
+
+	virtual void onTouchCancelled(cocos2d::Touch *touch, cocos2d::Event *unused_event) override;
+
+private:
+	void onActions(const FActionSpan &actions);
+
+	void seek(int ply);
+
+	void togglePlay();
+
+	void changeSpeed();
+
+	void refreshProgress();
+
+	virtual void update(float delta) override;
+
+	virtual void onEnterTransitionDidFinish() override;
+
+private:
+	CheckerboardLayer*							checkerboard_;
+	cocos2d::Label*								progress_;
+	cocos2d::Label*								play_label_;
+	cocos2d::Label*								speed_label_;
+	cocos2d::Node*								selected_item_;
+	std::auto_ptr<ReplayLogic>					logic_;
+	int											speed_index_;
+};
+
+#endif
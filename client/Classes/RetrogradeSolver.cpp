@@ -0,0 +1,370 @@
+﻿#include "RetrogradeSolver.h"
+#include <chrono>
+#include <thread>
+#include <vector>
+#include <fstream>
+#include <algorithm>
+
+
+namespace
+{
+	static_assert(kSquareNum == 16, "board index assumes a 4x4 checkerboard");
+
+	// 半个棋盘（8个格子）的三进制索引数量
+	const int kHalfIndexNum = 6561;
+
+	// 每次领取的索引数量
+	const uint64_t kChunkSize = 1 << 16;
+
+	// 局面状态：最高位表示已确定，次高位表示必胜，低14位为步数
+	const uint16_t kStatusUnknown = 0;
+	const uint16_t kStatusInvalid = 0x7FFF;
+	const uint16_t kStatusDecided = 0x8000;
+	const uint16_t kStatusWin = 0x4000;
+	const uint16_t kDistanceMask = 0x3FFF;
+
+	/**
+	 * 三进制索引与位棋盘互相转换的表
+	 */
+	struct FIndexTables
+	{
+		uint8_t		white[kHalfIndexNum];
+		uint8_t		black[kHalfIndexNum];
+		uint16_t	index[256][256];
+	};
+
+	const FIndexTables& GetIndexTables()
+	{
+		static FIndexTables *tables = []()
+		{
+			FIndexTables *t = new FIndexTables();
+			for (int i = 0; i < kHalfIndexNum; ++i)
+			{
+				int value = i;
+				int white = 0;
+				int black = 0;
+				for (int square = 0; square < 8; ++square)
+				{
+					int digit = value % 3;
+					value /= 3;
+					white |= (digit == 1) << square;
+					black |= (digit == 2) << square;
+				}
+				t->white[i] = static_cast<uint8_t>(white);
+				t->black[i] = static_cast<uint8_t>(black);
+				t->index[white][black] = static_cast<uint16_t>(i);
+			}
+			return t;
+		}();
+		return *tables;
+	}
+
+	inline FBitboard RowMask(int square)
+	{
+		return static_cast<FBitboard>(0xF << (square / kCheckerboardColNum * kCheckerboardColNum));
+	}
+
+	inline FBitboard ColumnMask(int square)
+	{
+		return static_cast<FBitboard>(0x1111 << (square % kCheckerboardColNum));
+	}
+
+	// 每条线最多吃掉一颗棋子，列出所有可能（不吃或吃掉其中一格）
+	inline int KillOptions(FBitboard candidates, FBitboard *options)
+	{
+		int num = 0;
+		options[num++] = 0;
+		while (candidates)
+		{
+			options[num++] = candidates & (~candidates + 1);
+			candidates &= candidates - 1;
+		}
+		return num;
+	}
+
+	// 枚举所有走一步可以到达当前局面的父局面
+	template <typename Func>
+	void ForEachParent(const Position &pos, Func func)
+	{
+		const FChessPieceType side = pos.getSideToMove();
+		const FChessPieceType mover = helper::OpponentOf(side);
+		const FBitboard own = pos.getPieces(mover);
+		const FBitboard other = pos.getPieces(side);
+		const FBitboard empty = static_cast<FBitboard>(~(own | other));
+
+		FBitboard targets = own;
+		while (targets)
+		{
+			const int target = helper::LowestSquare(targets);
+			targets &= targets - 1;
+
+			FBitboard sources = helper::AdjacentSquares(target) & empty;
+			while (sources)
+			{
+				const int source = helper::LowestSquare(sources);
+				sources &= sources - 1;
+
+				// 被吃掉的棋子只可能在落子的行、列上的空格中
+				const FBitboard parent_own = static_cast<FBitboard>((own & ~(1 << target)) | (1 << source));
+				const FBitboard killable = static_cast<FBitboard>(empty & ~(1 << source));
+				FBitboard row_options[kCheckerboardColNum + 1];
+				FBitboard column_options[kCheckerboardRowNum + 1];
+				int row_num = KillOptions(killable & RowMask(target), row_options);
+				int column_num = KillOptions(killable & ColumnMask(target), column_options);
+
+				FMove move = { static_cast<uint8_t>(source), static_cast<uint8_t>(target) };
+				for (int r = 0; r < row_num; ++r)
+				{
+					for (int c = 0; c < column_num; ++c)
+					{
+						const FBitboard parent_other = other | row_options[r] | column_options[c];
+						Position parent = mover == FChessPieceType::WHITE
+							? Position::fromBitboards(parent_own, parent_other, mover)
+							: Position::fromBitboards(parent_other, parent_own, mover);
+						if (parent.isLost())
+						{
+							continue;
+						}
+
+						// 正向走棋校验吃子
+						Position child = parent;
+						child.makeMove(move);
+						if (child.getPieces(mover) == own && child.getPieces(side) == other)
+						{
+							func(parent);
+						}
+					}
+				}
+			}
+		}
+	}
+}
+
+RetrogradeSolver::RetrogradeSolver()
+	: status_(new std::atomic<uint16_t>[kRetroPositionNum])
+	, child_counts_(new std::atomic<uint8_t>[kRetroPositionNum])
+{
+	GetIndexTables();
+}
+
+// 求解
+void RetrogradeSolver::solve(int thread_num, const std::function<void(const FRetroProgress &)> &callback)
+{
+	thread_num = std::max(thread_num, 1);
+	uint64_t total = 0;
+	for (int iteration = 0; ; ++iteration)
+	{
+		auto start = std::chrono::steady_clock::now();
+		FCounter counter;
+		if (iteration == 0)
+		{
+			counter = parallelFor(thread_num, [this](uint64_t begin, uint64_t end, FCounter &c)
+			{
+				initialize(begin, end, c);
+			});
+		}
+		else
+		{
+			counter = parallelFor(thread_num, [this, iteration](uint64_t begin, uint64_t end, FCounter &c)
+			{
+				propagate(begin, end, iteration, c);
+			});
+		}
+		total += counter.wins + counter.losses;
+
+		FRetroProgress progress;
+		progress.iteration = iteration;
+		progress.wins = counter.wins;
+		progress.losses = counter.losses;
+		progress.total = total;
+		progress.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+		if (callback)
+		{
+			callback(progress);
+		}
+
+		// 没有新确定的局面时，剩下的都是和棋
+		if (counter.wins + counter.losses == 0 || iteration >= kDistanceMask)
+		{
+			break;
+		}
+	}
+}
+
+// 获取局面结果
+FRetroResult RetrogradeSolver::getResult(uint64_t index) const
+{
+	uint16_t status = status_[index].load(std::memory_order_relaxed);
+	if (status == kStatusInvalid)
+	{
+		return FRetroResult::INVALID;
+	}
+	if (!(status & kStatusDecided))
+	{
+		return FRetroResult::DRAW;
+	}
+	return status & kStatusWin ? FRetroResult::WIN : FRetroResult::LOSS;
+}
+
+// 获取取胜或失败的步数
+int RetrogradeSolver::getDistance(uint64_t index) const
+{
+	uint16_t status = status_[index].load(std::memory_order_relaxed);
+	return status & kStatusDecided ? status & kDistanceMask : 0;
+}
+
+// 保存结果
+bool RetrogradeSolver::save(const std::string &filename) const
+{
+	std::ofstream out(filename.c_str(), std::ios::binary);
+	if (!out)
+	{
+		return false;
+	}
+
+	const uint64_t count = kRetroPositionNum;
+	out.write(kRetroFileMagic, sizeof(kRetroFileMagic));
+	out.write(reinterpret_cast<const char *>(&kRetroFileVersion), sizeof(kRetroFileVersion));
+	out.write(reinterpret_cast<const char *>(&count), sizeof(count));
+
+	std::vector<uint16_t> buffer(kChunkSize);
+	for (uint64_t begin = 0; begin < count; begin += kChunkSize)
+	{
+		uint64_t end = std::min(begin + kChunkSize, count);
+		for (uint64_t i = begin; i < end; ++i)
+		{
+			buffer[i - begin] = status_[i].load(std::memory_order_relaxed);
+		}
+		out.write(reinterpret_cast<const char *>(buffer.data()), (end - begin) * sizeof(uint16_t));
+	}
+	return static_cast<bool>(out);
+}
+
+// 局面索引
+uint64_t RetrogradeSolver::indexOf(const Position &pos)
+{
+	const FIndexTables &tables = GetIndexTables();
+	const FBitboard white = pos.getPieces(FChessPieceType::WHITE);
+	const FBitboard black = pos.getPieces(FChessPieceType::BLACK);
+	uint64_t board = static_cast<uint64_t>(tables.index[white >> 8][black >> 8]) * kHalfIndexNum
+		+ tables.index[white & 0xFF][black & 0xFF];
+	return board * 2 + (pos.getSideToMove() == FChessPieceType::BLACK ? 1 : 0);
+}
+
+// 由索引还原局面
+Position RetrogradeSolver::positionAt(uint64_t index)
+{
+	const FIndexTables &tables = GetIndexTables();
+	const uint64_t board = index >> 1;
+	const int high = static_cast<int>(board / kHalfIndexNum);
+	const int low = static_cast<int>(board % kHalfIndexNum);
+	FBitboard white = static_cast<FBitboard>(tables.white[low] | (tables.white[high] << 8));
+	FBitboard black = static_cast<FBitboard>(tables.black[low] | (tables.black[high] << 8));
+	return Position::fromBitboards(white, black, index & 1 ? FChessPieceType::BLACK : FChessPieceType::WHITE);
+}
+
+// 多线程遍历所有局面
+RetrogradeSolver::FCounter RetrogradeSolver::parallelFor(int thread_num, const std::function<void(uint64_t, uint64_t, FCounter &)> &func)
+{
+	std::atomic<uint64_t> next(0);
+	std::vector<FCounter> counters(thread_num, FCounter());
+	std::vector<std::thread> threads;
+	for (int t = 0; t < thread_num; ++t)
+	{
+		threads.emplace_back([&, t]()
+		{
+			FCounter &counter = counters[t];
+			counter.wins = counter.losses = 0;
+			for (uint64_t begin = next.fetch_add(kChunkSize); begin < kRetroPositionNum; begin = next.fetch_add(kChunkSize))
+			{
+				func(begin, std::min(begin + kChunkSize, kRetroPositionNum), counter);
+			}
+		});
+	}
+
+	FCounter result = { 0, 0 };
+	for (int t = 0; t < thread_num; ++t)
+	{
+		threads[t].join();
+		result.wins += counters[t].wins;
+		result.losses += counters[t].losses;
+	}
+	return result;
+}
+
+// 初始化
+void RetrogradeSolver::initialize(uint64_t begin, uint64_t end, FCounter &counter)
+{
+	FMove moves[kMaxMoveNum];
+	for (uint64_t index = begin; index < end; ++index)
+	{
+		Position pos = positionAt(index);
+		FChessPieceType opponent = helper::OpponentOf(pos.getSideToMove());
+		uint16_t status = kStatusUnknown;
+		uint8_t count = 0;
+		if (pos.isLost())
+		{
+			status = kStatusDecided;
+			++counter.losses;
+		}
+		else if (helper::PopCount(pos.getPieces(opponent)) <= 1)
+		{
+			status = kStatusInvalid;
+		}
+		else
+		{
+			count = static_cast<uint8_t>(pos.generateMoves(moves));
+		}
+		status_[index].store(status, std::memory_order_relaxed);
+		child_counts_[index].store(count, std::memory_order_relaxed);
+	}
+}
+
+// 逆推
+void RetrogradeSolver::propagate(uint64_t begin, uint64_t end, int iteration, FCounter &counter)
+{
+	const uint16_t previous = static_cast<uint16_t>(kStatusDecided | (iteration - 1));
+	for (uint64_t index = begin; index < end; ++index)
+	{
+		uint16_t status = status_[index].load(std::memory_order_relaxed);
+		if ((status & ~kStatusWin) != previous)
+		{
+			continue;
+		}
+
+		const bool child_win = (status & kStatusWin) != 0;
+		ForEachParent(positionAt(index), [&](const Position &parent)
+		{
+			uint64_t parent_index = indexOf(parent);
+			if (status_[parent_index].load(std::memory_order_relaxed) != kStatusUnknown)
+			{
+				return;
+			}
+
+			if (!child_win)
+			{
+				// 可以走到对方必败的局面
+				if (decide(parent_index, true, iteration))
+				{
+					++counter.wins;
+				}
+			}
+			else if (child_counts_[parent_index].fetch_sub(1, std::memory_order_relaxed) == 1)
+			{
+				// 所有走法都走到对方必胜的局面
+				if (decide(parent_index, false, iteration))
+				{
+					++counter.losses;
+				}
+			}
+		});
+	}
+}
+
+// 标记为已确定
+bool RetrogradeSolver::decide(uint64_t index, bool win, int distance)
+{
+	uint16_t expected = kStatusUnknown;
+	uint16_t status = static_cast<uint16_t>(kStatusDecided | (win ? kStatusWin : 0) | distance);
+	return status_[index].compare_exchange_strong(expected, status, std::memory_order_relaxed);
+}
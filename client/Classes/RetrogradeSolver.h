@@ -0,0 +1,125 @@
+﻿#ifndef __RETROGRADESOLVER_H__
+#define __RETROGRADESOLVER_H__
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <cstdint>
+#include <functional>
+#include "Position.h"
+
+static const uint64_t kBoardIndexNum = 43046721;				// 3^16，每个格子为空、白棋、黑棋
+static const uint64_t kRetroPositionNum = kBoardIndexNum * 2;	// 再乘以走棋方
+static const uint32_t kRetroFileVersion = 1;
+static const char kRetroFileMagic[4] = { 'S', 'S', 'C', 'R' };
+
+/**
+ * 逆推结果（走棋方视角）
+ */
+enum class FRetroResult
+{
+	DRAW,										// 双方都无法强制取胜
+	WIN,										// 走棋方必胜
+	LOSS,										// 走棋方必败
+	INVALID,									// 对局已经结束，不会出现的局面
+};
+
+/**
+ * 每一轮逆推的进度
+ */
+struct FRetroProgress
+{
+	int			iteration;						// 轮次（0为初始化）
+	uint64_t	wins;							// 本轮新确定的必胜局面
+	uint64_t	losses;							// 本轮新确定的必败局面
+	uint64_t	total;							// 累计确定的局面
+	double		seconds;						// 本轮耗时
+};
+
+/**
+ * 多线程逆推求解器，求出所有局面的胜负及步数
+ * 局面索引 = (以三进制表示的棋盘) * 2 + 走棋方，每一轮按索引范围分块，由各线程领取；
+ * 局面状态和剩余子节点数使用原子变量，多个线程可以同时更新同一个父局面。
+ * 第 k 轮从第 k-1 轮确定的局面出发，枚举所有父局面（包括吃子前的局面，用正向走棋校验）：
+ * 子局面必败则父局面必胜；父局面的子节点全部必胜时父局面必败。
+ */
+class RetrogradeSolver
+{
+public:
+	RetrogradeSolver();
+
+public:
+	/**
+	 * 求解
+	 * @param int 线程数
+	 * @param function 每一轮结束后的回调
+	 */
+	void solve(int thread_num, const std::function<void(const FRetroProgress &)> &callback);
+
+	/**
+	 * 获取局面结果
+	 */
+	FRetroResult getResult(uint64_t index) const;
+
+	/**
+	 * 获取取胜或失败的步数
+	 */
+	int getDistance(uint64_t index) const;
+
+	/**
+	 * 保存结果（文件头后每个局面两个字节）
+	 */
+	bool save(const std::string &filename) const;
+
+public:
+	/**
+	 * 局面索引
+	 */
+	static uint64_t indexOf(const Position &pos);
+
+	/**
+	 * 由索引还原局面
+	 */
+	static Position positionAt(uint64_t index);
+
+private:
+	/**
+	 * 线程统计
+	 */
+	struct FCounter
+	{
+		uint64_t	wins;
+		uint64_t	losses;
+	};
+
+private:
+	/**
+	 * 多线程遍历所有局面，各线程按块领取索引范围
+	 */
+	FCounter parallelFor(int thread_num, const std::function<void(uint64_t, uint64_t, FCounter &)> &func);
+
+	/**
+	 * 初始化[begin, end)范围内的局面
+	 */
+	void initialize(uint64_t begin, uint64_t end, FCounter &counter);
+
+	/**
+	 * 从[begin, end)范围内上一轮确定的局面逆推
+	 */
+	void propagate(uint64_t begin, uint64_t end, int iteration, FCounter &counter);
+
+	/**
+	 * 将局面标记为已确定，局面已确定时返回 false
+	 */
+	bool decide(uint64_t index, bool win, int distance);
+
+private:
+	RetrogradeSolver(const RetrogradeSolver &) = delete;
+	RetrogradeSolver& operator= (const RetrogradeSolver &) = delete;
+
+private:
+	std::unique_ptr<std::atomic<uint16_t>[]>	status_;
+	std::unique_ptr<std::atomic<uint8_t>[]>		child_counts_;
+};
+
+#endif
@@ -0,0 +1,734 @@
+﻿#include "Search.h"
+#include <cassert>
+#include <cstdio>
+#include <cstdlib>
+#include <algorithm>
+#include <functional>
+
+
+namespace
+{
+	// 每搜索多少个节点检查一次时间
+	const uint64_t kTimeCheckInterval = 1024;
+
+	// 主要变例最大长度
+	const int kMaxPvLength = 32;
+
+	// 分片搜索每前进多少步检查一次时间预算
+	const int kSliceCheckInterval = 64;
+
+	// 走法生成、评估每调用多少次计时一次（每次都计时的开销与被测函数相当）
+	const uint64_t kTimingSampleInterval = 16;
+
+	// 根节点走法的 alpha：前 multi_pv 个走法需要精确分数，之后的走法只需要证明不如第 multi_pv 名
+	inline int RootAlpha(const int *iteration_scores, int searched, int multi_pv)
+	{
+		if (searched < multi_pv)
+		{
+			return -kMateScore - 1;
+		}
+		int sorted[kMaxMoveNum];
+		std::copy(iteration_scores, iteration_scores + searched, sorted);
+		std::nth_element(sorted, sorted + multi_pv - 1, sorted + searched, std::greater<int>());
+		return sorted[multi_pv - 1];
+	}
+
+	// 置换表走法排到最前
+	inline void OrderMoves(FMove *moves, int move_num, const FMove &tt_move)
+	{
+		if (!tt_move.isValid())
+		{
+			return;
+		}
+		for (int i = 1; i < move_num; ++i)
+		{
+			if (moves[i] == tt_move)
+			{
+				std::swap(moves[0], moves[i]);
+				break;
+			}
+		}
+	}
+
+	// 抽样计时调用
+	template <typename Func>
+	inline int SampledCall(FSampledTimer &timer, Func func)
+	{
+		if (++timer.calls % kTimingSampleInterval != 0)
+		{
+			return func();
+		}
+		auto start = std::chrono::steady_clock::now();
+		int result = func();
+		++timer.samples;
+		timer.sampled_ns += std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+		return result;
+	}
+
+	// 胜负分数存入置换表时转换为相对当前节点的距离
+	inline int ScoreToTT(int score, int ply)
+	{
+		return score >= kMateScore - kMaxSearchDepth ? score + ply
+			: score <= -kMateScore + kMaxSearchDepth ? score - ply : score;
+	}
+
+	inline int ScoreFromTT(int score, int ply)
+	{
+		return score >= kMateScore - kMaxSearchDepth ? score - ply
+			: score <= -kMateScore + kMaxSearchDepth ? score + ply : score;
+	}
+}
+
+Search::Search()
+	: network_(nullptr)
+	, tt_(nullptr)
+	, tt_shared_(false)
+	, nodes_(0)
+	, stopped_(false)
+{
+
+}
+
+// 搜索最佳走法
+FSearchResult Search::run(const Position &pos, const FSearchLimits &limits, Random &random)
+{
+	prepare(limits);
+
+	FSearchResult result;
+	FMove moves[kMaxMoveNum];
+	int move_num = pos.generateMoves(moves);
+	if (move_num == 0)
+	{
+		return result;
+	}
+
+	// 打乱根节点走法，分数相同的走法由随机数种子决定
+	random.shuffle(moves, move_num);
+
+	int scores[kMaxMoveNum];
+	stats_ = collectStats(searchRoot(pos, moves, move_num, 1, scores), -1.0);
+	stats_.pv = extractPv(pos, moves[0]);
+	result.best_move = moves[0];
+	result.score = scores[0];
+	result.stats = stats_;
+	return result;
+}
+
+// 多变例分析
+std::vector<FAnalysisLine> Search::analyze(const Position &pos, const FSearchLimits &limits, int multi_pv)
+{
+	prepare(limits);
+
+	std::vector<FAnalysisLine> lines;
+	FMove moves[kMaxMoveNum];
+	int move_num = pos.generateMoves(moves);
+	if (move_num == 0)
+	{
+		return lines;
+	}
+
+	int scores[kMaxMoveNum];
+	multi_pv = std::min(std::max(multi_pv, 1), move_num);
+	stats_ = collectStats(searchRoot(pos, moves, move_num, multi_pv, scores), -1.0);
+	for (int i = 0; i < multi_pv; ++i)
+	{
+		FAnalysisLine line;
+		line.move = moves[i];
+		line.score = scores[i];
+		line.pv = extractPv(pos, moves[i]);
+		lines.push_back(line);
+	}
+	return lines;
+}
+
+// 开始搜索前的初始化
+void Search::prepare(const FSearchLimits &limits)
+{
+	limits_ = limits;
+	nodes_ = 0;
+	stopped_ = false;
+	start_time_ = std::chrono::steady_clock::now();
+	stats_ = FSearchStats();
+	movegen_timer_.reset();
+	eval_timer_.reset();
+	if (tt_ != nullptr && !tt_shared_)
+	{
+		tt_->newSearch();
+	}
+}
+
+// 汇总统计
+FSearchStats Search::collectStats(int depth, double active_ms) const
+{
+	FSearchStats stats = stats_;
+	stats.nodes = nodes_;
+	stats.depth = depth;
+	stats.movegen_ms = movegen_timer_.estimateMs();
+	stats.eval_ms = eval_timer_.estimateMs();
+	stats.total_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start_time_).count();
+	active_ms = active_ms < 0.0 ? stats.total_ms : active_ms;
+	stats.nps = active_ms > 0.0 ? static_cast<uint64_t>(nodes_ * 1000.0 / active_ms) : 0;
+	return stats;
+}
+
+// 根节点迭代加深
+int Search::searchRoot(const Position &pos, FMove *moves, int move_num, int multi_pv, int *scores)
+{
+	Position root = pos;
+	if (network_ != nullptr)
+	{
+		network_->refresh(root, accumulators_[0]);
+	}
+
+	for (int i = 0; i < move_num; ++i)
+	{
+		scores[i] = 0;
+	}
+
+	int completed_depth = 0;
+	int max_depth = std::min(std::max(limits_.max_depth, 1), kMaxSearchDepth);
+	for (int depth = 1; depth <= max_depth; ++depth)
+	{
+		int iteration_scores[kMaxMoveNum];
+		int i = 0;
+		for (; i < move_num; ++i)
+		{
+			int alpha = RootAlpha(iteration_scores, i, multi_pv);
+			FBitboard killed = makeMove(root, moves[i], 0);
+			iteration_scores[i] = -negamax(root, depth - 1, -kMateScore - 1, -alpha, 1);
+			root.unmakeMove(moves[i], killed);
+			if (stopped_)
+			{
+				break;
+			}
+		}
+
+		// 未完成的迭代不可信，使用上一次迭代的结果
+		if (i < move_num)
+		{
+			break;
+		}
+
+		completed_depth = depth;
+		if (finishIteration(root, moves, move_num, iteration_scores, scores, depth))
+		{
+			break;
+		}
+	}
+
+	return completed_depth;
+}
+
+// 完成一次根节点迭代
+bool Search::finishIteration(const Position &root, FMove *moves, int move_num, const int *iteration_scores, int *scores, int depth)
+{
+	int order[kMaxMoveNum];
+	for (int i = 0; i < move_num; ++i)
+	{
+		order[i] = i;
+	}
+	std::stable_sort(order, order + move_num, [&](int a, int b)
+	{
+		return iteration_scores[a] > iteration_scores[b];
+	});
+
+	FMove sorted_moves[kMaxMoveNum];
+	for (int i = 0; i < move_num; ++i)
+	{
+		sorted_moves[i] = moves[order[i]];
+		scores[i] = iteration_scores[order[i]];
+	}
+	std::copy(sorted_moves, sorted_moves + move_num, moves);
+
+	if (tt_ != nullptr)
+	{
+		tt_->store(root.getHash(), moves[0], scores[0], depth, FBoundType::EXACT);
+	}
+
+	// 已经分出胜负
+	return std::abs(scores[0]) >= kMateScore - kMaxSearchDepth;
+}
+
+// 设置评估权重
+void Search::setEvalWeights(const FEvalWeights &weights)
+{
+	evaluation_.setWeights(weights);
+}
+
+// 获取评估函数
+const Evaluation& Search::getEvaluation() const
+{
+	return evaluation_;
+}
+
+// 设置神经网络评估
+void Search::setNetwork(const NNUENetwork *network)
+{
+	network_ = network;
+}
+
+// 设置置换表
+void Search::setTranspositionTable(TranspositionTable *tt, bool shared)
+{
+	tt_ = tt;
+	tt_shared_ = shared;
+}
+
+// 获取最近一次搜索的统计
+const FSearchStats& Search::getLastStats() const
+{
+	return stats_;
+}
+
+// 负极大值搜索
+int Search::negamax(Position &pos, int depth, int alpha, int beta, int ply)
+{
+	uint64_t key = 0;
+	FMove tt_move = FMove::invalid();
+	int score = 0;
+	if (resolveNode(pos, depth, alpha, beta, ply, key, tt_move, score))
+	{
+		return score;
+	}
+
+	FMove moves[kMaxMoveNum];
+	int move_num = generateMoves(pos, moves);
+	OrderMoves(moves, move_num, tt_move);
+
+	const int original_alpha = alpha;
+	int best_score = -kMateScore - 1;
+	FMove best_move = FMove::invalid();
+	for (int i = 0; i < move_num; ++i)
+	{
+		FBitboard killed = makeMove(pos, moves[i], ply);
+		score = -negamax(pos, depth - 1, -beta, -alpha, ply + 1);
+		pos.unmakeMove(moves[i], killed);
+		if (stopped_)
+		{
+			return 0;
+		}
+		if (score > best_score)
+		{
+			best_score = score;
+			best_move = moves[i];
+			if (score > alpha)
+			{
+				alpha = score;
+				if (alpha >= beta)
+				{
+					++stats_.beta_cutoffs;
+					stats_.first_move_cutoffs += i == 0;
+					break;
+				}
+			}
+		}
+	}
+
+	storeNode(key, depth, original_alpha, beta, best_score, best_move, ply);
+	return best_score;
+}
+
+// 节点的公共处理
+bool Search::resolveNode(const Position &pos, int depth, int alpha, int beta, int ply, uint64_t &key, FMove &tt_move, int &score)
+{
+	++nodes_;
+	stats_.seldepth = std::max(stats_.seldepth, ply);
+	if (shouldStop())
+	{
+		score = 0;
+		return true;
+	}
+
+	if (pos.isLost())
+	{
+		score = -kMateScore + ply;
+		return true;
+	}
+
+	if (depth <= 0 || ply >= kMaxSearchDepth)
+	{
+		score = evaluate(pos, ply);
+		return true;
+	}
+
+	// 查询置换表
+	key = pos.getHash();
+	if (tt_ != nullptr)
+	{
+		FTTEntry entry;
+		++stats_.tt_probes;
+		if (tt_->probe(key, entry))
+		{
+			++stats_.tt_hits;
+			tt_move = entry.move;
+			if (entry.depth >= depth)
+			{
+				score = ScoreFromTT(entry.score, ply);
+				if (entry.bound == FBoundType::EXACT
+					|| (entry.bound == FBoundType::LOWER && score >= beta)
+					|| (entry.bound == FBoundType::UPPER && score <= alpha))
+				{
+					++stats_.tt_cutoffs;
+					return true;
+				}
+			}
+		}
+	}
+	return false;
+}
+
+// 节点搜索完成后存入置换表
+void Search::storeNode(uint64_t key, int depth, int original_alpha, int beta, int best_score, const FMove &best_move, int ply)
+{
+	if (tt_ != nullptr)
+	{
+		FBoundType bound = best_score >= beta ? FBoundType::LOWER
+			: best_score > original_alpha ? FBoundType::EXACT : FBoundType::UPPER;
+		tt_->store(key, bound == FBoundType::UPPER ? FMove::invalid() : best_move, ScoreToTT(best_score, ply), depth, bound);
+	}
+}
+
+// 开始分片搜索
+void Search::start(const Position &pos, const FSearchLimits &limits, Random &random)
+{
+	prepare(limits);
+
+	slice_ = FSliceState();
+	slice_.root = pos;
+	slice_.move_num = pos.generateMoves(slice_.moves);
+	if (slice_.move_num == 0)
+	{
+		stats_ = collectStats(0, 0.0);
+		return;
+	}
+
+	random.shuffle(slice_.moves, slice_.move_num);
+	std::fill(slice_.scores, slice_.scores + slice_.move_num, 0);
+	if (network_ != nullptr)
+	{
+		network_->refresh(slice_.root, accumulators_[0]);
+	}
+	if (frames_.empty())
+	{
+		frames_.resize(kMaxSearchDepth + 1);
+	}
+
+	slice_.running = true;
+	slice_.depth = 1;
+	slice_.max_depth = std::min(std::max(limits_.max_depth, 1), kMaxSearchDepth);
+	slice_.root_index = 0;
+	slice_.top = 0;
+	slice_.has_result = false;
+}
+
+// 执行分片搜索
+bool Search::step(int budget_us)
+{
+	if (!slice_.running)
+	{
+		return true;
+	}
+
+	auto slice_start = std::chrono::steady_clock::now();
+	auto deadline = slice_start + std::chrono::microseconds(std::max(budget_us, 0));
+	bool finished = false;
+	for (int n = 1; !finished; ++n)
+	{
+		finished = advance();
+		if (n % kSliceCheckInterval == 0 && std::chrono::steady_clock::now() >= deadline)
+		{
+			break;
+		}
+	}
+
+	++slice_.slices;
+	slice_.active_ms += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - slice_start).count();
+	if (finished)
+	{
+		slice_.running = false;
+		stats_ = collectStats(slice_.completed_depth, slice_.active_ms);
+		stats_.slices = slice_.slices;
+		stats_.pv = extractPv(slice_.root, slice_.moves[0]);
+	}
+	return finished;
+}
+
+// 是否有正在进行的分片搜索
+bool Search::isRunning() const
+{
+	return slice_.running;
+}
+
+// 取消分片搜索
+void Search::cancel()
+{
+	slice_.running = false;
+}
+
+// 获取分片搜索的结果
+FSearchResult Search::getResult() const
+{
+	FSearchResult result;
+	if (slice_.move_num > 0)
+	{
+		result.best_move = slice_.moves[0];
+		result.score = slice_.scores[0];
+	}
+	if (slice_.running)
+	{
+		result.stats = collectStats(slice_.completed_depth, slice_.active_ms);
+		result.stats.slices = slice_.slices;
+	}
+	else
+	{
+		result.stats = stats_;
+	}
+	return result;
+}
+
+// 分片搜索进入节点
+bool Search::enterFrame(int ply, int depth, int alpha, int beta, int &score)
+{
+	FSearchFrame &frame = frames_[ply];
+	FMove tt_move = FMove::invalid();
+	if (resolveNode(slice_.root, depth, alpha, beta, ply, frame.key, tt_move, score))
+	{
+		return true;
+	}
+
+	frame.move_num = generateMoves(slice_.root, frame.moves);
+	OrderMoves(frame.moves, frame.move_num, tt_move);
+	frame.index = 0;
+	frame.depth = depth;
+	frame.alpha = alpha;
+	frame.beta = beta;
+	frame.original_alpha = alpha;
+	frame.best_score = -kMateScore - 1;
+	frame.best_move = FMove::invalid();
+	return false;
+}
+
+// 分片搜索前进一步
+bool Search::advance()
+{
+	FSliceState &s = slice_;
+	Position &pos = s.root;
+
+	// 根节点
+	if (s.top == 0)
+	{
+		if (!s.has_result)
+		{
+			int alpha = RootAlpha(s.iteration_scores, s.root_index, 1);
+			s.root_killed = makeMove(pos, s.moves[s.root_index], 0);
+			if (enterFrame(1, s.depth - 1, -kMateScore - 1, -alpha, s.child_score))
+			{
+				s.has_result = true;
+			}
+			else
+			{
+				s.top = 1;
+			}
+			return false;
+		}
+
+		// 未完成的迭代不可信，使用上一次迭代的结果
+		s.has_result = false;
+		pos.unmakeMove(s.moves[s.root_index], s.root_killed);
+		if (stopped_)
+		{
+			return true;
+		}
+
+		s.iteration_scores[s.root_index] = -s.child_score;
+		if (++s.root_index < s.move_num)
+		{
+			return false;
+		}
+
+		s.completed_depth = s.depth;
+		if (finishIteration(pos, s.moves, s.move_num, s.iteration_scores, s.scores, s.depth) || s.depth >= s.max_depth)
+		{
+			return true;
+		}
+		++s.depth;
+		s.root_index = 0;
+		return false;
+	}
+
+	// 栈顶节点搜索下一个走法
+	const int ply = s.top;
+	FSearchFrame &frame = frames_[ply];
+	if (!s.has_result)
+	{
+		frame.killed = makeMove(pos, frame.moves[frame.index], ply);
+		if (enterFrame(ply + 1, frame.depth - 1, -frame.beta, -frame.alpha, s.child_score))
+		{
+			s.has_result = true;
+		}
+		else
+		{
+			++s.top;
+		}
+		return false;
+	}
+
+	// 处理子节点分数，与 negamax 的循环体一致
+	s.has_result = false;
+	pos.unmakeMove(frame.moves[frame.index], frame.killed);
+	if (stopped_)
+	{
+		s.child_score = 0;
+		s.has_result = true;
+		--s.top;
+		return false;
+	}
+
+	int score = -s.child_score;
+	bool cutoff = false;
+	if (score > frame.best_score)
+	{
+		frame.best_score = score;
+		frame.best_move = frame.moves[frame.index];
+		if (score > frame.alpha)
+		{
+			frame.alpha = score;
+			if (frame.alpha >= frame.beta)
+			{
+				++stats_.beta_cutoffs;
+				stats_.first_move_cutoffs += frame.index == 0;
+				cutoff = true;
+			}
+		}
+	}
+
+	if (cutoff || ++frame.index >= frame.move_num)
+	{
+		storeNode(frame.key, frame.depth, frame.original_alpha, frame.beta, frame.best_score, frame.best_move, ply);
+		s.child_score = frame.best_score;
+		s.has_result = true;
+		--s.top;
+	}
+	return false;
+}
+
+// 走棋并更新累加器
+FBitboard Search::makeMove(Position &pos, const FMove &move, int ply)
+{
+	FChessPieceType mover = pos.getSideToMove();
+	FBitboard killed = pos.makeMove(move);
+	if (network_ != nullptr)
+	{
+		network_->update(accumulators_[ply + 1], accumulators_[ply], mover, move, killed);
+	}
+	return killed;
+}
+
+// 局面评估
+int Search::evaluate(const Position &pos, int ply)
+{
+	int score = SampledCall(eval_timer_, [&]()
+	{
+		return network_ != nullptr ? network_->evaluate(accumulators_[ply], pos.getSideToMove()) : evaluation_.evaluate(pos);
+	});
+
+	// 载入的网络或权重可能给出任意大的分数，不能被当作胜负分数调整步数或截断
+	return std::max(-kMaxEvalScore, std::min(score, kMaxEvalScore));
+}
+
+// 生成走法
+int Search::generateMoves(const Position &pos, FMove *moves)
+{
+	return SampledCall(movegen_timer_, [&]()
+	{
+		return pos.generateMoves(moves);
+	});
+}
+
+// 从置换表提取主要变例
+std::vector<FMove> Search::extractPv(const Position &pos, const FMove &first) const
+{
+	std::vector<FMove> pv(1, first);
+	if (tt_ == nullptr)
+	{
+		return pv;
+	}
+
+	Position current = pos;
+	current.makeMove(first);
+	std::vector<uint64_t> visited(1, current.getHash());
+	while (static_cast<int>(pv.size()) < kMaxPvLength && !current.isLost())
+	{
+		FTTEntry entry;
+		if (!tt_->probe(current.getHash(), entry) || !entry.move.isValid())
+		{
+			break;
+		}
+
+		// 校验走法是否合法（哈希冲突）
+		FMove moves[kMaxMoveNum];
+		int move_num = current.generateMoves(moves);
+		if (std::find(moves, moves + move_num, entry.move) == moves + move_num)
+		{
+			break;
+		}
+
+		current.makeMove(entry.move);
+		if (std::find(visited.begin(), visited.end(), current.getHash()) != visited.end())
+		{
+			break;
+		}
+		visited.push_back(current.getHash());
+		pv.push_back(entry.move);
+	}
+	return pv;
+}
+
+// 是否需要停止搜索
+bool Search::shouldStop()
+{
+	if (stopped_)
+	{
+		return true;
+	}
+
+	if (limits_.max_nodes != 0 && nodes_ >= limits_.max_nodes)
+	{
+		stopped_ = true;
+	}
+	else if (limits_.max_time_ms != 0 && nodes_ % kTimeCheckInterval == 0)
+	{
+		auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start_time_);
+		stopped_ = elapsed.count() >= limits_.max_time_ms;
+	}
+	return stopped_;
+}
+
+namespace helper
+{
+	// 格式化搜索统计
+	std::string FormatSearchStats(const FSearchStats &stats)
+	{
+		char buffer[256];
+		double hit_rate = stats.tt_probes > 0 ? 100.0 * stats.tt_hits / stats.tt_probes : 0.0;
+		double first_rate = stats.beta_cutoffs > 0 ? 100.0 * stats.first_move_cutoffs / stats.beta_cutoffs : 0.0;
+		snprintf(buffer, sizeof(buffer),
+			"depth %d seldepth %d nodes %llu nps %llu time %.1fms tt %llu/%llu (%.1f%%) ttcut %llu cut %llu (first %.1f%%) movegen %.1fms eval %.1fms pv",
+			stats.depth, stats.seldepth, (unsigned long long)stats.nodes, (unsigned long long)stats.nps, stats.total_ms,
+			(unsigned long long)stats.tt_hits, (unsigned long long)stats.tt_probes, hit_rate, (unsigned long long)stats.tt_cutoffs,
+			(unsigned long long)stats.beta_cutoffs, first_rate, stats.movegen_ms, stats.eval_ms);
+
+		std::string text = buffer;
+		if (stats.slices > 0)
+		{
+			snprintf(buffer, sizeof(buffer), " (%d slices)", stats.slices);
+			text.insert(text.size() - 3, buffer);
+		}
+		for (const FMove &move : stats.pv)
+		{
+			snprintf(buffer, sizeof(buffer), " %d-%d", move.source, move.target);
+			text += buffer;
+		}
+		return text;
+	}
+}
\ No newline at end of file
@@ -0,0 +1,331 @@
+﻿#ifndef __SEARCH_H__
+#define __SEARCH_H__
+
+#include <chrono>
+#include <string>
+#include <vector>
+#include "Random.h"
+#include "Position.h"
+#include "NNUE.h"
+#include "Evaluation.h"
+#include "TranspositionTable.h"
+
+static const int kMateScore = 30000;			// 胜负分数
+static const int kMaxSearchDepth = 64;			// 最大搜索深度
+static const int kMaxEvalScore = kMateScore - kMaxSearchDepth - 1;	// 静态评估的上限，不进入胜负分数区间
+
+/**
+ * 搜索限制
+ * 只使用节点数限制时搜索结果与机器速度无关，可完全复现
+ */
+struct FSearchLimits
+{
+	uint64_t	max_nodes;						// 最大节点数（0表示不限制）
+	int			max_time_ms;					// 最大耗时（0表示不限制）
+	int			max_depth;						// 最大深度
+
+	FSearchLimits() : max_nodes(0), max_time_ms(0), max_depth(kMaxSearchDepth) {}
+};
+
+/**
+ * 搜索统计
+ * 走法生成与评估的耗时为抽样估算值，用于比较两者的比例
+ */
+struct FSearchStats
+{
+	uint64_t			nodes;					// 搜索节点数
+	uint64_t			nps;					// 每秒节点数（分片搜索只计算执行的时间）
+	int					depth;					// 完成的深度
+	int					seldepth;				// 到达的最大层数
+	uint64_t			tt_probes;				// 置换表查询次数
+	uint64_t			tt_hits;				// 置换表命中次数
+	uint64_t			tt_cutoffs;				// 置换表截断次数
+	uint64_t			beta_cutoffs;			// Beta 截断次数
+	uint64_t			first_move_cutoffs;		// 第一个走法即截断的次数
+	double				movegen_ms;				// 走法生成耗时
+	double				eval_ms;				// 局面评估耗时
+	double				total_ms;				// 总耗时（墙钟时间）
+	int					slices;					// 分片数（一次完成的搜索为0）
+	std::vector<FMove>	pv;						// 主要变例
+
+	FSearchStats()
+		: nodes(0), nps(0), depth(0), seldepth(0), tt_probes(0), tt_hits(0), tt_cutoffs(0)
+		, beta_cutoffs(0), first_move_cutoffs(0), movegen_ms(0.0), eval_ms(0.0), total_ms(0.0), slices(0) {}
+};
+
+/**
+ * 搜索结果
+ */
+struct FSearchResult
+{
+	FMove			best_move;					// 最佳走法
+	int				score;						// 分数（走棋方视角）
+	FSearchStats	stats;						// 搜索统计
+
+	FSearchResult() : best_move(FMove::invalid()), score(0) {}
+};
+
+/**
+ * 抽样计时器，每隔固定次数计时一次，按调用次数估算总耗时
+ */
+struct FSampledTimer
+{
+	uint64_t	calls;							// 调用次数
+	uint64_t	samples;						// 计时次数
+	uint64_t	sampled_ns;						// 计时的总耗时
+
+	FSampledTimer() : calls(0), samples(0), sampled_ns(0) {}
+
+	void reset() { calls = samples = sampled_ns = 0; }
+
+	double estimateMs() const { return samples == 0 ? 0.0 : sampled_ns * 1e-6 * calls / samples; }
+};
+
+/**
+ * 分析结果中的一条变例
+ */
+struct FAnalysisLine
+{
+	FMove				move;					// 根节点走法
+	int					score;					// 分数（根节点走棋方视角）
+	std::vector<FMove>	pv;						// 主要变例（包含根节点走法）
+};
+
+/**
+ * Alpha-Beta 迭代加深搜索
+ * 除了一次完成的 run、analyze，还支持分片搜索：start 之后每帧调用 step，
+ * 用显式的栈代替递归，超出时间预算后保存状态让出，下一帧从断点继续，结果与 run 相同。
+ */
+class Search
+{
+public:
+	Search();
+
+public:
+	/**
+	 * 搜索最佳走法
+	 * @param Position 当前局面
+	 * @param FSearchLimits 搜索限制
+	 * @param Random 随机数生成器，用于打乱根节点走法顺序
+	 */
+	FSearchResult run(const Position &pos, const FSearchLimits &limits, Random &random);
+
+	/**
+	 * 多变例分析，返回分数最高的前几个走法及其主要变例
+	 * @param Position 当前局面
+	 * @param FSearchLimits 搜索限制
+	 * @param int 返回的走法数量
+	 */
+	std::vector<FAnalysisLine> analyze(const Position &pos, const FSearchLimits &limits, int multi_pv);
+
+	/**
+	 * 开始分片搜索（搜索状态保存在对象中，结束或取消前不能进行其他搜索）
+	 * @param Position 当前局面
+	 * @param FSearchLimits 搜索限制，时间限制按墙钟时间计算
+	 * @param Random 随机数生成器，用于打乱根节点走法顺序
+	 */
+	void start(const Position &pos, const FSearchLimits &limits, Random &random);
+
+	/**
+	 * 执行分片搜索，超出时间预算后让出
+	 * @param int 本次的时间预算（微秒）
+	 * @return bool 搜索是否已经结束
+	 */
+	bool step(int budget_us);
+
+	/**
+	 * 是否有正在进行的分片搜索
+	 */
+	bool isRunning() const;
+
+	/**
+	 * 取消分片搜索
+	 */
+	void cancel();
+
+	/**
+	 * 获取分片搜索的结果（未结束时为已完成迭代中的最佳走法）
+	 */
+	FSearchResult getResult() const;
+
+	/**
+	 * 设置评估权重
+	 */
+	void setEvalWeights(const FEvalWeights &weights);
+
+	/**
+	 * 获取评估函数
+	 */
+	const Evaluation& getEvaluation() const;
+
+	/**
+	 * 设置神经网络评估（为空时使用线性评估，不持有所有权）
+	 */
+	void setNetwork(const NNUENetwork *network);
+
+	/**
+	 * 设置置换表（为空时不使用，不持有所有权）
+	 * @param bool 多个搜索共享时由调用者推进代数（newSearch），每次搜索开始时不推进
+	 */
+	void setTranspositionTable(TranspositionTable *tt, bool shared = false);
+
+	/**
+	 * 获取最近一次搜索的统计（analyze 的统计不含主要变例）
+	 */
+	const FSearchStats& getLastStats() const;
+
+private:
+	/**
+	 * 分片搜索中一层节点的状态（代替递归调用的栈帧）
+	 */
+	struct FSearchFrame
+	{
+		FMove		moves[kMaxMoveNum];
+		int			move_num;
+		int			index;						// 正在搜索的走法
+		FBitboard	killed;						// 正在搜索的走法吃掉的棋子
+		int			depth;
+		int			alpha;
+		int			beta;
+		int			original_alpha;
+		int			best_score;
+		FMove		best_move;
+		uint64_t	key;
+	};
+
+	/**
+	 * 分片搜索的根节点状态
+	 */
+	struct FSliceState
+	{
+		bool		running;
+		Position	root;						// 搜索过程中随走棋更新，让出时停在当前节点
+		FMove		moves[kMaxMoveNum];
+		int			move_num;
+		int			scores[kMaxMoveNum];		// 最后一次完成迭代的分数
+		int			iteration_scores[kMaxMoveNum];
+		int			depth;						// 当前迭代的深度
+		int			max_depth;
+		int			completed_depth;
+		int			root_index;					// 正在搜索的根节点走法
+		FBitboard	root_killed;
+		int			top;						// 栈顶层数，0表示在根节点
+		bool		has_result;					// 是否有待处理的子节点分数
+		int			child_score;
+		int			slices;
+		double		active_ms;					// 执行的时间
+
+		FSliceState() : running(false), move_num(0), completed_depth(0), slices(0), active_ms(0.0) {}
+	};
+
+private:
+	/**
+	 * 根节点迭代加深
+	 * @param FMove* 根节点走法，按上一次迭代的分数排序
+	 * @param int 需要精确分数的走法数量
+	 * @param int* 各走法最后一次完成迭代的分数
+	 * @return int 完成的深度
+	 */
+	int searchRoot(const Position &pos, FMove *moves, int move_num, int multi_pv, int *scores);
+
+	/**
+	 * 完成一次根节点迭代：按分数排序（分数相同时保持原来的顺序）并存入置换表
+	 * @return bool 是否已经分出胜负
+	 */
+	bool finishIteration(const Position &root, FMove *moves, int move_num, const int *iteration_scores, int *scores, int depth);
+
+	/**
+	 * 负极大值搜索
+	 */
+	int negamax(Position &pos, int depth, int alpha, int beta, int ply);
+
+	/**
+	 * 节点的公共处理：计数、终局、叶节点评估、置换表查询
+	 * @return bool 可以直接返回 score 时为 true
+	 */
+	bool resolveNode(const Position &pos, int depth, int alpha, int beta, int ply, uint64_t &key, FMove &tt_move, int &score);
+
+	/**
+	 * 节点搜索完成后存入置换表
+	 */
+	void storeNode(uint64_t key, int depth, int original_alpha, int beta, int best_score, const FMove &best_move, int ply);
+
+	/**
+	 * 分片搜索进入节点，不能直接返回时初始化该层的栈帧
+	 * @return bool 可以直接返回 score 时为 true
+	 */
+	bool enterFrame(int ply, int depth, int alpha, int beta, int &score);
+
+	/**
+	 * 分片搜索前进一步（根节点走一步，或者栈顶节点搜索一个走法、处理一个子节点分数）
+	 * @return bool 搜索是否已经结束
+	 */
+	bool advance();
+
+	/**
+	 * 走棋并更新累加器
+	 */
+	FBitboard makeMove(Position &pos, const FMove &move, int ply);
+
+	/**
+	 * 局面评估（走棋方视角）
+	 */
+	int evaluate(const Position &pos, int ply);
+
+	/**
+	 * 生成走法（抽样计时）
+	 */
+	int generateMoves(const Position &pos, FMove *moves);
+
+	/**
+	 * 从置换表提取主要变例
+	 */
+	std::vector<FMove> extractPv(const Position &pos, const FMove &first) const;
+
+	/**
+	 * 开始搜索前的初始化
+	 */
+	void prepare(const FSearchLimits &limits);
+
+	/**
+	 * 汇总统计（不含主要变例）
+	 * @param int 完成的深度
+	 * @param double 执行的时间，小于0时使用墙钟时间
+	 */
+	FSearchStats collectStats(int depth, double active_ms) const;
+
+	/**
+	 * 是否需要停止搜索
+	 */
+	bool shouldStop();
+
+private:
+	Search(const Search &) = delete;
+	Search& operator= (const Search &) = delete;
+
+private:
+	Evaluation								evaluation_;
+	const NNUENetwork*						network_;
+	TranspositionTable*						tt_;
+	bool									tt_shared_;
+	FAccumulator							accumulators_[kMaxSearchDepth + 1];
+	FSearchLimits							limits_;
+	uint64_t								nodes_;
+	bool									stopped_;
+	std::chrono::steady_clock::time_point	start_time_;
+	FSearchStats							stats_;
+	FSampledTimer							movegen_timer_;
+	FSampledTimer							eval_timer_;
+	FSliceState								slice_;
+	std::vector<FSearchFrame>				frames_;
+};
+
+namespace helper
+{
+	/**
+	 * 格式化搜索统计（单行，用于日志）
+	 */
+	std::string FormatSearchStats(const FSearchStats &stats);
+}
+
+#endif
\ No newline at end of file
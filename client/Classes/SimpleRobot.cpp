@@ -1,197 +1,207 @@
 ﻿#include "SimpleRobot.h"
 
-#include <ctime>
-#include <random>
 #include <cassert>
 #include <algorithm>
 
 
-SimpleRobot::SimpleRobot(SingleLogic *logic)
+namespace
+{
+	// 置换表大小（MB），对局内各步之间保留
+	const size_t kRobotTTSizeMB = 1;
+
+	// 各难度的搜索预算
+	FSearchLimits GetLevelLimits(FRobotLevel level)
+	{
+		FSearchLimits limits;
+		switch (level)
+		{
+			case FRobotLevel::EASY:
+				limits.max_nodes = 200;
+				limits.max_depth = 2;
+				break;
+			case FRobotLevel::NORMAL:
+				limits.max_nodes = 5000;
+				break;
+			case FRobotLevel::HARD:
+				limits.max_nodes = 200000;
+				break;
+		}
+		return limits;
+	}
+}
+
+SimpleRobot::SimpleRobot(LogicBase *logic, uint64_t seed)
 	: logic_(logic)
-	, action_read_pos_(0)
 	, chess_type_(FChessPieceType::NONE)
+	, action_listener_(-1)
+	, level_(FRobotLevel::NORMAL)
+	, limits_(GetLevelLimits(FRobotLevel::NORMAL))
+	, random_(seed)
+	, tt_(kRobotTTSizeMB)
+	, slice_budget_us_(0)
 {
 	assert(logic_ != nullptr);
-	logic_->addActionUpdateCallback(std::bind(&SimpleRobot::updateAction, this));
+	search_.setTranspositionTable(&tt_);
+	action_listener_ = logic_->addActionListener(helper::ActionMask(FActionType::STANDBY) | helper::ActionMask(FActionType::UNDO),
+		std::bind(&SimpleRobot::onActions, this, std::placeholders::_1));
 }
 
 SimpleRobot::~SimpleRobot()
 {
-
-}
-
-// 更新动作
-void SimpleRobot::updateAction()
-{
-	runAction();
+	logic_->removeActionListener(action_listener_);
 }
 
-// 获取所有可行的移动路径
-std::vector<FMoveTrack> SimpleRobot::getAllMovetrack(const FChessArray &checkerboard, FChessPieceType type) const
+// 本次更新的动作
+void SimpleRobot::onActions(const FActionSpan &actions)
 {
-	size_t idx = 0;
-	std::vector<FMoveTrack> track_array;
-	while (idx != checkerboard.size())
+	// 同一批次中可能有多步棋，只有最后轮到自己时才搜索
+	FAction last;
+	last.type = FActionType::NONE;
+	for (const FAction &action : actions)
 	{
-		if (checkerboard[idx] == type)
+		// 悔棋后局面变了，正在进行的分片搜索作废
+		if (action.type == FActionType::UNDO && search_.isRunning())
 		{
-			// 判断上下左右是否可移动
-			int row = idx / kCheckerboardColNum;
-			int col = idx % kCheckerboardColNum;
-			for (int i = -1; i <= 1; i += 2)
-			{
-				FVec2 v1(col + i, row);
-				FVec2 v2(col, row + i);
-				if (isInCheckerboard(v1) && !isValidChesspiece(checkerboard, v1))
-				{
-					FMoveTrack track = { FVec2(col, row), v1 };
-					track_array.push_back(track);
-				}
-				if (isInCheckerboard(v2) && !isValidChesspiece(checkerboard, v2))
-				{
-					FMoveTrack track = { FVec2(col, row), v2 };
-					track_array.push_back(track);
-				}
-			}
+			search_.cancel();
+		}
+		if (action.type == FActionType::STANDBY || action.type == FActionType::GAMEOVER || action.type == FActionType::DRAW)
+		{
+			last = action;
 		}
-		++idx;
 	}
-	return track_array;
-}
 
-// 获取可杀死敌方棋子的移动路径
-std::vector<FMoveTrack> SimpleRobot::getCanKillChessMovetrack(std::vector<FMoveTrack> &track_array) const
-{
-	std::vector<FMoveTrack> kill_chess_array;
-	FChessArray checkerboard = logic_->getCheckerboard();
-	for (size_t i = 0; i < track_array.size(); ++i)
+	if (last.type == FActionType::STANDBY &&
+		getChesspieceType() != FChessPieceType::NONE && last.chess_type != getChesspieceType())
 	{
-		// 模拟出棋
-		FVec2 &source =  track_array[i].source;
-		FVec2 &target = track_array[i].target;
-		std::swap(checkerboard[source.y * kCheckerboardColNum + source.x], checkerboard[target.y * kCheckerboardColNum + target.x]);
-		
-		std::set<FVec2> kill_set = helper::CheckKillChesspiece(checkerboard, target);
-		if (!kill_set.empty())
+		if (slice_budget_us_ > 0)
 		{
-			kill_chess_array.push_back(track_array[i]);
+			// 分片搜索，由 update 完成
+			Position pos = Position::fromCheckerboard(logic_->getCheckerboard(), getChesspieceType());
+			search_.start(pos, limits_, random_);
+		}
+		else
+		{
+			// 搜索最佳走法
+			FSearchResult result = think(getChesspieceType());
+			submitMove(result.best_move);
 		}
-
-		// 恢复棋盘
-		std::swap(checkerboard[source.y * kCheckerboardColNum + source.x], checkerboard[target.y * kCheckerboardColNum + target.x]);
 	}
-
-	return kill_chess_array;
 }
 
-// 获取可躲避被杀棋的移动路径
-std::vector<FMoveTrack> SimpleRobot::getCanAvoidChessMovetrack(std::vector<FMoveTrack> &track_array) const
+// 每帧更新
+void SimpleRobot::update()
 {
-	std::vector<FMoveTrack> avoid_chess_array = track_array;
-	FChessArray checkerboard = logic_->getCheckerboard();
-	auto other_chesspiece_type = getChesspieceType() == FChessPieceType::WHITE ? FChessPieceType::BLACK : FChessPieceType::WHITE;
-	for (size_t i = 0; i < track_array.size(); ++i)
+	if (search_.isRunning() && search_.step(slice_budget_us_))
 	{
-		// 模拟出棋
-		FVec2 &source = track_array[i].source;
-		FVec2 &target = track_array[i].target;
-		std::swap(checkerboard[source.y * kCheckerboardColNum + source.x], checkerboard[target.y * kCheckerboardColNum + target.x]);
-
-		// 模拟对方出棋
+		last_result_ = search_.getResult();
+		if (search_logger_)
 		{
-			std::vector<FMoveTrack> other_track_array = getAllMovetrack(checkerboard, other_chesspiece_type);
-			for (size_t j = 0; j < other_track_array.size(); ++j)
-			{
-				// 模拟出棋
-				FVec2 &other_source = other_track_array[j].source;
-				FVec2 &other_target = other_track_array[j].target;
-				std::swap(checkerboard[other_source.y * kCheckerboardColNum + other_source.x], checkerboard[other_target.y * kCheckerboardColNum + other_target.x]);
-
-				if (!helper::CheckKillChesspiece(checkerboard, other_target).empty())
-				{
-					auto itr = std::find(avoid_chess_array.begin(), avoid_chess_array.end(), track_array[i]);
-					if (itr != avoid_chess_array.end())
-					{
-						avoid_chess_array.erase(itr);
-					}
-				}
-
-				// 恢复棋盘
-				std::swap(checkerboard[other_source.y * kCheckerboardColNum + other_source.x], checkerboard[other_target.y * kCheckerboardColNum + other_target.x]);
-			}
+			search_logger_(last_result_);
 		}
-
-		// 恢复棋盘
-		std::swap(checkerboard[source.y * kCheckerboardColNum + source.x], checkerboard[target.y * kCheckerboardColNum + target.x]);
+		submitMove(last_result_.best_move);
 	}
-
-	return avoid_chess_array;
 }
 
-// 执行动作
-void SimpleRobot::runAction()
+// 为当前局面搜索走法
+FSearchResult SimpleRobot::think(FChessPieceType type)
 {
-	FAction action = logic_->getActionFromQueue(action_read_pos_);
-	if (action.type != FActionType::NONE)
+	Position pos = Position::fromCheckerboard(logic_->getCheckerboard(), type);
+	last_result_ = search_.run(pos, limits_, random_);
+	if (search_logger_)
 	{
-		if (action.type == FActionType::STANDBY &&
-			action.chess_type != getChesspieceType())
-		{
-			// 获取所有可行的移动轨迹
-			const FChessArray &checkerboard = logic_->getCheckerboard();
-			std::vector<FMoveTrack> track_array = getAllMovetrack(checkerboard, getChesspieceType());
-
-			if (!track_array.empty())
-			{
-				// 获取可杀死敌方棋子的移动轨迹
-				std::vector<FMoveTrack> kill_chess_array = getCanKillChessMovetrack(track_array);
-
-				// 优先杀死对方棋子，其次躲避对方
-				if (!kill_chess_array.empty())
-				{
-					logic_->moveChesspiece(kill_chess_array.front().source, kill_chess_array.front().target);
-				}
-				else
-				{
-					std::vector<FMoveTrack> avoid_chess_array = getCanAvoidChessMovetrack(track_array);
-					if (avoid_chess_array.empty())
-					{
-						std::default_random_engine generator(time(nullptr));
-						std::uniform_int_distribution<int> dis(0, track_array.size() - 1);
-						const FMoveTrack &track = track_array[dis(generator)];
-						logic_->moveChesspiece(track.source, track.target);
-					}
-					else
-					{
-						std::default_random_engine generator(time(nullptr));
-						std::uniform_int_distribution<int> dis(0, avoid_chess_array.size() - 1);
-						const FMoveTrack &track = avoid_chess_array[dis(generator)];
-						logic_->moveChesspiece(track.source, track.target);
-					}
-				}
-			}
-		}
+		search_logger_(last_result_);
+	}
+	return last_result_;
+}
 
-		actionFinished();
+// 提交走法
+void SimpleRobot::submitMove(const FMove &move)
+{
+	if (move.isValid())
+	{
+		FMoveTrack track = move.toMoveTrack();
+		logic_->moveChesspiece(track.source, track.target);
 	}
 }
 
-// 完成动作
-void SimpleRobot::actionFinished()
+// 获取最近一次搜索结果
+const FSearchResult& SimpleRobot::getLastSearchResult() const
 {
-	++action_read_pos_;
-	updateAction();
+	return last_result_;
+}
+
+// 设置搜索日志回调
+void SimpleRobot::setSearchLogger(const std::function<void(const FSearchResult &)> &logger)
+{
+	search_logger_ = logger;
 }
 
 // 重置
 void SimpleRobot::reset(FChessPieceType type)
 {
 	chess_type_ = type;
-	action_read_pos_ = 0;
+	search_.cancel();
+	tt_.clear();
 }
 
 // 获取棋子类型
 FChessPieceType SimpleRobot::getChesspieceType() const
 {
 	return chess_type_;
+}
+
+// 设置随机数种子
+void SimpleRobot::setSeed(uint64_t seed)
+{
+	random_.seed(seed);
+}
+
+// 设置难度
+void SimpleRobot::setLevel(FRobotLevel level)
+{
+	level_ = level;
+	limits_ = GetLevelLimits(level);
+}
+
+// 获取难度
+FRobotLevel SimpleRobot::getLevel() const
+{
+	return level_;
+}
+
+// 设置搜索限制
+void SimpleRobot::setSearchLimits(const FSearchLimits &limits)
+{
+	limits_ = limits;
+}
+
+// 获取搜索限制
+const FSearchLimits& SimpleRobot::getSearchLimits() const
+{
+	return limits_;
+}
+
+// 设置分片搜索每帧的时间预算
+void SimpleRobot::setSliceBudget(int budget_us)
+{
+	slice_budget_us_ = budget_us;
+}
+
+// 设置评估权重
+void SimpleRobot::setEvalWeights(const FEvalWeights &weights)
+{
+	search_.setEvalWeights(weights);
+}
+
+// 加载神经网络评估权重
+bool SimpleRobot::loadNetwork(const char *data, size_t size)
+{
+	std::unique_ptr<NNUENetwork> network(new NNUENetwork());
+	if (!network->load(data, size))
+	{
+		return false;
+	}
+	network_ = std::move(network);
+	search_.setNetwork(network_.get());
+	return true;
 }
\ No newline at end of file
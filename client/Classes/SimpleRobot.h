@@ -2,29 +2,48 @@
 #define __SIMPLEROBOT_H__
 
 #include <memory>
-#include "SingleLogic.h"
+#include <functional>
+#include "Search.h"
+#include "Random.h"
+#include "LogicBase.h"
+
+/**
+ * 机器人难度，由搜索的节点预算决定
+ */
+enum class FRobotLevel
+{
+	EASY,										// 简单
+	NORMAL,										// 普通
+	HARD,										// 困难
+};
 
 class SimpleRobot
 {
 public:
-	SimpleRobot(SingleLogic *logic);
+	SimpleRobot(LogicBase *logic, uint64_t seed = Random::kDefaultSeed);
 	~SimpleRobot();
 
 public:
 	/**
-	 * 更新动作
+	 * 每帧更新，执行分片搜索，搜索结束后提交走法
+	 */
+	void update();
+
+	/**
+	 * 为当前局面搜索走法（不提交）
+	 * @param FChessPieceType 走棋方
 	 */
-	void updateAction();
+	FSearchResult think(FChessPieceType type);
 
 	/**
-	 * 执行动作
+	 * 获取最近一次搜索结果（包含搜索统计）
 	 */
-	void runAction();
+	const FSearchResult& getLastSearchResult() const;
 
 	/**
-	 * 完成动作
+	 * 设置搜索日志回调，每次搜索结束后调用（为空时不记录）
 	 */
-	void actionFinished();
+	void setSearchLogger(const std::function<void(const FSearchResult &)> &logger);
 
 	/**
 	 * 重置
@@ -36,43 +55,71 @@ public:
 	 */
 	FChessPieceType getChesspieceType() const;
 
-public:
 	/**
-	 * 获取可杀死敌方棋子的移动路径
+	 * 设置随机数种子
+	 */
+	void setSeed(uint64_t seed);
+
+	/**
+	 * 设置难度
 	 */
-	std::vector<FMoveTrack> getCanKillChessMovetrack(std::vector<FMoveTrack> &track_array) const;
+	void setLevel(FRobotLevel level);
 
 	/**
-	 * 获取可躲避被杀棋的移动路径
+	 * 获取难度
 	 */
-	std::vector<FMoveTrack> getCanAvoidChessMovetrack(std::vector<FMoveTrack> &track_array) const;
+	FRobotLevel getLevel() const;
 
 	/**
-	 * 获取所有可行的移动路径
+	 * 设置搜索限制（覆盖难度对应的预算，例如按时间限制）
 	 */
-	std::vector<FMoveTrack> getAllMovetrack(const FChessArray &checkerboard, FChessPieceType type) const;
+	void setSearchLimits(const FSearchLimits &limits);
+
+	/**
+	 * 获取搜索限制
+	 */
+	const FSearchLimits& getSearchLimits() const;
+
+	/**
+	 * 设置分片搜索每帧的时间预算（微秒）
+	 * 大于0时轮到机器人后在 update 中分多帧搜索，不阻塞当前帧；为0时在动作分发中一次搜索完成
+	 */
+	void setSliceBudget(int budget_us);
+
+	/**
+	 * 设置评估权重
+	 */
+	void setEvalWeights(const FEvalWeights &weights);
+
+	/**
+	 * 加载神经网络评估权重，失败时继续使用线性评估
+	 */
+	bool loadNetwork(const char *data, size_t size);
 
 protected:
 	SimpleRobot(const SimpleRobot &) = delete;
 	SimpleRobot& operator= (const SimpleRobot &) = delete;
 
 private:
-	// 是否在棋盘
-	bool isInCheckerboard(const FVec2 &pos) const
-	{
-		return pos.x >= 0 && pos.y >= 0 && pos.x < kCheckerboardColNum && pos.y < kCheckerboardRowNum;
-	}
-
-	// 棋子是否有效
-	bool isValidChesspiece(const FChessArray &checkerboard, const FVec2 &pos) const
-	{
-		return isInCheckerboard(pos) && checkerboard[pos.y  * kCheckerboardRowNum + pos.x] != FChessPieceType::NONE;
-	}
+	// 本次更新的动作（只看最后的待机或结束动作）
+	void onActions(const FActionSpan &actions);
+
+	// 提交走法
+	void submitMove(const FMove &move);
 
 private:
-	SingleLogic*	logic_;
-	FChessPieceType	chess_type_;
-	int				action_read_pos_;
+	LogicBase*						logic_;
+	FChessPieceType					chess_type_;
+	int								action_listener_;
+	FRobotLevel						level_;
+	FSearchLimits					limits_;
+	Random							random_;
+	Search							search_;
+	TranspositionTable				tt_;
+	FSearchResult					last_result_;
+	int								slice_budget_us_;
+	std::function<void(const FSearchResult &)>	search_logger_;
+	std::unique_ptr<NNUENetwork>	network_;
 };
 
 #endif
\ No newline at end of file
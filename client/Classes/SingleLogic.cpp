@@ -2,7 +2,6 @@
 #include <cmath>
 #include <cassert>
 #include "cocos2d.h"
-#include "json/document.h"
 using namespace cocos2d;
 
 namespace
@@ -12,35 +11,36 @@ namespace
 	{
 		Data data = FileUtils::getInstance()->getDataFromFile("config/init.json");
 
-		// 解析json
-		rapidjson::Document doc;
-		doc.Parse<0>(std::string((const char *)data.getBytes(), data.getSize()).c_str());
-		if (doc.HasParseError() || !doc.IsArray())
+		if (!helper::ParseCheckerboard(std::string((const char *)data.getBytes(), data.getSize()), checkerboard))
 		{
 			CCAssert(false, "Json parse error!");
 		}
+	}
+}
 
-		if (doc.Size() != kCheckerboardRowNum * kCheckerboardColNum)
-		{
-			CCAssert(false, "Array size error!");
-		}
+SingleLogic::SingleLogic()
+	: upperplayer_(FChessPieceType::NONE)
+	, has_initial_state_(false)
+{
 
-		for (size_t i = 0; i < doc.Size(); ++i)
-		{
-			int row = i / kCheckerboardColNum;
-			int col = i % kCheckerboardColNum;
-			checkerboard[row * kCheckerboardRowNum + col] = static_cast<FChessPieceType>(doc[doc.Size() - i - 1].GetInt());
-		}
-	}
 }
 
 // 准备开始
 void SingleLogic::ready()
 {
 	reset();
-	FChessArray checkerboard;
-	InitCheckerboard(checkerboard);
-	setCheckerboard(checkerboard);
+	if (has_initial_state_)
+	{
+		restoreState(initial_state_);
+	}
+	else
+	{
+		FChessArray checkerboard;
+		InitCheckerboard(checkerboard);
+		setCheckerboard(checkerboard);
+		initial_state_ = saveState();
+		has_initial_state_ = true;
+	}
 	upperplayer_ = rand() % 2 == 0 ? FChessPieceType::WHITE : FChessPieceType::BLACK;
 	addAction(FActionType::BEREADY, getStandbyChesspieceType(), FVec2::invalid(), FVec2::invalid());
 	addAction(FActionType::START, getStandbyChesspieceType(), FVec2::invalid(), FVec2::invalid());
@@ -60,8 +60,8 @@ FChessPieceType SingleLogic::getBelowplayerChesspieceType() const
 }
 
 // 移动棋子
-void SingleLogic::moveChesspiece(const FVec2 &source, const FVec2 &target)
+FMoveTicket SingleLogic::moveChesspiece(const FVec2 &source, const FVec2 &target)
 {
 	FMoveTrack track = { source, target };
-	addMovetrack(track);
+	return addMovetrack(track);
 }
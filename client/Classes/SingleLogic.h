@@ -5,6 +5,9 @@
 
 class SingleLogic : public LogicBase
 {
+public:
+	SingleLogic();
+
 public:
 	/**
 	 * 准备开始
@@ -24,10 +27,12 @@ public:
 	/**
 	 * 移动棋子
 	 */
-	virtual void moveChesspiece(const FVec2 &source, const FVec2 &target) override;
+	virtual FMoveTicket moveChesspiece(const FVec2 &source, const FVec2 &target) override;
 
 private:
 	FChessPieceType upperplayer_;
+	bool			has_initial_state_;
+	FGameState		initial_state_;				// 初始局面，只在第一次开始时解析配置
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,46 @@
+﻿#include "TrainingData.h"
+#include <cstring>
+#include <algorithm>
+
+
+namespace helper
+{
+	// 生成训练样本
+	FTrainingSample MakeTrainingSample(const Position &pos, int score, int result)
+	{
+		FTrainingSample sample;
+		sample.white = pos.getPieces(FChessPieceType::WHITE);
+		sample.black = pos.getPieces(FChessPieceType::BLACK);
+		sample.side = static_cast<uint8_t>(pos.getSideToMove());
+		sample.result = static_cast<int8_t>(result > 0 ? 1 : result < 0 ? -1 : 0);
+		sample.score = static_cast<int16_t>(std::max(-32767, std::min(32767, score)));
+		return sample;
+	}
+
+	// 训练样本还原为局面
+	Position TrainingSampleToPosition(const FTrainingSample &sample)
+	{
+		FChessArray checkerboard;
+		for (int i = 0; i < kSquareNum; ++i)
+		{
+			checkerboard[i] = (sample.white >> i) & 1 ? FChessPieceType::WHITE
+				: (sample.black >> i) & 1 ? FChessPieceType::BLACK : FChessPieceType::NONE;
+		}
+		return Position::fromCheckerboard(checkerboard, static_cast<FChessPieceType>(sample.side));
+	}
+
+	// 生成文件头
+	FTrainingFileHeader MakeTrainingFileHeader()
+	{
+		FTrainingFileHeader header;
+		memcpy(header.magic, kTrainingFileMagic, sizeof(header.magic));
+		header.version = kTrainingFileVersion;
+		return header;
+	}
+
+	// 检查文件头
+	bool IsValidTrainingFileHeader(const FTrainingFileHeader &header)
+	{
+		return memcmp(header.magic, kTrainingFileMagic, sizeof(header.magic)) == 0 && header.version == kTrainingFileVersion;
+	}
+}
\ No newline at end of file
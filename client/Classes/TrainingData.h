@@ -0,0 +1,60 @@
+﻿#ifndef __TRAININGDATA_H__
+#define __TRAININGDATA_H__
+
+#include <cstdint>
+#include "Position.h"
+
+static const uint32_t kTrainingFileVersion = 1;
+static const char kTrainingFileMagic[4] = { 'S', 'S', 'C', 'T' };
+
+#pragma pack(push, 1)
+
+/**
+ * 训练样本文件头
+ */
+struct FTrainingFileHeader
+{
+	char		magic[4];						// 文件标识
+	uint32_t	version;						// 版本号
+};
+
+/**
+ * 训练样本（文件头之后紧密排列）
+ */
+struct FTrainingSample
+{
+	FBitboard	white;							// 白棋
+	FBitboard	black;							// 黑棋
+	uint8_t		side;							// 走棋方
+	int8_t		result;							// 最终结果（走棋方视角，1胜 0和 -1负）
+	int16_t		score;							// 搜索分数（走棋方视角）
+};
+
+#pragma pack(pop)
+
+static_assert(sizeof(FTrainingSample) == 8, "FTrainingSample must be packed");
+
+namespace helper
+{
+	/**
+	 * 生成训练样本
+	 */
+	FTrainingSample MakeTrainingSample(const Position &pos, int score, int result);
+
+	/**
+	 * 训练样本还原为局面
+	 */
+	Position TrainingSampleToPosition(const FTrainingSample &sample);
+
+	/**
+	 * 生成文件头
+	 */
+	FTrainingFileHeader MakeTrainingFileHeader();
+
+	/**
+	 * 检查文件头
+	 */
+	bool IsValidTrainingFileHeader(const FTrainingFileHeader &header);
+}
+
+#endif
\ No newline at end of file
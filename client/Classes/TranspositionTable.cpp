@@ -0,0 +1,118 @@
+﻿#include "TranspositionTable.h"
+#include <algorithm>
+
+
+namespace
+{
+	// data 布局: score(16) | depth(8) | bound(8) | source(8) | target(8) | generation(8)
+	inline uint64_t Pack(const FMove &move, int score, int depth, FBoundType bound, uint8_t generation)
+	{
+		return static_cast<uint64_t>(static_cast<uint16_t>(static_cast<int16_t>(score)))
+			| (static_cast<uint64_t>(depth & 0xFF) << 16)
+			| (static_cast<uint64_t>(bound) << 24)
+			| (static_cast<uint64_t>(move.source) << 32)
+			| (static_cast<uint64_t>(move.target) << 40)
+			| (static_cast<uint64_t>(generation) << 48);
+	}
+
+	inline FTTEntry Unpack(uint64_t data)
+	{
+		FTTEntry entry;
+		entry.score = static_cast<int16_t>(data & 0xFFFF);
+		entry.depth = static_cast<uint8_t>((data >> 16) & 0xFF);
+		entry.bound = static_cast<FBoundType>((data >> 24) & 0xFF);
+		entry.move.source = static_cast<uint8_t>((data >> 32) & 0xFF);
+		entry.move.target = static_cast<uint8_t>((data >> 40) & 0xFF);
+		return entry;
+	}
+
+	inline uint8_t Generation(uint64_t data)
+	{
+		return static_cast<uint8_t>((data >> 48) & 0xFF);
+	}
+}
+
+TranspositionTable::TranspositionTable(size_t size_mb)
+	: slot_num_(0)
+	, mask_(0)
+	, generation_(0)
+{
+	resize(size_mb);
+}
+
+// 重新分配大小
+void TranspositionTable::resize(size_t size_mb)
+{
+	size_t count = 1;
+	size_t bytes = std::max<size_t>(size_mb, 1) * 1024 * 1024;
+	while (count * 2 * sizeof(FSlot) <= bytes)
+	{
+		count *= 2;
+	}
+	slots_.reset(new FSlot[count]);
+	slot_num_ = count;
+	mask_ = count - 1;
+	clear();
+}
+
+// 清空
+void TranspositionTable::clear()
+{
+	for (size_t i = 0; i < slot_num_; ++i)
+	{
+		slots_[i].check.store(0, std::memory_order_relaxed);
+		slots_[i].data.store(0, std::memory_order_relaxed);
+	}
+	generation_.store(0, std::memory_order_relaxed);
+}
+
+// 开始新的搜索
+void TranspositionTable::newSearch()
+{
+	generation_.fetch_add(1, std::memory_order_relaxed);
+}
+
+// 查找
+bool TranspositionTable::probe(uint64_t key, FTTEntry &entry) const
+{
+	const FSlot &slot = slots_[key & mask_];
+	uint64_t data = slot.data.load(std::memory_order_relaxed);
+	if ((slot.check.load(std::memory_order_relaxed) ^ data) != key || data == 0)
+	{
+		return false;
+	}
+	entry = Unpack(data);
+	return entry.bound != FBoundType::NONE;
+}
+
+// 保存
+void TranspositionTable::store(uint64_t key, const FMove &move, int score, int depth, FBoundType bound)
+{
+	FSlot &slot = slots_[key & mask_];
+	uint64_t old_data = slot.data.load(std::memory_order_relaxed);
+	bool same_key = (slot.check.load(std::memory_order_relaxed) ^ old_data) == key;
+	uint8_t generation = generation_.load(std::memory_order_relaxed);
+
+	// 旧搜索留下的条目、深度更浅的条目、同一局面的条目可以被替换
+	if (old_data != 0 && !same_key && Generation(old_data) == generation && Unpack(old_data).depth > depth)
+	{
+		return;
+	}
+
+	// 同一局面没有新走法时保留原来的走法
+	FMove best = move;
+	if (same_key && !best.isValid() && old_data != 0)
+	{
+		best = Unpack(old_data).move;
+	}
+
+	uint64_t data = Pack(best, score, depth, bound, generation);
+	slot.check.store(key ^ data, std::memory_order_relaxed);
+	slot.data.store(data, std::memory_order_relaxed);
+}
+
+// 槽位数量
+size_t TranspositionTable::getSlotNum() const
+{
+	return slot_num_;
+}
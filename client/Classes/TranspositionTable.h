@@ -0,0 +1,90 @@
+﻿#ifndef __TRANSPOSITIONTABLE_H__
+#define __TRANSPOSITIONTABLE_H__
+
+#include <atomic>
+#include <memory>
+#include <cstdint>
+#include "Position.h"
+
+/**
+ * 置换表分数类型
+ */
+enum class FBoundType : uint8_t
+{
+	NONE,
+	EXACT,										// 精确值
+	LOWER,										// 下界（发生剪枝）
+	UPPER,										// 上界（所有走法都不够好）
+};
+
+/**
+ * 置换表条目
+ */
+struct FTTEntry
+{
+	FMove		move;							// 最佳走法
+	int16_t		score;							// 分数
+	uint8_t		depth;							// 搜索深度
+	FBoundType	bound;							// 分数类型
+};
+
+/**
+ * 置换表
+ * 每个槽位保存 (key ^ data, data) 两个64位值，读取时校验，避免读到不完整的数据
+ * 槽位使用 relaxed 原子变量，多个线程的搜索可以无锁共享同一个置换表
+ */
+class TranspositionTable
+{
+public:
+	explicit TranspositionTable(size_t size_mb = 4);
+
+public:
+	/**
+	 * 重新分配大小（会清空）
+	 */
+	void resize(size_t size_mb);
+
+	/**
+	 * 清空
+	 */
+	void clear();
+
+	/**
+	 * 开始新的搜索（用于替换旧条目）
+	 */
+	void newSearch();
+
+	/**
+	 * 查找
+	 */
+	bool probe(uint64_t key, FTTEntry &entry) const;
+
+	/**
+	 * 保存
+	 */
+	void store(uint64_t key, const FMove &move, int score, int depth, FBoundType bound);
+
+	/**
+	 * 槽位数量
+	 */
+	size_t getSlotNum() const;
+
+private:
+	struct FSlot
+	{
+		std::atomic<uint64_t>	check;
+		std::atomic<uint64_t>	data;
+	};
+
+private:
+	TranspositionTable(const TranspositionTable &) = delete;
+	TranspositionTable& operator= (const TranspositionTable &) = delete;
+
+private:
+	std::unique_ptr<FSlot[]>	slots_;
+	size_t						slot_num_;
+	size_t						mask_;
+	std::atomic<uint8_t>		generation_;
+};
+
+#endif
@@ -0,0 +1,202 @@
+﻿/**
+ * 评估函数基准测试：线性评估与 NNUE 每秒评估次数、相同节点数下的搜索耗时
+ * 用法: evalbench [-n 局面数] [-s 搜索节点数] [-w nnue.bin]
+ */
+
+#include <chrono>
+#include <vector>
+#include <string>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iterator>
+#include "NNUE.h"
+#include "Search.h"
+#include "Evaluation.h"
+
+
+namespace
+{
+	typedef std::chrono::steady_clock Clock;
+
+	/**
+	 * 一步走法及走棋前的局面
+	 */
+	struct FPly
+	{
+		Position	pos;
+		FMove		move;
+	};
+
+	// 初始局面
+	Position InitialPosition()
+	{
+		const FChessArray checkerboard = {
+			FChessPieceType::WHITE, FChessPieceType::WHITE, FChessPieceType::WHITE, FChessPieceType::WHITE,
+			FChessPieceType::WHITE, FChessPieceType::NONE, FChessPieceType::NONE, FChessPieceType::WHITE,
+			FChessPieceType::BLACK, FChessPieceType::NONE, FChessPieceType::NONE, FChessPieceType::BLACK,
+			FChessPieceType::BLACK, FChessPieceType::BLACK, FChessPieceType::BLACK, FChessPieceType::BLACK,
+		};
+		return Position::fromCheckerboard(checkerboard, FChessPieceType::WHITE);
+	}
+
+	// 随机对局生成测试局面
+	std::vector<FPly> GeneratePlies(size_t count, Random &random)
+	{
+		std::vector<FPly> plies;
+		plies.reserve(count);
+		Position pos = InitialPosition();
+		while (plies.size() < count)
+		{
+			FMove moves[kMaxMoveNum];
+			int move_num = pos.isLost() ? 0 : pos.generateMoves(moves);
+			if (move_num == 0 || random.nextInt(200) == 0)
+			{
+				pos = InitialPosition();
+				continue;
+			}
+			FPly ply = { pos, moves[random.nextInt(move_num)] };
+			plies.push_back(ply);
+			pos.makeMove(ply.move);
+		}
+		return plies;
+	}
+
+	bool IsSamePosition(const Position &a, const Position &b)
+	{
+		return a.getPieces(FChessPieceType::WHITE) == b.getPieces(FChessPieceType::WHITE)
+			&& a.getPieces(FChessPieceType::BLACK) == b.getPieces(FChessPieceType::BLACK)
+			&& a.getSideToMove() == b.getSideToMove();
+	}
+
+	double Seconds(Clock::time_point start)
+	{
+		return std::chrono::duration<double>(Clock::now() - start).count();
+	}
+
+	void Report(const char *name, size_t count, double seconds, long long checksum)
+	{
+		printf("%-24s %12.0f evals/sec  (checksum %lld)\n", name, count / seconds, checksum);
+	}
+
+	// 打印用法
+	void PrintUsage()
+	{
+		fprintf(stderr, "usage: evalbench [-n positions] [-s nodes] [-w nnue.bin]\n");
+	}
+}
+
+int main(int argc, char *argv[])
+{
+	size_t position_num = 1000000;
+	uint64_t search_nodes = 2000000;
+	std::string weights_file;
+	for (int i = 1; i < argc; ++i)
+	{
+		std::string arg = argv[i];
+		if (i + 1 == argc)
+		{
+			fprintf(stderr, "missing value: %s\n", arg.c_str());
+			PrintUsage();
+			return 1;
+		}
+		std::string value = argv[++i];
+		if (arg == "-n") position_num = static_cast<size_t>(atoll(value.c_str()));
+		else if (arg == "-s") search_nodes = static_cast<uint64_t>(atoll(value.c_str()));
+		else if (arg == "-w") weights_file = value;
+		else
+		{
+			fprintf(stderr, "unknown option: %s\n", arg.c_str());
+			PrintUsage();
+			return 1;
+		}
+	}
+
+	// 加载或随机生成网络
+	Random random;
+	NNUENetwork network;
+	if (!weights_file.empty())
+	{
+		std::ifstream in(weights_file.c_str(), std::ios::binary);
+		std::vector<char> data((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+		if (!network.load(data.data(), data.size()))
+		{
+			fprintf(stderr, "failed to load weights: %s\n", weights_file.c_str());
+			return 1;
+		}
+	}
+	else
+	{
+		network.randomize(random);
+	}
+
+	std::vector<FPly> plies = GeneratePlies(position_num, random);
+
+	// 线性评估
+	{
+		Evaluation evaluation;
+		long long checksum = 0;
+		auto start = Clock::now();
+		for (auto &ply : plies)
+		{
+			checksum += evaluation.evaluate(ply.pos);
+		}
+		Report("linear", plies.size(), Seconds(start), checksum);
+	}
+
+	// NNUE 完整刷新
+	{
+		FAccumulator acc;
+		long long checksum = 0;
+		auto start = Clock::now();
+		for (auto &ply : plies)
+		{
+			network.refresh(ply.pos, acc);
+			checksum += network.evaluate(acc, ply.pos.getSideToMove());
+		}
+		Report("nnue (refresh)", plies.size(), Seconds(start), checksum);
+	}
+
+	// NNUE 增量更新
+	{
+		FAccumulator acc[2];
+		long long checksum = 0;
+		int current = 0;
+		network.refresh(plies.front().pos, acc[current]);
+		auto start = Clock::now();
+		for (size_t i = 0; i < plies.size(); ++i)
+		{
+			const FPly &ply = plies[i];
+			Position next = ply.pos;
+			FBitboard killed = next.makeMove(ply.move);
+			network.update(acc[current ^ 1], acc[current], ply.pos.getSideToMove(), ply.move, killed);
+			current ^= 1;
+			checksum += network.evaluate(acc[current], next.getSideToMove());
+
+			// 对局重新开始时刷新
+			if (i + 1 < plies.size() && !IsSamePosition(plies[i + 1].pos, next))
+			{
+				network.refresh(plies[i + 1].pos, acc[current]);
+			}
+		}
+		Report("nnue (incremental)", plies.size(), Seconds(start), checksum);
+	}
+
+	// 相同节点数下的搜索速度
+	{
+		Position root = InitialPosition();
+		FSearchLimits limits;
+		limits.max_nodes = search_nodes;
+
+		Search search;
+		Random search_random;
+		FSearchResult result = search.run(root, limits, search_random);
+		printf("search linear: %s\n", helper::FormatSearchStats(result.stats).c_str());
+
+		search.setNetwork(&network);
+		search_random.seed(Random::kDefaultSeed);
+		result = search.run(root, limits, search_random);
+		printf("search nnue:   %s\n", helper::FormatSearchStats(result.stats).c_str());
+	}
+	return 0;
+}
\ No newline at end of file
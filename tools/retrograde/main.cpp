@@ -0,0 +1,114 @@
+﻿/**
+ * 多线程逆推求解工具：求出所有局面的胜负及步数
+ * 用法: retrograde [-t 线程数] [-o 输出文件] [-i init.json]
+ */
+
+#include <chrono>
+#include <string>
+#include <thread>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include "RetrogradeSolver.h"
+
+
+namespace
+{
+	// 读取文本文件
+	bool ReadTextFile(const std::string &filename, std::string &text)
+	{
+		std::ifstream in(filename.c_str(), std::ios::binary);
+		if (!in)
+		{
+			return false;
+		}
+		std::ostringstream buffer;
+		buffer << in.rdbuf();
+		text = buffer.str();
+		return true;
+	}
+
+	const char* ResultName(FRetroResult result)
+	{
+		switch (result)
+		{
+			case FRetroResult::WIN: return "win";
+			case FRetroResult::LOSS: return "loss";
+			case FRetroResult::DRAW: return "draw";
+			default: return "invalid";
+		}
+	}
+
+	// 打印用法
+	void PrintUsage()
+	{
+		fprintf(stderr, "usage: retrograde [-t threads] [-o output] [-i init.json]\n");
+	}
+}
+
+int main(int argc, char *argv[])
+{
+	int thread_num = static_cast<int>(std::thread::hardware_concurrency());
+	std::string output_file;
+	std::string init_file = "client/Resources/config/init.json";
+
+	for (int i = 1; i < argc; ++i)
+	{
+		std::string arg = argv[i];
+		if (i + 1 == argc)
+		{
+			fprintf(stderr, "missing value: %s\n", arg.c_str());
+			PrintUsage();
+			return 1;
+		}
+		std::string value = argv[++i];
+		if (arg == "-t") thread_num = atoi(value.c_str());
+		else if (arg == "-o") output_file = value;
+		else if (arg == "-i") init_file = value;
+		else
+		{
+			fprintf(stderr, "unknown option: %s\n", arg.c_str());
+			PrintUsage();
+			return 1;
+		}
+	}
+	thread_num = thread_num > 0 ? thread_num : 1;
+
+	printf("positions: %llu, threads: %d\n", (unsigned long long)kRetroPositionNum, thread_num);
+	auto start = std::chrono::steady_clock::now();
+	RetrogradeSolver solver;
+	solver.solve(thread_num, [](const FRetroProgress &progress)
+	{
+		printf("iteration %3d: +%llu wins, +%llu losses, %llu decided, %.2fs\n", progress.iteration,
+			(unsigned long long)progress.wins, (unsigned long long)progress.losses,
+			(unsigned long long)progress.total, progress.seconds);
+		fflush(stdout);
+	});
+	printf("solved in %.1fs\n", std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+
+	// 初始局面（白棋先走）
+	std::string text;
+	FChessArray checkerboard;
+	if (ReadTextFile(init_file, text) && helper::ParseCheckerboard(text, checkerboard))
+	{
+		uint64_t index = RetrogradeSolver::indexOf(Position::fromCheckerboard(checkerboard, FChessPieceType::WHITE));
+		printf("initial position: white to move, %s", ResultName(solver.getResult(index)));
+		if (solver.getDistance(index) > 0)
+		{
+			printf(" in %d plies", solver.getDistance(index));
+		}
+		printf("\n");
+	}
+
+	if (!output_file.empty())
+	{
+		if (!solver.save(output_file))
+		{
+			fprintf(stderr, "failed to write: %s\n", output_file.c_str());
+			return 1;
+		}
+		printf("saved: %s\n", output_file.c_str());
+	}
+	return 0;
+}
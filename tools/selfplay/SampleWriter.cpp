@@ -0,0 +1,133 @@
+﻿#include "SampleWriter.h"
+#include <chrono>
+
+
+namespace
+{
+	// 未达到批量大小时的最长等待时间
+	const std::chrono::seconds kFlushInterval(1);
+}
+
+SampleWriter::SampleWriter(size_t batch_size)
+	: file_(nullptr)
+	, batch_size_(batch_size)
+	, pending_num_(0)
+	, written_num_(0)
+	, closing_(false)
+{
+
+}
+
+SampleWriter::~SampleWriter()
+{
+	close();
+}
+
+// 打开文件
+bool SampleWriter::open(const std::string &filename)
+{
+	close();
+
+	file_ = fopen(filename.c_str(), "ab");
+	if (file_ == nullptr)
+	{
+		return false;
+	}
+
+	// 新文件写入文件头
+	fseek(file_, 0, SEEK_END);
+	if (ftell(file_) == 0)
+	{
+		FTrainingFileHeader header = helper::MakeTrainingFileHeader();
+		fwrite(&header, sizeof(header), 1, file_);
+	}
+
+	closing_ = false;
+	thread_ = std::thread(&SampleWriter::run, this);
+	return true;
+}
+
+// 提交一局的样本
+void SampleWriter::push(std::vector<FTrainingSample> &&samples)
+{
+	if (samples.empty())
+	{
+		return;
+	}
+
+	std::lock_guard<std::mutex> lock(mutex_);
+	pending_num_ += samples.size();
+	queue_.push_back(std::move(samples));
+	if (pending_num_ >= batch_size_)
+	{
+		condition_.notify_one();
+	}
+}
+
+// 写完剩余的样本并关闭文件
+void SampleWriter::close()
+{
+	if (thread_.joinable())
+	{
+		{
+			std::lock_guard<std::mutex> lock(mutex_);
+			closing_ = true;
+		}
+		condition_.notify_one();
+		thread_.join();
+	}
+
+	if (file_ != nullptr)
+	{
+		fclose(file_);
+		file_ = nullptr;
+	}
+}
+
+// 已写入的样本数量
+size_t SampleWriter::getWrittenNum() const
+{
+	std::lock_guard<std::mutex> lock(mutex_);
+	return written_num_;
+}
+
+// 写入线程
+void SampleWriter::run()
+{
+	std::vector<FTrainingSample> buffer;
+	for (;;)
+	{
+		std::deque< std::vector<FTrainingSample> > batches;
+		bool closing = false;
+		{
+			std::unique_lock<std::mutex> lock(mutex_);
+			condition_.wait_for(lock, kFlushInterval, [this]()
+			{
+				return closing_ || pending_num_ >= batch_size_;
+			});
+			batches.swap(queue_);
+			pending_num_ = 0;
+			closing = closing_;
+		}
+
+		// 合并成一次写入
+		buffer.clear();
+		for (auto &batch : batches)
+		{
+			buffer.insert(buffer.end(), batch.begin(), batch.end());
+		}
+		if (!buffer.empty())
+		{
+			fwrite(buffer.data(), sizeof(FTrainingSample), buffer.size(), file_);
+			fflush(file_);
+
+			std::lock_guard<std::mutex> lock(mutex_);
+			written_num_ += buffer.size();
+		}
+
+		if (closing)
+		{
+			break;
+		}
+	}
+}
@@ -0,0 +1,65 @@
+﻿#ifndef __SAMPLEWRITER_H__
+#define __SAMPLEWRITER_H__
+
+#include <mutex>
+#include <deque>
+#include <vector>
+#include <string>
+#include <thread>
+#include <cstdio>
+#include <condition_variable>
+#include "TrainingData.h"
+
+/**
+ * 后台线程批量追加写入训练样本
+ */
+class SampleWriter
+{
+public:
+	explicit SampleWriter(size_t batch_size = 64 * 1024);
+	~SampleWriter();
+
+public:
+	/**
+	 * 打开文件（追加写入，新文件会写入文件头）
+	 */
+	bool open(const std::string &filename);
+
+	/**
+	 * 提交一局的样本
+	 */
+	void push(std::vector<FTrainingSample> &&samples);
+
+	/**
+	 * 写完剩余的样本并关闭文件
+	 */
+	void close();
+
+	/**
+	 * 已写入的样本数量
+	 */
+	size_t getWrittenNum() const;
+
+private:
+	/**
+	 * 写入线程
+	 */
+	void run();
+
+private:
+	SampleWriter(const SampleWriter &) = delete;
+	SampleWriter& operator= (const SampleWriter &) = delete;
+
+private:
+	FILE*									file_;
+	size_t									batch_size_;
+	size_t									pending_num_;
+	size_t									written_num_;
+	bool									closing_;
+	std::deque< std::vector<FTrainingSample> >	queue_;
+	mutable std::mutex						mutex_;
+	std::condition_variable					condition_;
+	std::thread								thread_;
+};
+
+#endif
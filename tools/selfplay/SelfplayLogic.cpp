@@ -0,0 +1,37 @@
+﻿#include "SelfplayLogic.h"
+
+
+SelfplayLogic::SelfplayLogic(const FChessArray &checkerboard)
+	: initial_checkerboard_(checkerboard)
+{
+
+}
+
+// 准备开始
+void SelfplayLogic::ready()
+{
+	reset();
+	setCheckerboard(initial_checkerboard_);
+	addAction(FActionType::BEREADY, getStandbyChesspieceType(), FVec2::invalid(), FVec2::invalid());
+	addAction(FActionType::START, getStandbyChesspieceType(), FVec2::invalid(), FVec2::invalid());
+	addAction(FActionType::STANDBY, getStandbyChesspieceType(), FVec2::invalid(), FVec2::invalid());
+}
+
+// 获取上方玩家棋子类型
+FChessPieceType SelfplayLogic::getUpperplayerChesspieceType() const
+{
+	return FChessPieceType::BLACK;
+}
+
+// 获取下方玩家棋子类型
+FChessPieceType SelfplayLogic::getBelowplayerChesspieceType() const
+{
+	return FChessPieceType::WHITE;
+}
+
+// 移动棋子
+FMoveTicket SelfplayLogic::moveChesspiece(const FVec2 &source, const FVec2 &target)
+{
+	FMoveTrack track = { source, target };
+	return addMovetrack(track);
+}
@@ -0,0 +1,39 @@
+﻿#ifndef __SELFPLAYLOGIC_H__
+#define __SELFPLAYLOGIC_H__
+
+#include "LogicBase.h"
+
+/**
+ * 无界面的对局逻辑，棋盘由调用者提供
+ */
+class SelfplayLogic : public LogicBase
+{
+public:
+	explicit SelfplayLogic(const FChessArray &checkerboard);
+
+public:
+	/**
+	 * 准备开始
+	 */
+	virtual void ready() override;
+
+	/**
+	 * 获取上方玩家棋子类型
+	 */
+	virtual FChessPieceType getUpperplayerChesspieceType() const override;
+
+	/**
+	 * 获取下方玩家棋子类型
+	 */
+	virtual FChessPieceType getBelowplayerChesspieceType() const override;
+
+	/**
+	 * 移动棋子
+	 */
+	virtual FMoveTicket moveChesspiece(const FVec2 &source, const FVec2 &target) override;
+
+private:
+	FChessArray initial_checkerboard_;
+};
+
+#endif
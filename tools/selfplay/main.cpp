@@ -0,0 +1,270 @@
+﻿/**
+ * 自对弈训练数据生成工具
+ * 用法: selfplay [-g 对局数] [-t 线程数] [-k 分片序号] [-o 输出前缀] [-l easy|normal|hard] [-n 节点数]
+ *                [-r 随机开局步数] [-m 最大步数] [-s 种子] [-i init.json] [-w eval.json]
+ * 每个进程使用不同的分片序号，输出到 <前缀>-<分片序号>.bin，随机数种子也按分片区分，多个进程可以并行生成
+ */
+
+#include <atomic>
+#include <chrono>
+#include <vector>
+#include <string>
+#include <thread>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include "SimpleRobot.h"
+#include "SampleWriter.h"
+#include "SelfplayLogic.h"
+#include "TrainingData.h"
+
+
+namespace
+{
+	/**
+	 * 生成参数
+	 */
+	struct FSelfplayConfig
+	{
+		int				game_num;
+		int				thread_num;
+		int				shard;
+		int				random_plies;
+		int				max_plies;
+		uint64_t		seed;
+		FRobotLevel		level;
+		uint64_t		nodes;
+		bool			has_weights;
+		FEvalWeights	weights;
+		FChessArray		checkerboard;
+	};
+
+	// 读取文本文件
+	bool ReadTextFile(const std::string &filename, std::string &text)
+	{
+		std::ifstream in(filename.c_str(), std::ios::binary);
+		if (!in)
+		{
+			return false;
+		}
+		std::ostringstream buffer;
+		buffer << in.rdbuf();
+		text = buffer.str();
+		return true;
+	}
+
+	// 初始化机器人
+	void SetupRobot(SimpleRobot &robot, const FSelfplayConfig &config)
+	{
+		robot.setLevel(config.level);
+		if (config.nodes != 0)
+		{
+			FSearchLimits limits = robot.getSearchLimits();
+			limits.max_nodes = config.nodes;
+			robot.setSearchLimits(limits);
+		}
+		if (config.has_weights)
+		{
+			robot.setEvalWeights(config.weights);
+		}
+	}
+
+	// 进行一局对局，返回生成的样本
+	std::vector<FTrainingSample> PlayGame(const FSelfplayConfig &config, uint64_t game_seed)
+	{
+		Random random(game_seed);
+		SelfplayLogic logic(config.checkerboard);
+		SimpleRobot white_robot(&logic, random.next());
+		SimpleRobot black_robot(&logic, random.next());
+		SetupRobot(white_robot, config);
+		SetupRobot(black_robot, config);
+
+		// 机器人不入座，由这里驱动走棋并记录搜索分数
+		bool game_over = false;
+		FChessPieceType winner = FChessPieceType::NONE;
+		logic.addActionListener(helper::ActionMask(FActionType::GAMEOVER) | helper::ActionMask(FActionType::DRAW), [&](const FActionSpan &actions)
+		{
+			for (const FAction &action : actions)
+			{
+				if (action.type == FActionType::GAMEOVER || action.type == FActionType::DRAW)
+				{
+					game_over = true;
+					winner = action.chess_type;
+				}
+			}
+		});
+		logic.ready();
+
+		std::vector<FTrainingSample> samples;
+		for (int ply = 0; ply < config.max_plies && !game_over; ++ply)
+		{
+			FChessPieceType side = helper::OpponentOf(logic.getStandbyChesspieceType());
+			Position pos = Position::fromCheckerboard(logic.getCheckerboard(), side);
+
+			FMove move = FMove::invalid();
+			if (ply < config.random_plies)
+			{
+				FMove moves[kMaxMoveNum];
+				int move_num = pos.generateMoves(moves);
+				if (move_num > 0)
+				{
+					move = moves[random.nextInt(static_cast<uint32_t>(move_num))];
+				}
+			}
+			else
+			{
+				SimpleRobot &robot = side == FChessPieceType::WHITE ? white_robot : black_robot;
+				FSearchResult result = robot.think(side);
+				move = result.best_move;
+				samples.push_back(helper::MakeTrainingSample(pos, result.score, 0));
+			}
+
+			if (!move.isValid())
+			{
+				break;
+			}
+			FMoveTrack track = move.toMoveTrack();
+			logic.moveChesspiece(track.source, track.target);
+			logic.update(0.0f);
+		}
+
+		// 标注最终结果
+		for (auto &sample : samples)
+		{
+			if (winner != FChessPieceType::NONE)
+			{
+				sample.result = static_cast<int8_t>(sample.side == winner ? 1 : -1);
+			}
+		}
+		return samples;
+	}
+
+	bool ParseLevel(const std::string &text, FRobotLevel &level)
+	{
+		if (text == "easy") level = FRobotLevel::EASY;
+		else if (text == "normal") level = FRobotLevel::NORMAL;
+		else if (text == "hard") level = FRobotLevel::HARD;
+		else return false;
+		return true;
+	}
+
+	// 打印用法
+	void PrintUsage()
+	{
+		fprintf(stderr, "usage: selfplay [-g games] [-t threads] [-k shard] [-o prefix] [-l easy|normal|hard] [-n nodes]\n"
+			"                [-r random plies] [-m max plies] [-s seed] [-i init.json] [-w eval.json]\n");
+	}
+}
+
+int main(int argc, char *argv[])
+{
+	FSelfplayConfig config;
+	config.game_num = 1000;
+	config.thread_num = static_cast<int>(std::thread::hardware_concurrency());
+	config.shard = 0;
+	config.random_plies = 4;
+	config.max_plies = 300;
+	config.seed = Random::kDefaultSeed;
+	config.level = FRobotLevel::NORMAL;
+	config.nodes = 0;
+	config.has_weights = false;
+	std::string output_prefix = "selfplay";
+	std::string init_file = "client/Resources/config/init.json";
+
+	for (int i = 1; i < argc; ++i)
+	{
+		std::string arg = argv[i];
+		if (i + 1 == argc)
+		{
+			fprintf(stderr, "missing value: %s\n", arg.c_str());
+			PrintUsage();
+			return 1;
+		}
+		std::string value = argv[++i];
+		if (arg == "-g") config.game_num = atoi(value.c_str());
+		else if (arg == "-t") config.thread_num = atoi(value.c_str());
+		else if (arg == "-k") config.shard = atoi(value.c_str());
+		else if (arg == "-o") output_prefix = value;
+		else if (arg == "-n") config.nodes = strtoull(value.c_str(), nullptr, 10);
+		else if (arg == "-r") config.random_plies = atoi(value.c_str());
+		else if (arg == "-m") config.max_plies = atoi(value.c_str());
+		else if (arg == "-s") config.seed = strtoull(value.c_str(), nullptr, 10);
+		else if (arg == "-i") init_file = value;
+		else if (arg == "-l")
+		{
+			if (!ParseLevel(value, config.level))
+			{
+				fprintf(stderr, "unknown level: %s\n", value.c_str());
+				return 1;
+			}
+		}
+		else if (arg == "-w")
+		{
+			std::string text;
+			if (!ReadTextFile(value, text) || !Evaluation::parseWeights(text, config.weights))
+			{
+				fprintf(stderr, "failed to load weights: %s\n", value.c_str());
+				return 1;
+			}
+			config.has_weights = true;
+		}
+		else
+		{
+			fprintf(stderr, "unknown option: %s\n", arg.c_str());
+			PrintUsage();
+			return 1;
+		}
+	}
+	config.thread_num = config.thread_num > 0 ? config.thread_num : 1;
+
+	std::string text;
+	if (!ReadTextFile(init_file, text) || !helper::ParseCheckerboard(text, config.checkerboard))
+	{
+		fprintf(stderr, "failed to load checkerboard: %s\n", init_file.c_str());
+		return 1;
+	}
+
+	char filename[256];
+	snprintf(filename, sizeof(filename), "%s-%03d.bin", output_prefix.c_str(), config.shard);
+	SampleWriter writer;
+	if (!writer.open(filename))
+	{
+		fprintf(stderr, "failed to open: %s\n", filename);
+		return 1;
+	}
+
+	// 各线程领取对局
+	std::atomic<int> next_game(0);
+	std::atomic<int> finished_num(0);
+	std::vector<std::thread> threads;
+	auto start = std::chrono::steady_clock::now();
+	for (int t = 0; t < config.thread_num; ++t)
+	{
+		threads.emplace_back([&]()
+		{
+			for (int game = next_game++; game < config.game_num; game = next_game++)
+			{
+				uint64_t game_seed = config.seed ^ (static_cast<uint64_t>(config.shard) << 40) ^ static_cast<uint64_t>(game);
+				writer.push(PlayGame(config, game_seed));
+				++finished_num;
+			}
+		});
+	}
+
+	// 进度
+	while (finished_num < config.game_num)
+	{
+		std::this_thread::sleep_for(std::chrono::seconds(2));
+		double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+		printf("games %d/%d, samples %zu, %.1f games/sec\n", finished_num.load(), config.game_num, writer.getWrittenNum(), finished_num / seconds);
+	}
+
+	for (auto &thread : threads)
+	{
+		thread.join();
+	}
+	writer.close();
+	printf("done: %s, %zu samples\n", filename, writer.getWrittenNum());
+	return 0;
+}
\ No newline at end of file
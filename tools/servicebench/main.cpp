@@ -0,0 +1,257 @@
+﻿/**
+ * 分析服务压力测试：模拟大量房间同时与机器人对局，统计吞吐量、排队深度和延迟分位数
+ * 用法: servicebench [-r 房间数] [-t 线程数] [-n 每个房间的请求数] [-d 截止时间(ms)] [-N 每次搜索节点数]
+ *                    [-b 开局库步数] [-l 开局库文件] [-o 保存开局库] [-i init.json]
+ * 每个房间收到走法后由随机走棋的玩家应对，再立即提交下一次请求（满负荷）
+ */
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include "AnalysisService.h"
+
+
+namespace
+{
+	// 读取文件
+	bool ReadTextFile(const std::string &filename, std::string &text)
+	{
+		std::ifstream in(filename.c_str(), std::ios::binary);
+		if (!in)
+		{
+			return false;
+		}
+		std::ostringstream buffer;
+		buffer << in.rdbuf();
+		text = buffer.str();
+		return true;
+	}
+
+	/**
+	 * 模拟的房间
+	 */
+	struct FRoom
+	{
+		Position			pos;
+		Random				random;
+		FChessPieceType		robot_side;
+		int					remaining;
+	};
+
+	/**
+	 * 测试参数
+	 */
+	struct FBenchConfig
+	{
+		int				deadline_ms;
+		FSearchLimits	limits;
+		FChessArray		checkerboard;
+	};
+
+	class Bench
+	{
+	public:
+		Bench(AnalysisService &service, const FBenchConfig &config)
+			: service_(service), config_(config), finished_(0), failed_(0) {}
+
+		// 开始一局新的对局，先手随机
+		void newGame(FRoom &room)
+		{
+			FChessPieceType first = room.random.nextInt(2) ? FChessPieceType::WHITE : FChessPieceType::BLACK;
+			room.pos = Position::fromCheckerboard(config_.checkerboard, first);
+		}
+
+		// 玩家随机应对，然后提交请求
+		void next(FRoom &room)
+		{
+			for (;;)
+			{
+				if (room.pos.isLost())
+				{
+					newGame(room);
+				}
+				if (room.pos.getSideToMove() == room.robot_side)
+				{
+					break;
+				}
+				FMove moves[kMaxMoveNum];
+				int move_num = room.pos.generateMoves(moves);
+				room.pos.makeMove(moves[room.random.nextInt(static_cast<uint32_t>(move_num))]);
+			}
+
+			FServiceRequest request;
+			request.checkerboard = room.pos.toCheckerboard();
+			request.side = room.robot_side;
+			request.limits = config_.limits;
+			request.deadline_ms = config_.deadline_ms;
+			FRoom *target = &room;
+			if (!service_.submit(request, [this, target](const FServiceReply &reply) { onReply(*target, reply); }))
+			{
+				++failed_;
+				++finished_;
+			}
+		}
+
+		int getFinishedNum() const { return finished_; }
+
+		int getFailedNum() const { return failed_; }
+
+	private:
+		void onReply(FRoom &room, const FServiceReply &reply)
+		{
+			if (reply.move.isValid())
+			{
+				room.pos.makeMove(reply.move);
+			}
+			if (--room.remaining > 0 && reply.status != FServiceStatus::CANCELLED)
+			{
+				next(room);
+			}
+			else
+			{
+				++finished_;
+			}
+		}
+
+	private:
+		AnalysisService&	service_;
+		FBenchConfig		config_;
+		std::atomic<int>	finished_;
+		std::atomic<int>	failed_;
+	};
+
+	void PrintStats(const FServiceStats &stats, double seconds, int thread_num)
+	{
+		double per_request_ms = stats.completed > 0 ? seconds * 1000.0 * thread_num / stats.completed : 0.0;
+		printf("%.1fs: completed %llu (%.0f/sec, %.2f cpu ms each), queue %zu (max %zu), coalesced %llu, book %llu, expired %llu, late %llu, rejected %llu\n",
+			seconds, (unsigned long long)stats.completed, stats.completed / seconds, per_request_ms, stats.queue_depth, stats.max_queue_depth,
+			(unsigned long long)stats.coalesced, (unsigned long long)stats.book_hits, (unsigned long long)stats.expired,
+			(unsigned long long)stats.late, (unsigned long long)stats.rejected);
+		printf("    latency p50 %.1fms, p90 %.1fms, p99 %.1fms, max %.1fms, %llu nodes\n",
+			stats.latency_p50_ms, stats.latency_p90_ms, stats.latency_p99_ms, stats.latency_max_ms, (unsigned long long)stats.nodes);
+	}
+
+	// 打印用法
+	void PrintUsage()
+	{
+		fprintf(stderr, "usage: servicebench [-r rooms] [-t threads] [-n requests] [-d deadline ms] [-N nodes]\n"
+			"                    [-b book plies] [-l book] [-o save book] [-i init.json]\n");
+	}
+}
+
+int main(int argc, char *argv[])
+{
+	int room_num = 1000;
+	int thread_num = static_cast<int>(std::thread::hardware_concurrency());
+	int request_num = 20;
+	int book_plies = 0;
+	std::string book_file;
+	std::string save_file;
+	std::string init_file = "client/Resources/config/init.json";
+	FBenchConfig config;
+	config.deadline_ms = 200;
+	config.limits.max_nodes = 20000;
+
+	for (int i = 1; i < argc; ++i)
+	{
+		std::string arg = argv[i];
+		if (i + 1 == argc)
+		{
+			fprintf(stderr, "missing value: %s\n", arg.c_str());
+			PrintUsage();
+			return 1;
+		}
+		std::string value = argv[++i];
+		if (arg == "-r") room_num = atoi(value.c_str());
+		else if (arg == "-t") thread_num = atoi(value.c_str());
+		else if (arg == "-n") request_num = atoi(value.c_str());
+		else if (arg == "-d") config.deadline_ms = atoi(value.c_str());
+		else if (arg == "-N") config.limits.max_nodes = strtoull(value.c_str(), nullptr, 10);
+		else if (arg == "-b") book_plies = atoi(value.c_str());
+		else if (arg == "-l") book_file = value;
+		else if (arg == "-o") save_file = value;
+		else if (arg == "-i") init_file = value;
+		else
+		{
+			fprintf(stderr, "unknown option: %s\n", arg.c_str());
+			PrintUsage();
+			return 1;
+		}
+	}
+	thread_num = thread_num > 0 ? thread_num : 1;
+
+	std::string text;
+	if (!ReadTextFile(init_file, text) || !helper::ParseCheckerboard(text, config.checkerboard))
+	{
+		fprintf(stderr, "failed to load checkerboard: %s\n", init_file.c_str());
+		return 1;
+	}
+
+	// 开局库
+	OpeningBook book;
+	if (!book_file.empty())
+	{
+		if (!ReadTextFile(book_file, text) || !book.load(text.data(), text.size()))
+		{
+			fprintf(stderr, "failed to load book: %s\n", book_file.c_str());
+			return 1;
+		}
+	}
+	else if (book_plies > 0)
+	{
+		auto start = std::chrono::steady_clock::now();
+		book.build(config.checkerboard, book_plies, config.limits);
+		printf("book: %zu positions in %.1fs\n", book.getEntryNum(),
+			std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+	}
+	if (!save_file.empty() && !book.save(save_file))
+	{
+		fprintf(stderr, "failed to save book: %s\n", save_file.c_str());
+		return 1;
+	}
+
+	AnalysisService service;
+	if (book.getEntryNum() > 0)
+	{
+		service.setOpeningBook(&book);
+	}
+	service.start(thread_num);
+
+	Bench bench(service, config);
+	std::vector<FRoom> rooms(room_num);
+	for (int i = 0; i < room_num; ++i)
+	{
+		rooms[i].random.seed(Random::kDefaultSeed + i);
+		rooms[i].robot_side = i % 2 ? FChessPieceType::WHITE : FChessPieceType::BLACK;
+		rooms[i].remaining = request_num;
+		bench.newGame(rooms[i]);
+	}
+
+	auto start = std::chrono::steady_clock::now();
+	for (auto &room : rooms)
+	{
+		bench.next(room);
+	}
+	while (bench.getFinishedNum() < room_num)
+	{
+		std::this_thread::sleep_for(std::chrono::seconds(1));
+		PrintStats(service.getStats(), std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count(), thread_num);
+	}
+
+	double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	service.stop();
+	printf("done:\n");
+	PrintStats(service.getStats(), seconds, thread_num);
+	if (bench.getFailedNum() > 0)
+	{
+		printf("rejected rooms: %d\n", bench.getFailedNum());
+	}
+	return 0;
+}
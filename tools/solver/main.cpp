@@ -0,0 +1,160 @@
+﻿/**
+ * 证明数搜索求解工具：证明局面的胜负并给出一条取胜变例
+ * 用法: solver [-i init.json | -p 棋盘] [-s white|black] [-d 最大步数] [-m 置换表MB] [-n 节点数] [-t 毫秒]
+ * 棋盘为16个字符，按棋盘数组下标顺序，w 表示白棋，b 表示黑棋，. 表示空位
+ */
+
+#include <string>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include "ProofSolver.h"
+
+
+namespace
+{
+	// 读取文本文件
+	bool ReadTextFile(const std::string &filename, std::string &text)
+	{
+		std::ifstream in(filename.c_str(), std::ios::binary);
+		if (!in)
+		{
+			return false;
+		}
+		std::ostringstream buffer;
+		buffer << in.rdbuf();
+		text = buffer.str();
+		return true;
+	}
+
+	// 解析棋盘字符串
+	bool ParseBoard(const std::string &text, FChessArray &checkerboard)
+	{
+		if (text.size() != checkerboard.size())
+		{
+			return false;
+		}
+		for (size_t i = 0; i < text.size(); ++i)
+		{
+			switch (text[i])
+			{
+				case 'w': checkerboard[i] = FChessPieceType::WHITE; break;
+				case 'b': checkerboard[i] = FChessPieceType::BLACK; break;
+				case '.': checkerboard[i] = FChessPieceType::NONE; break;
+				default: return false;
+			}
+		}
+		return true;
+	}
+
+	const char* ResultName(FProofResult result)
+	{
+		switch (result)
+		{
+			case FProofResult::WIN: return "win";
+			case FProofResult::LOSS: return "loss";
+			case FProofResult::DRAW: return "draw";
+			default: return "unknown";
+		}
+	}
+
+	const char* SideName(FChessPieceType type)
+	{
+		return type == FChessPieceType::WHITE ? "white" : "black";
+	}
+
+	// 打印用法
+	void PrintUsage()
+	{
+		fprintf(stderr, "usage: solver [-i init.json | -p board] [-s white|black] [-d max plies] [-m tt MB] [-n nodes] [-t ms]\n");
+	}
+}
+
+int main(int argc, char *argv[])
+{
+	std::string init_file = "client/Resources/config/init.json";
+	std::string board;
+	FChessPieceType side = FChessPieceType::WHITE;
+	size_t tt_size_mb = 256;
+	FProofLimits limits;
+
+	for (int i = 1; i < argc; ++i)
+	{
+		std::string arg = argv[i];
+		if (i + 1 == argc)
+		{
+			fprintf(stderr, "missing value: %s\n", arg.c_str());
+			PrintUsage();
+			return 1;
+		}
+		std::string value = argv[++i];
+		if (arg == "-i") init_file = value;
+		else if (arg == "-p") board = value;
+		else if (arg == "-d") limits.max_plies = atoi(value.c_str());
+		else if (arg == "-m") tt_size_mb = static_cast<size_t>(atoll(value.c_str()));
+		else if (arg == "-n") limits.max_nodes = strtoull(value.c_str(), nullptr, 10);
+		else if (arg == "-t") limits.max_time_ms = atoi(value.c_str());
+		else if (arg == "-s" && (value == "white" || value == "black"))
+		{
+			side = value == "white" ? FChessPieceType::WHITE : FChessPieceType::BLACK;
+		}
+		else
+		{
+			fprintf(stderr, "unknown option: %s %s\n", arg.c_str(), value.c_str());
+			PrintUsage();
+			return 1;
+		}
+	}
+
+	FChessArray checkerboard;
+	if (!board.empty())
+	{
+		if (!ParseBoard(board, checkerboard))
+		{
+			fprintf(stderr, "invalid board: %s\n", board.c_str());
+			return 1;
+		}
+	}
+	else
+	{
+		std::string text;
+		if (!ReadTextFile(init_file, text) || !helper::ParseCheckerboard(text, checkerboard))
+		{
+			fprintf(stderr, "failed to load checkerboard: %s\n", init_file.c_str());
+			return 1;
+		}
+	}
+
+	ProofSolver solver(tt_size_mb);
+	Position pos = Position::fromCheckerboard(checkerboard, side);
+	FProofStats stats = solver.solve(pos, limits);
+
+	if (stats.result == FProofResult::DRAW)
+	{
+		printf("result: %s to move, no forced win within %d plies\n", SideName(side), limits.max_plies);
+	}
+	else if (stats.result == FProofResult::UNKNOWN)
+	{
+		printf("result: %s to move, unknown (no forced win within %d plies)\n", SideName(side), stats.plies);
+	}
+	else
+	{
+		printf("result: %s to move, %s\n", SideName(side), ResultName(stats.result));
+	}
+	printf("nodes: %llu, time: %.3fs, %.0f nodes/sec\n", (unsigned long long)stats.nodes, stats.seconds,
+		stats.seconds > 0.0 ? stats.nodes / stats.seconds : 0.0);
+	printf("tt entries used: %zu\n", stats.tt_used);
+	if (stats.result == FProofResult::WIN || stats.result == FProofResult::LOSS)
+	{
+		printf("plies: %d, proof size: %llu positions\n", stats.plies, (unsigned long long)stats.proof_size);
+		printf("winning line:");
+		for (auto &move : stats.line)
+		{
+			FMoveTrack track = move.toMoveTrack();
+			printf(" (%d,%d)-(%d,%d)", track.source.x, track.source.y, track.target.x, track.target.y);
+		}
+		printf("\n");
+	}
+	return stats.result == FProofResult::UNKNOWN ? 2 : 0;
+}
@@ -0,0 +1,137 @@
+﻿#include "MappedFile.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+
+MappedFile::MappedFile()
+	: data_(nullptr)
+	, size_(0)
+#ifdef _WIN32
+	, file_(INVALID_HANDLE_VALUE)
+	, mapping_(nullptr)
+#else
+	, fd_(-1)
+#endif
+{
+
+}
+
+MappedFile::~MappedFile()
+{
+	close();
+}
+
+// 打开并映射文件
+bool MappedFile::open(const std::string &filename)
+{
+	close();
+
+#ifdef _WIN32
+	file_ = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+	if (file_ == INVALID_HANDLE_VALUE)
+	{
+		return false;
+	}
+
+	LARGE_INTEGER file_size;
+	if (!GetFileSizeEx(file_, &file_size) || file_size.QuadPart == 0)
+	{
+		close();
+		return false;
+	}
+
+	mapping_ = CreateFileMappingA(file_, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (mapping_ == nullptr)
+	{
+		close();
+		return false;
+	}
+
+	data_ = static_cast<const char *>(MapViewOfFile(mapping_, FILE_MAP_READ, 0, 0, 0));
+	size_ = static_cast<size_t>(file_size.QuadPart);
+#else
+	fd_ = ::open(filename.c_str(), O_RDONLY);
+	if (fd_ < 0)
+	{
+		return false;
+	}
+
+	struct stat st;
+	if (fstat(fd_, &st) != 0 || st.st_size == 0)
+	{
+		close();
+		return false;
+	}
+
+	void *addr = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd_, 0);
+	if (addr == MAP_FAILED)
+	{
+		close();
+		return false;
+	}
+
+	// 样本按顺序扫描
+	madvise(addr, static_cast<size_t>(st.st_size), MADV_SEQUENTIAL);
+	data_ = static_cast<const char *>(addr);
+	size_ = static_cast<size_t>(st.st_size);
+#endif
+
+	if (data_ == nullptr)
+	{
+		close();
+		return false;
+	}
+	return true;
+}
+
+// 关闭文件
+void MappedFile::close()
+{
+#ifdef _WIN32
+	if (data_ != nullptr)
+	{
+		UnmapViewOfFile(data_);
+	}
+	if (mapping_ != nullptr)
+	{
+		CloseHandle(mapping_);
+		mapping_ = nullptr;
+	}
+	if (file_ != INVALID_HANDLE_VALUE)
+	{
+		CloseHandle(file_);
+		file_ = INVALID_HANDLE_VALUE;
+	}
+#else
+	if (data_ != nullptr)
+	{
+		munmap(const_cast<char *>(data_), size_);
+	}
+	if (fd_ >= 0)
+	{
+		::close(fd_);
+		fd_ = -1;
+	}
+#endif
+	data_ = nullptr;
+	size_ = 0;
+}
+
+// 获取数据
+const char* MappedFile::data() const
+{
+	return data_;
+}
+
+// 获取文件大小
+size_t MappedFile::size() const
+{
+	return size_;
+}
\ No newline at end of file
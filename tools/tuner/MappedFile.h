@@ -0,0 +1,52 @@
+﻿#ifndef __MAPPEDFILE_H__
+#define __MAPPEDFILE_H__
+
+#include <string>
+#include <cstddef>
+
+/**
+ * 只读内存映射文件
+ */
+class MappedFile
+{
+public:
+	MappedFile();
+	~MappedFile();
+
+public:
+	/**
+	 * 打开并映射文件
+	 */
+	bool open(const std::string &filename);
+
+	/**
+	 * 关闭文件
+	 */
+	void close();
+
+	/**
+	 * 获取数据
+	 */
+	const char* data() const;
+
+	/**
+	 * 获取文件大小
+	 */
+	size_t size() const;
+
+private:
+	MappedFile(const MappedFile &) = delete;
+	MappedFile& operator= (const MappedFile &) = delete;
+
+private:
+	const char*	data_;
+	size_t		size_;
+#ifdef _WIN32
+	void*		file_;
+	void*		mapping_;
+#else
+	int			fd_;
+#endif
+};
+
+#endif
\ No newline at end of file
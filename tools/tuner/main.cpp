@@ -0,0 +1,314 @@
+﻿/**
+ * Texel 评估权重调优工具
+ * 用法: tuner [-t 线程数] [-n 迭代次数] [-r 学习率] [-i 初始权重.json] [-o 输出.json] 样本文件...
+ */
+
+#include <cmath>
+#include <vector>
+#include <string>
+#include <thread>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <memory>
+#include <algorithm>
+#include "MappedFile.h"
+#include "Evaluation.h"
+#include "TrainingData.h"
+
+
+namespace
+{
+	/**
+	 * 一个样本文件中的样本
+	 */
+	struct FSampleSpan
+	{
+		const FTrainingSample*	samples;
+		size_t					count;
+	};
+
+	/**
+	 * 一次遍历的累计结果
+	 */
+	struct FGradient
+	{
+		double	error;
+		double	values[kEvalFeatureNum];
+		size_t	count;
+
+		FGradient() : error(0.0), count(0)
+		{
+			for (int i = 0; i < kEvalFeatureNum; ++i)
+			{
+				values[i] = 0.0;
+			}
+		}
+	};
+
+	inline double Sigmoid(double k, double score)
+	{
+		return 1.0 / (1.0 + std::exp(-k * score));
+	}
+
+	// 遍历[begin, end)范围内的样本
+	template <typename Func>
+	void ForEachSample(const std::vector<FSampleSpan> &spans, size_t begin, size_t end, Func func)
+	{
+		size_t offset = 0;
+		for (auto &span : spans)
+		{
+			size_t first = begin > offset ? begin - offset : 0;
+			size_t last = end - offset < span.count ? end - offset : span.count;
+			for (size_t i = first; i < last; ++i)
+			{
+				func(span.samples[i]);
+			}
+			offset += span.count;
+			if (offset >= end)
+			{
+				break;
+			}
+		}
+	}
+
+	// 多线程计算误差和梯度
+	FGradient ComputeGradient(const std::vector<FSampleSpan> &spans, size_t total, const double weights[kEvalFeatureNum], double k, int thread_num)
+	{
+		std::vector<FGradient> partials(thread_num);
+		std::vector<std::thread> threads;
+		for (int t = 0; t < thread_num; ++t)
+		{
+			size_t begin = total * t / thread_num;
+			size_t end = total * (t + 1) / thread_num;
+			threads.emplace_back([&, t, begin, end]()
+			{
+				FGradient &gradient = partials[t];
+				ForEachSample(spans, begin, end, [&](const FTrainingSample &sample)
+				{
+					Position pos = helper::TrainingSampleToPosition(sample);
+					if (pos.isLost())
+					{
+						return;
+					}
+
+					int features[kEvalFeatureNum];
+					Evaluation::extractFeatures(pos, features);
+
+					double score = 0.0;
+					for (int i = 0; i < kEvalFeatureNum; ++i)
+					{
+						score += weights[i] * features[i];
+					}
+
+					double target = (sample.result + 1) * 0.5;
+					double predict = Sigmoid(k, score);
+					double diff = predict - target;
+					double factor = 2.0 * diff * predict * (1.0 - predict) * k;
+					gradient.error += diff * diff;
+					for (int i = 0; i < kEvalFeatureNum; ++i)
+					{
+						gradient.values[i] += factor * features[i];
+					}
+					++gradient.count;
+				});
+			});
+		}
+
+		FGradient result;
+		for (int t = 0; t < thread_num; ++t)
+		{
+			threads[t].join();
+			result.error += partials[t].error;
+			result.count += partials[t].count;
+			for (int i = 0; i < kEvalFeatureNum; ++i)
+			{
+				result.values[i] += partials[t].values[i];
+			}
+		}
+
+		if (result.count > 0)
+		{
+			result.error /= result.count;
+			for (int i = 0; i < kEvalFeatureNum; ++i)
+			{
+				result.values[i] /= result.count;
+			}
+		}
+		return result;
+	}
+
+	// 在固定权重下寻找最合适的缩放系数K
+	double FitScalingFactor(const std::vector<FSampleSpan> &spans, size_t total, const double weights[kEvalFeatureNum], int thread_num)
+	{
+		double low = 0.0001;
+		double high = 0.1;
+		const double ratio = (std::sqrt(5.0) - 1.0) / 2.0;
+		for (int i = 0; i < 40; ++i)
+		{
+			double k1 = high - (high - low) * ratio;
+			double k2 = low + (high - low) * ratio;
+			double e1 = ComputeGradient(spans, total, weights, k1, thread_num).error;
+			double e2 = ComputeGradient(spans, total, weights, k2, thread_num).error;
+			if (e1 < e2)
+			{
+				high = k2;
+			}
+			else
+			{
+				low = k1;
+			}
+		}
+		return (low + high) / 2.0;
+	}
+
+	// 读取文本文件
+	bool ReadTextFile(const std::string &filename, std::string &text)
+	{
+		std::ifstream in(filename.c_str(), std::ios::binary);
+		if (!in)
+		{
+			return false;
+		}
+		std::ostringstream buffer;
+		buffer << in.rdbuf();
+		text = buffer.str();
+		return true;
+	}
+
+	// 打印用法
+	void PrintUsage()
+	{
+		fprintf(stderr, "usage: tuner [-t threads] [-n iterations] [-r rate] [-i init.json] [-o eval.json] samples...\n");
+	}
+}
+
+int main(int argc, char *argv[])
+{
+	int thread_num = static_cast<int>(std::thread::hardware_concurrency());
+	int iterations = 1000;
+	double learning_rate = 1.0;
+	std::string init_file;
+	std::string output_file = "eval.json";
+	std::vector<std::string> sample_files;
+
+	for (int i = 1; i < argc; ++i)
+	{
+		std::string arg = argv[i];
+		if (arg.empty() || arg[0] != '-')
+		{
+			sample_files.push_back(arg);
+			continue;
+		}
+		if (i + 1 == argc)
+		{
+			fprintf(stderr, "missing value: %s\n", arg.c_str());
+			PrintUsage();
+			return 1;
+		}
+		std::string value = argv[++i];
+		if (arg == "-t") thread_num = atoi(value.c_str());
+		else if (arg == "-n") iterations = atoi(value.c_str());
+		else if (arg == "-r") learning_rate = atof(value.c_str());
+		else if (arg == "-i") init_file = value;
+		else if (arg == "-o") output_file = value;
+		else
+		{
+			fprintf(stderr, "unknown option: %s\n", arg.c_str());
+			PrintUsage();
+			return 1;
+		}
+	}
+
+	if (sample_files.empty())
+	{
+		PrintUsage();
+		return 1;
+	}
+	thread_num = thread_num > 0 ? thread_num : 1;
+
+	// 初始权重
+	FEvalWeights weights;
+	if (!init_file.empty())
+	{
+		std::string text;
+		if (!ReadTextFile(init_file, text) || !Evaluation::parseWeights(text, weights))
+		{
+			fprintf(stderr, "failed to load weights: %s\n", init_file.c_str());
+			return 1;
+		}
+	}
+
+	// 映射样本文件
+	size_t total = 0;
+	std::vector<FSampleSpan> spans;
+	std::vector<std::unique_ptr<MappedFile>> files;
+	for (auto &filename : sample_files)
+	{
+		std::unique_ptr<MappedFile> file(new MappedFile());
+		if (!file->open(filename) || file->size() < sizeof(FTrainingFileHeader))
+		{
+			fprintf(stderr, "failed to open: %s\n", filename.c_str());
+			return 1;
+		}
+
+		const FTrainingFileHeader *header = reinterpret_cast<const FTrainingFileHeader *>(file->data());
+		if (!helper::IsValidTrainingFileHeader(*header))
+		{
+			fprintf(stderr, "invalid sample file: %s\n", filename.c_str());
+			return 1;
+		}
+
+		FSampleSpan span;
+		span.samples = reinterpret_cast<const FTrainingSample *>(file->data() + sizeof(FTrainingFileHeader));
+		span.count = (file->size() - sizeof(FTrainingFileHeader)) / sizeof(FTrainingSample);
+		total += span.count;
+		spans.push_back(span);
+		files.push_back(std::move(file));
+	}
+	printf("samples: %zu, threads: %d\n", total, thread_num);
+
+	double params[kEvalFeatureNum];
+	for (int i = 0; i < kEvalFeatureNum; ++i)
+	{
+		params[i] = weights.values[i];
+	}
+
+	double k = FitScalingFactor(spans, total, params, thread_num);
+	printf("scaling factor K = %.6f\n", k);
+
+	// Adam 梯度下降
+	const double beta1 = 0.9;
+	const double beta2 = 0.999;
+	double m[kEvalFeatureNum] = { 0.0 };
+	double v[kEvalFeatureNum] = { 0.0 };
+	for (int iter = 1; iter <= iterations; ++iter)
+	{
+		FGradient gradient = ComputeGradient(spans, total, params, k, thread_num);
+		for (int i = 0; i < kEvalFeatureNum; ++i)
+		{
+			m[i] = beta1 * m[i] + (1.0 - beta1) * gradient.values[i];
+			v[i] = beta2 * v[i] + (1.0 - beta2) * gradient.values[i] * gradient.values[i];
+			double m_hat = m[i] / (1.0 - std::pow(beta1, iter));
+			double v_hat = v[i] / (1.0 - std::pow(beta2, iter));
+			params[i] -= learning_rate * m_hat / (std::sqrt(v_hat) + 1e-8);
+		}
+
+		if (iter % 10 == 0 || iter == iterations)
+		{
+			printf("iteration %d, error %.8f\n", iter, gradient.error);
+		}
+	}
+
+	// 输出权重（限制在 parseWeights 接受的范围内）
+	for (int i = 0; i < kEvalFeatureNum; ++i)
+	{
+		const double limit = static_cast<double>(kMaxEvalWeight);
+		weights.values[i] = static_cast<int>(std::lround(std::max(-limit, std::min(params[i], limit))));
+	}
+	std::ofstream out(output_file.c_str(), std::ios::binary);
+	out << Evaluation::serializeWeights(weights) << std::endl;
+	printf("%s\n", Evaluation::serializeWeights(weights).c_str());
+	return out ? 0 : 1;
+}
\ No newline at end of file